@@ -0,0 +1,34 @@
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include "atomic_file.h"
+
+using namespace std;
+
+string ScratchPath(const string& filename) {
+    return filename + ".tmp." + to_string((long)getpid());
+}
+
+bool CommitFile(const string& scratch, const string& filename) {
+    int fd = open(scratch.c_str(), O_RDONLY);
+    bool ok = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) close(fd);
+    if (!ok || rename(scratch.c_str(), filename.c_str()) != 0) {
+        cerr << "Failed to replace " << filename << ": " << strerror(errno) << endl;
+        unlink(scratch.c_str());
+        return false;
+    }
+
+    // Make the rename itself durable.
+    size_t slash = filename.find_last_of('/');
+    string dir = (slash == string::npos) ? "." : filename.substr(0, slash + 1);
+    int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    return true;
+}
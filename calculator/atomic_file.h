@@ -0,0 +1,22 @@
+#ifndef ATOMIC_FILE_H
+#define ATOMIC_FILE_H
+
+#include <string>
+using namespace std;
+
+// Files the tools write are also read while they change: `main watch` and
+// the registry map .pcpt files, eval and training map IDX datasets. Writing
+// in place would truncate a live mapping (SIGBUS) or change weights under an
+// in-flight Predict, so writers fill a scratch file next to the target and
+// rename it over the target; readers see the old file or the new one, never
+// a mix.
+
+// Scratch file for `filename`, in the same directory so the rename stays on
+// one filesystem.
+string ScratchPath(const string& filename);
+
+// Flushes `scratch` to disk and renames it over `filename`. Removes `scratch`
+// and reports to cerr on failure.
+bool CommitFile(const string& scratch, const string& filename);
+
+#endif
@@ -0,0 +1,86 @@
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "augment.h"
+
+using namespace std;
+
+// splitmix64: tiny state, so every sample can get its own generator.
+static uint64_t next_random(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1).
+static float next_unit(uint64_t& state) {
+    return (float)(next_random(state) >> 40) * (1.0f / (1 << 24));
+}
+
+uint64_t AugmentSeed(uint64_t seed, uint64_t epoch, uint64_t index) {
+    uint64_t state = seed;
+    state = next_random(state) ^ epoch;
+    state = next_random(state) ^ index;
+    return next_random(state);
+}
+
+void AugmentImage(const float* in, size_t width, size_t height, const AugmentOptions& options,
+                  uint64_t seed, float* out) {
+    const size_t n = width * height;
+    uint64_t state = seed;
+
+    // Work on ink (1 = stroke, 0 = background) whatever the polarity.
+    float mean = 0.0f;
+    for (size_t i = 0; i < n; ++i) mean += in[i];
+    const bool light_background = mean > 0.5f * n;
+    vector<float> ink(n), moved(n);
+    for (size_t i = 0; i < n; ++i) ink[i] = light_background ? 1.0f - in[i] : in[i];
+
+    // Inverse map each output pixel to the source and sample bilinearly;
+    // anything outside the source is background.
+    const int shift = max(options.max_shift, 0);
+    const float dx = (float)((int)(next_random(state) % (2 * shift + 1)) - shift);
+    const float dy = (float)((int)(next_random(state) % (2 * shift + 1)) - shift);
+    const float scale = 1.0f + options.max_scale * (2.0f * next_unit(state) - 1.0f);
+    const float cx = 0.5f * (width - 1), cy = 0.5f * (height - 1);
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            float sx = (x - cx - dx) / scale + cx;
+            float sy = (y - cy - dy) / scale + cy;
+            int x0 = (int)floorf(sx), y0 = (int)floorf(sy);
+            float fx = sx - x0, fy = sy - y0;
+            float sum = 0.0f;
+            for (int j = 0; j < 2; ++j) {
+                for (int i = 0; i < 2; ++i) {
+                    int px = x0 + i, py = y0 + j;
+                    if (px < 0 || py < 0 || px >= (int)width || py >= (int)height) continue;
+                    sum += ink[py * width + px] * (i ? fx : 1.0f - fx) * (j ? fy : 1.0f - fy);
+                }
+            }
+            moved[y * width + x] = sum;
+        }
+    }
+
+    if (next_unit(state) < options.dilate_probability) {
+        for (size_t y = 0; y < height; ++y) {
+            for (size_t x = 0; x < width; ++x) {
+                float v = 0.0f;
+                for (size_t py = (y ? y - 1 : 0); py <= min(y + 1, height - 1); ++py) {
+                    for (size_t px = (x ? x - 1 : 0); px <= min(x + 1, width - 1); ++px) {
+                        v = max(v, moved[py * width + px]);
+                    }
+                }
+                ink[y * width + x] = v;
+            }
+        }
+        moved.swap(ink);
+    }
+
+    const bool binarize = next_unit(state) < options.binarize_probability;
+    for (size_t i = 0; i < n; ++i) {
+        float v = moved[i];
+        if (binarize) v = (v > options.binarize_threshold) ? 1.0f : 0.0f;
+        out[i] = light_background ? 1.0f - v : v;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef AUGMENT_H
+#define AUGMENT_H
+
+#include <cstddef>
+#include <stdint.h>
+using namespace std;
+
+// Random distortions that make a training image look more like what the
+// calculator feeds the model: a drawing recentered by its bounding box (so
+// off by a few pixels and a bit larger or smaller), drawn with the thick 5x5
+// brush, and reduced to on/off cells.
+struct AugmentOptions {
+  // Translation by up to this many pixels on each axis.
+  int max_shift = 2;
+  // Scale factor drawn from [1 - max_scale, 1 + max_scale], about the center.
+  float max_scale = 0.15f;
+  // Chance of thickening the strokes with a 3x3 max filter.
+  float dilate_probability = 0.3f;
+  // Chance of binarizing, and the ink level above which a pixel is on.
+  float binarize_probability = 0.3f;
+  float binarize_threshold = 0.25f;
+};
+
+// Writes a randomly distorted copy of the width x height image `in` (values
+// in 0..1) to `out`. Ink is whichever of dark and light is in the minority,
+// so the background stays the background through every step. The
+// distortion is a pure function of `seed`, so a run is reproducible however
+// the work is spread over threads.
+void AugmentImage(const float* in, size_t width, size_t height, const AugmentOptions& options,
+                  uint64_t seed, float* out);
+
+// Mixes a run seed with a sample's coordinates into a per-sample seed.
+uint64_t AugmentSeed(uint64_t seed, uint64_t epoch, uint64_t index);
+
+#endif
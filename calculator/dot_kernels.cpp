@@ -0,0 +1,415 @@
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "dot_kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DOT_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+static float dot_scalar(const float* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static void dot4_scalar(const float* const x[4], const float* w, size_t n, float out[4]) {
+    float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        float wi = w[i];
+        acc0 += x[0][i] * wi;
+        acc1 += x[1][i] * wi;
+        acc2 += x[2][i] * wi;
+        acc3 += x[3][i] * wi;
+    }
+    out[0] = acc0;
+    out[1] = acc1;
+    out[2] = acc2;
+    out[3] = acc3;
+}
+
+const DotKernels kScalarKernels = { "scalar", dot_scalar, dot4_scalar };
+
+#ifdef DOT_KERNELS_X86
+
+// ---- SSE2: four 4-wide accumulators, 16 floats per iteration ----
+
+__attribute__((target("sse2")))
+static inline float hsum128(__m128 v) {
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+__attribute__((target("sse2")))
+static float dot_sse2(const float* a, const float* b, size_t n) {
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(a + i + 8), _mm_loadu_ps(b + i + 8)));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(a + i + 12), _mm_loadu_ps(b + i + 12)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float sum = hsum128(_mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3)));
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+__attribute__((target("sse2")))
+static void dot4_sse2(const float* const x[4], const float* w, size_t n, float out[4]) {
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 wv = _mm_loadu_ps(w + i);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x[0] + i), wv));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x[1] + i), wv));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(x[2] + i), wv));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(x[3] + i), wv));
+    }
+    out[0] = hsum128(acc0);
+    out[1] = hsum128(acc1);
+    out[2] = hsum128(acc2);
+    out[3] = hsum128(acc3);
+    for (; i < n; ++i) {
+        for (int r = 0; r < 4; ++r) out[r] += x[r][i] * w[i];
+    }
+}
+
+// ---- AVX2 + FMA: four 8-wide accumulators, 32 floats per iteration ----
+
+__attribute__((target("avx2,fma")))
+static inline float hsum256(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    return hsum128(_mm_add_ps(lo, hi));
+}
+
+__attribute__((target("avx2,fma")))
+static float dot_avx2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), acc3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    float sum = hsum256(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)));
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static void dot4_avx2(const float* const x[4], const float* w, size_t n, float out[4]) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 wv = _mm256_loadu_ps(w + i);
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x[0] + i), wv, acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x[1] + i), wv, acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(x[2] + i), wv, acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(x[3] + i), wv, acc3);
+    }
+    out[0] = hsum256(acc0);
+    out[1] = hsum256(acc1);
+    out[2] = hsum256(acc2);
+    out[3] = hsum256(acc3);
+    for (; i < n; ++i) {
+        for (int r = 0; r < 4; ++r) out[r] += x[r][i] * w[i];
+    }
+}
+
+// ---- AVX-512: four 16-wide accumulators, masked loads for the tail ----
+// Also targets avx2,fma so the hsum helpers inline and the compiler emits
+// vzeroupper on return; an out-of-line call left the upper halves dirty and
+// made the caller's SSE code pay AVX/SSE transition stalls.
+
+__attribute__((target("avx512f,avx2,fma")))
+static inline float hsum512(__m512 v) {
+    float lanes[16];
+    _mm512_storeu_ps(lanes, v);
+    __m256 halves = _mm256_add_ps(_mm256_loadu_ps(lanes), _mm256_loadu_ps(lanes + 8));
+    return hsum256(halves);
+}
+
+__attribute__((target("avx512f,avx2,fma")))
+static float dot_avx512(const float* a, const float* b, size_t n) {
+    __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+    __m512 acc2 = _mm512_setzero_ps(), acc3 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+        acc2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 32), _mm512_loadu_ps(b + i + 32), acc2);
+        acc3 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 48), _mm512_loadu_ps(b + i + 48), acc3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+    }
+    if (i < n) {
+        __mmask16 mask = (__mmask16)((1u << (n - i)) - 1);
+        acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                               _mm512_maskz_loadu_ps(mask, b + i), acc1);
+    }
+    return hsum512(_mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3)));
+}
+
+__attribute__((target("avx512f,avx2,fma")))
+static void dot4_avx512(const float* const x[4], const float* w, size_t n, float out[4]) {
+    __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+    __m512 acc2 = _mm512_setzero_ps(), acc3 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 wv = _mm512_loadu_ps(w + i);
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x[0] + i), wv, acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(x[1] + i), wv, acc1);
+        acc2 = _mm512_fmadd_ps(_mm512_loadu_ps(x[2] + i), wv, acc2);
+        acc3 = _mm512_fmadd_ps(_mm512_loadu_ps(x[3] + i), wv, acc3);
+    }
+    if (i < n) {
+        __mmask16 mask = (__mmask16)((1u << (n - i)) - 1);
+        __m512 wv = _mm512_maskz_loadu_ps(mask, w + i);
+        acc0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, x[0] + i), wv, acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, x[1] + i), wv, acc1);
+        acc2 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, x[2] + i), wv, acc2);
+        acc3 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, x[3] + i), wv, acc3);
+    }
+    out[0] = hsum512(acc0);
+    out[1] = hsum512(acc1);
+    out[2] = hsum512(acc2);
+    out[3] = hsum512(acc3);
+}
+
+static const DotKernels kSse2Kernels = { "sse2", dot_sse2, dot4_sse2 };
+static const DotKernels kAvx2Kernels = { "avx2", dot_avx2, dot4_avx2 };
+static const DotKernels kAvx512Kernels = { "avx512", dot_avx512, dot4_avx512 };
+
+#endif // DOT_KERNELS_X86
+
+// ---- Deterministic: one fixed summation shape for every ISA ----
+//
+// Product i is rounded to float and added (no FMA) into lane i % 16, lanes
+// in index order; the input is treated as zero-padded to a multiple of 16.
+// The 16 lanes are then folded by the same pairwise tree everywhere. SSE2
+// holds the lanes in four registers, AVX2 in two and AVX-512 in one, so all
+// of them perform exactly the scalar kernel's float operations.
+
+static const size_t kDetLanes = 16;
+
+// Compilers fuse a * b + c into an FMA when the target has one (GCC does by
+// default outside strict ISO modes, and -march=native adds the target), and
+// GCC's SIMD intrinsics are plain vector arithmetic it may fuse the same way.
+// Contraction stays off through the end of the file.
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+static inline float reduce_lanes(const float lanes[kDetLanes]) {
+    float s8[8], s4[4];
+    for (int j = 0; j < 8; ++j) s8[j] = lanes[j] + lanes[j + 8];
+    for (int j = 0; j < 4; ++j) s4[j] = s8[j] + s8[j + 4];
+    return (s4[0] + s4[2]) + (s4[1] + s4[3]);
+}
+
+static float dot_det_scalar(const float* a, const float* b, size_t n) {
+    float lanes[kDetLanes] = {};
+    size_t i = 0;
+    for (; i + kDetLanes <= n; i += kDetLanes) {
+        for (size_t j = 0; j < kDetLanes; ++j) {
+            float product = a[i + j] * b[i + j];
+            lanes[j] = lanes[j] + product;
+        }
+    }
+    for (size_t j = 0; j < kDetLanes; ++j) {
+        float product = (i + j < n) ? a[i + j] * b[i + j] : 0.0f;
+        if (i < n) lanes[j] = lanes[j] + product;
+    }
+    return reduce_lanes(lanes);
+}
+
+static void dot4_det_scalar(const float* const x[4], const float* w, size_t n, float out[4]) {
+    for (int r = 0; r < 4; ++r) out[r] = dot_det_scalar(x[r], w, n);
+}
+
+const DotKernels kDeterministicScalarKernels = { "scalar-det", dot_det_scalar, dot4_det_scalar };
+
+#ifdef DOT_KERNELS_X86
+
+__attribute__((target("sse2")))
+static float dot_det_sse2(const float* a, const float* b, size_t n) {
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + kDetLanes <= n; i += kDetLanes) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(a + i + 8), _mm_loadu_ps(b + i + 8)));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(a + i + 12), _mm_loadu_ps(b + i + 12)));
+    }
+    float lanes[kDetLanes];
+    _mm_storeu_ps(lanes, acc0);
+    _mm_storeu_ps(lanes + 4, acc1);
+    _mm_storeu_ps(lanes + 8, acc2);
+    _mm_storeu_ps(lanes + 12, acc3);
+    if (i < n) {
+        for (size_t j = 0; j < kDetLanes; ++j) {
+            float product = (i + j < n) ? a[i + j] * b[i + j] : 0.0f;
+            lanes[j] = lanes[j] + product;
+        }
+    }
+    return reduce_lanes(lanes);
+}
+
+__attribute__((target("sse2")))
+static void dot4_det_sse2(const float* const x[4], const float* w, size_t n, float out[4]) {
+    for (int r = 0; r < 4; ++r) out[r] = dot_det_sse2(x[r], w, n);
+}
+
+__attribute__((target("avx2")))
+static float dot_det_avx2(const float* a, const float* b, size_t n) {
+    __m256 lo = _mm256_setzero_ps(), hi = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + kDetLanes <= n; i += kDetLanes) {
+        lo = _mm256_add_ps(lo, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        hi = _mm256_add_ps(hi, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    float lanes[kDetLanes];
+    _mm256_storeu_ps(lanes, lo);
+    _mm256_storeu_ps(lanes + 8, hi);
+    if (i < n) {
+        for (size_t j = 0; j < kDetLanes; ++j) {
+            float product = (i + j < n) ? a[i + j] * b[i + j] : 0.0f;
+            lanes[j] = lanes[j] + product;
+        }
+    }
+    return reduce_lanes(lanes);
+}
+
+__attribute__((target("avx2")))
+static void dot4_det_avx2(const float* const x[4], const float* w, size_t n, float out[4]) {
+    // Shares the loads of `w` like dot4_avx2 but keeps each row's lanes apart.
+    __m256 lo[4], hi[4];
+    for (int r = 0; r < 4; ++r) lo[r] = hi[r] = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + kDetLanes <= n; i += kDetLanes) {
+        __m256 wlo = _mm256_loadu_ps(w + i), whi = _mm256_loadu_ps(w + i + 8);
+        for (int r = 0; r < 4; ++r) {
+            lo[r] = _mm256_add_ps(lo[r], _mm256_mul_ps(_mm256_loadu_ps(x[r] + i), wlo));
+            hi[r] = _mm256_add_ps(hi[r], _mm256_mul_ps(_mm256_loadu_ps(x[r] + i + 8), whi));
+        }
+    }
+    for (int r = 0; r < 4; ++r) {
+        float lanes[kDetLanes];
+        _mm256_storeu_ps(lanes, lo[r]);
+        _mm256_storeu_ps(lanes + 8, hi[r]);
+        if (i < n) {
+            for (size_t j = 0; j < kDetLanes; ++j) {
+                float product = (i + j < n) ? x[r][i + j] * w[i + j] : 0.0f;
+                lanes[j] = lanes[j] + product;
+            }
+        }
+        out[r] = reduce_lanes(lanes);
+    }
+}
+
+// The explicit-rounding multiply and add are never contracted whatever the
+// compiler flags. On the tail, zero-masked loads and products supply the
+// padding zeros.
+__attribute__((target("avx512f,avx2")))
+static float dot_det_avx512(const float* a, const float* b, size_t n) {
+    const int kRound = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i < n; i += kDetLanes) {
+        __mmask16 mask = (n - i >= kDetLanes) ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        __m512 product = _mm512_maskz_mul_round_ps(mask, _mm512_maskz_loadu_ps(mask, a + i),
+                                                   _mm512_maskz_loadu_ps(mask, b + i), kRound);
+        acc = _mm512_mask_add_round_ps(acc, 0xFFFF, acc, product, kRound);
+    }
+    float lanes[kDetLanes];
+    _mm512_storeu_ps(lanes, acc);
+    return reduce_lanes(lanes);
+}
+
+__attribute__((target("avx512f,avx2")))
+static void dot4_det_avx512(const float* const x[4], const float* w, size_t n, float out[4]) {
+    const int kRound = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+    __m512 acc[4] = { _mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps(), _mm512_setzero_ps() };
+    for (size_t i = 0; i < n; i += kDetLanes) {
+        __mmask16 mask = (n - i >= kDetLanes) ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        __m512 wv = _mm512_maskz_loadu_ps(mask, w + i);
+        for (int r = 0; r < 4; ++r) {
+            __m512 product = _mm512_maskz_mul_round_ps(mask, _mm512_maskz_loadu_ps(mask, x[r] + i), wv, kRound);
+            acc[r] = _mm512_mask_add_round_ps(acc[r], 0xFFFF, acc[r], product, kRound);
+        }
+    }
+    for (int r = 0; r < 4; ++r) {
+        float lanes[kDetLanes];
+        _mm512_storeu_ps(lanes, acc[r]);
+        out[r] = reduce_lanes(lanes);
+    }
+}
+
+static const DotKernels kDetSse2Kernels = { "sse2-det", dot_det_sse2, dot4_det_sse2 };
+static const DotKernels kDetAvx2Kernels = { "avx2-det", dot_det_avx2, dot4_det_avx2 };
+static const DotKernels kDetAvx512Kernels = { "avx512-det", dot_det_avx512, dot4_det_avx512 };
+
+#endif // DOT_KERNELS_X86
+
+std::vector<const DotKernels*> supported_dot_kernels(bool deterministic) {
+    std::vector<const DotKernels*> kernels;
+    kernels.push_back(deterministic ? &kDeterministicScalarKernels : &kScalarKernels);
+#ifdef DOT_KERNELS_X86
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (__builtin_cpu_supports("sse2")) kernels.push_back(deterministic ? &kDetSse2Kernels : &kSse2Kernels);
+    if (avx2) kernels.push_back(deterministic ? &kDetAvx2Kernels : &kAvx2Kernels);
+    if (avx2 && __builtin_cpu_supports("avx512f")) {
+        kernels.push_back(deterministic ? &kDetAvx512Kernels : &kAvx512Kernels);
+    }
+#endif
+    return kernels;
+}
+
+static const DotKernels* select_kernels() {
+    const char* det = getenv("PERCEPTRON_DETERMINISTIC");
+    bool deterministic = det && *det && strcmp(det, "0") != 0;
+    std::vector<const DotKernels*> supported = supported_dot_kernels(deterministic);
+
+    // PERCEPTRON_KERNEL names the ISA; the "-det" suffix is implied.
+    const char* forced = getenv("PERCEPTRON_KERNEL");
+    for (const DotKernels* kernels : supported) {
+        if (forced && strncmp(kernels->name, forced, strlen(forced)) == 0 &&
+            (kernels->name[strlen(forced)] == '\0' || kernels->name[strlen(forced)] == '-')) {
+            return kernels;
+        }
+    }
+    return supported.back();
+}
+
+const DotKernels& dot_kernels() {
+    static const DotKernels* selected = select_kernels();
+    return *selected;
+}
@@ -0,0 +1,38 @@
+#ifndef DOT_KERNELS_H
+#define DOT_KERNELS_H
+
+#include <cstddef>
+#include <vector>
+
+// Dot-product kernels used by Perceptron. Every ISA-specific kernel has the
+// same contract as the scalar reference; results differ only by float
+// rounding because the SIMD kernels sum with several independent accumulators.
+struct DotKernels {
+  const char* name;
+  // Returns sum(a[i] * b[i]) for i in [0, n).
+  float (*dot)(const float* a, const float* b, size_t n);
+  // Computes four dot products against the same `w`, reading `w` only once.
+  void (*dot4)(const float* const x[4], const float* w, size_t n, float out[4]);
+};
+
+// Plain serial loop; kept as the reference every other kernel is checked against.
+extern const DotKernels kScalarKernels;
+
+// Reproducible reduction: every product goes into lane i % 16 in index order
+// without FMA, and the lanes are folded by one fixed pairwise tree. The
+// SIMD versions perform exactly the same float operations, so all of them
+// return bit-identical results on every machine. Each row of a batch is
+// reduced on its own, so results don't depend on batching or threads either.
+extern const DotKernels kDeterministicScalarKernels;
+
+// Kernel sets the running CPU supports, slowest first: the fast ones, or
+// their deterministic counterparts.
+std::vector<const DotKernels*> supported_dot_kernels(bool deterministic);
+
+// Kernels for the running CPU, picked once via CPUID on first use. Setting the
+// PERCEPTRON_KERNEL environment variable to "scalar", "sse2", "avx2" or
+// "avx512" forces a particular kernel when the CPU supports it. Setting
+// PERCEPTRON_DETERMINISTIC=1 switches to the deterministic kernels.
+const DotKernels& dot_kernels();
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef FIXED_PERCEPTRON_H
+#define FIXED_PERCEPTRON_H
+
+#include <array>
+#include <cstddef>
+
+// The models are trained on square 28x28 grayscale images.
+constexpr size_t kImageSide = 28;
+constexpr size_t kImagePixels = kImageSide * kImageSide;
+
+// Perceptron whose input width is part of the type. Weights live inline in a
+// std::array, every loop bound is a compile-time constant and mismatched
+// input sizes fail to compile instead of being checked on every call. Use the
+// runtime-sized Perceptron for models whose width is only known after loading.
+template <size_t N>
+class FixedPerceptron {
+  static_assert(N > 0, "FixedPerceptron needs at least one input");
+
+public:
+  // Independent accumulators in the dot product; lets the compiler keep a
+  // full vector register of partial sums without reassociating a serial sum.
+  static constexpr size_t kLanes = 8;
+
+  FixedPerceptron(const std::array<float, N>& iWeights, float iBias)
+    : weights(iWeights), bias(iBias) {}
+
+  // Copies exactly N weights from `iWeights`; the caller checks the source
+  // size once when the model is loaded.
+  FixedPerceptron(const float* iWeights, float iBias) : bias(iBias) {
+    for (size_t i = 0; i < N; ++i) weights[i] = iWeights[i];
+  }
+
+  int Predict(const std::array<float, N>& x) const { return Predict(x.data()); }
+  int Predict(const float (&x)[N]) const { return Predict(&x[0]); }
+
+  float Logit(const std::array<float, N>& x) const { return Logit(x.data()); }
+
+  static constexpr size_t InputSize() { return N; }
+
+private:
+  int Predict(const float* x) const {
+    return (Logit(x) > 0) ? 1 : 0;
+  }
+
+  float Logit(const float* x) const {
+    constexpr size_t kBody = N - N % kLanes;
+
+    float acc[kLanes] = {};
+    for (size_t i = 0; i < kBody; i += kLanes) {
+      for (size_t l = 0; l < kLanes; ++l) {
+        acc[l] += x[i + l] * weights[i + l];
+      }
+    }
+    for (size_t i = kBody; i < N; ++i) {
+      acc[i - kBody] += x[i] * weights[i];
+    }
+
+    float linear_output = 0.0f;
+    for (size_t l = 0; l < kLanes; ++l) {
+      linear_output += acc[l];
+    }
+    return linear_output + bias;
+  }
+
+  std::array<float, N> weights;
+  float bias;
+};
+
+#endif
@@ -0,0 +1,218 @@
+#include <vector>
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include "fixedpoint_perceptron.h"
+
+using namespace std;
+
+// Rounds to the nearest integer without pulling in lrintf, which the Nspire
+// toolchain implements in soft-float anyway.
+static int32_t round_to_int(float v) {
+    return (int32_t)(v >= 0 ? v + 0.5f : v - 0.5f);
+}
+
+int32_t FixedPointPerceptron::ToWeight(float w) {
+    return round_to_int(w * (float)(1 << kWeightFracBits));
+}
+
+int32_t FixedPointPerceptron::ToFeature(float x) {
+    return round_to_int(x * (float)kFeatureOne);
+}
+
+FixedPointPerceptron::FixedPointPerceptron(const vector<float>& iWeights, float iBias)
+    : borrowed(nullptr), borrowed_count(0) {
+    weights.reserve(iWeights.size());
+    for (unsigned int i = 0; i < iWeights.size(); ++i) {
+        weights.push_back(ToWeight(iWeights[i]));
+    }
+    bias = ToWeight(iBias);
+}
+
+FixedPointPerceptron::FixedPointPerceptron(const int32_t* iWeights, size_t count, int32_t iBias)
+    : borrowed(iWeights), borrowed_count(count), bias(iBias) {
+}
+
+int64_t FixedPointPerceptron::Logit(const int32_t* x) const {
+    const int32_t* w = Weights();
+    const size_t n = InputSize();
+    int64_t linear_output = 0;
+    for (size_t i = 0; i < n; ++i) {
+        linear_output += (int64_t)x[i] * w[i];
+    }
+    return linear_output + (int64_t)bias * kFeatureOne;
+}
+
+int FixedPointPerceptron::Predict(const int32_t* x, size_t count) const {
+    if (count != InputSize()) {
+        cerr << "Error: Input size (" << count
+             << ") doesn't match weights size (" << InputSize() << ")" << endl;
+        return -1;
+    }
+
+    int prediction = (Logit(x) > 0) ? 1 : 0;
+
+    return prediction;
+}
+
+int64_t FixedPointPerceptron::LogitBits(const uint8_t* bits) const {
+    const int32_t* w = Weights();
+    const size_t n = InputSize();
+    int64_t linear_output = 0;
+
+    // 32-bit words suit the ARM9; __builtin_ctz compiles to a clz sequence.
+    for (size_t base = 0; base < n; base += 32) {
+        size_t nbytes = (n - base + 7) / 8;
+        if (nbytes > 4) nbytes = 4;
+        // Little-endian load: byte b of the mask lands in bits 8b..8b+7.
+        uint32_t word = 0;
+        memcpy(&word, bits + base / 8, nbytes);
+        if (n - base < 32) {
+            word &= ((uint32_t)1 << (n - base)) - 1;
+        }
+        while (word) {
+            linear_output += w[base + __builtin_ctz(word)];
+            word &= word - 1;
+        }
+    }
+
+    return (linear_output + bias) * kFeatureOne;
+}
+
+int FixedPointPerceptron::PredictBits(const uint8_t* bits, size_t count) const {
+    if (count != InputSize()) {
+        cerr << "Error: Input size (" << count
+             << ") doesn't match weights size (" << InputSize() << ")" << endl;
+        return -1;
+    }
+
+    int prediction = (LogitBits(bits) > 0) ? 1 : 0;
+
+    return prediction;
+}
+
+void FixedPointPerceptron::MakeWritable() {
+    if (borrowed) {
+        weights.assign(borrowed, borrowed + borrowed_count);
+        borrowed = nullptr;
+        borrowed_count = 0;
+    }
+}
+
+// Adds with saturation, so a long run of corrections can't wrap a weight.
+static int32_t add_saturated(int32_t a, int64_t b) {
+    int64_t sum = (int64_t)a + b;
+    if (sum > INT32_MAX) return INT32_MAX;
+    if (sum < INT32_MIN) return INT32_MIN;
+    return (int32_t)sum;
+}
+
+void FixedPointPerceptron::UpdateBits(const uint8_t* bits, int32_t delta) {
+    MakeWritable();
+    const size_t n = weights.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (bits[i / 8] & (1 << (i % 8))) {
+            weights[i] = add_saturated(weights[i], delta);
+        }
+    }
+    bias = add_saturated(bias, delta);
+}
+
+int32_t FixedPointPerceptron::CorrectBits(const uint8_t* bits, int target, int32_t rate) {
+    const size_t n = InputSize();
+    int64_t logit = LogitBits(bits) >> kFeatureFracBits;  // Q16.16
+    if (((logit > 0) ? 1 : 0) == target || rate <= 0) {
+        return 0;
+    }
+
+    // One step of `rate` moves the logit by rate per set bit plus the bias.
+    int64_t inputs = 1;
+    for (size_t i = 0; i < n; ++i) {
+        inputs += (bits[i / 8] >> (i % 8)) & 1;
+    }
+    const int64_t per_step = (int64_t)rate * inputs;
+    // Target 1 needs logit > 0; target 0 needs logit <= 0.
+    int64_t steps = target ? (-logit / per_step + 1) : ((logit + per_step - 1) / per_step);
+    int64_t delta = steps * rate;
+    if (delta > INT32_MAX) delta = INT32_MAX;
+    UpdateBits(bits, (int32_t)(target ? delta : -delta));
+    return (int32_t)(target ? delta : -delta);
+}
+
+static uint32_t fnv1a(uint32_t hash, const void* data, size_t bytes) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < bytes; ++i) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static const uint32_t kFnvOffset = 2166136261u;
+static const char kAdaptedMagic[4] = {'P', 'C', 'A', 'D'};
+static const uint16_t kAdaptedVersion = 1;
+
+uint32_t FixedPointPerceptron::Fingerprint() const {
+    uint32_t hash = fnv1a(kFnvOffset, Weights(), InputSize() * sizeof(int32_t));
+    return fnv1a(hash, &bias, sizeof(bias));
+}
+
+// Both targets (ARM and x86) are little-endian, so the fields are written as
+// they sit in memory.
+bool FixedPointPerceptron::Save(const char* path, uint32_t base) const {
+    const uint32_t count = (uint32_t)InputSize();
+    uint8_t header[20];
+    const uint16_t version = kAdaptedVersion, reserved = 0;
+    memcpy(header, kAdaptedMagic, 4);
+    memcpy(header + 4, &version, 2);
+    memcpy(header + 6, &reserved, 2);
+    memcpy(header + 8, &count, 4);
+    memcpy(header + 12, &base, 4);
+    memcpy(header + 16, &bias, 4);
+    uint32_t hash = fnv1a(kFnvOffset, header, sizeof(header));
+    hash = fnv1a(hash, Weights(), count * sizeof(int32_t));
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+              fwrite(Weights(), sizeof(int32_t), count, file) == count &&
+              fwrite(&hash, 1, 4, file) == 4;
+    return fclose(file) == 0 && ok;
+}
+
+bool FixedPointPerceptron::Load(const char* path, uint32_t base) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    uint8_t header[20];
+    uint16_t version = 0;
+    uint32_t count = 0, saved_base = 0, hash = 0;
+    int32_t saved_bias = 0;
+    vector<int32_t> saved;
+    bool ok = fread(header, 1, sizeof(header), file) == sizeof(header);
+    if (ok) {
+        memcpy(&version, header + 4, 2);
+        memcpy(&count, header + 8, 4);
+        memcpy(&saved_base, header + 12, 4);
+        memcpy(&saved_bias, header + 16, 4);
+        ok = memcmp(header, kAdaptedMagic, 4) == 0 && version == kAdaptedVersion &&
+             count == InputSize() && saved_base == base;
+    }
+    if (ok) {
+        saved.resize(count);
+        ok = fread(saved.data(), sizeof(int32_t), count, file) == count &&
+             fread(&hash, 1, 4, file) == 4;
+    }
+    fclose(file);
+    if (!ok || hash != fnv1a(fnv1a(kFnvOffset, header, sizeof(header)), saved.data(), count * sizeof(int32_t))) {
+        return false;
+    }
+
+    weights.swap(saved);
+    borrowed = nullptr;
+    borrowed_count = 0;
+    bias = saved_bias;
+    return true;
+}
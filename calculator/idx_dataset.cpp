@@ -0,0 +1,196 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "idx_dataset.h"
+#include "atomic_file.h"
+
+using namespace std;
+
+static uint32_t read_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void write_be32(ostream& out, uint32_t v) {
+    char b[4] = {(char)(v >> 24), (char)(v >> 16), (char)(v >> 8), (char)v};
+    out.write(b, 4);
+}
+
+// Maps `filename` read-only. The dataset is read front to back, so tell the
+// kernel to read ahead aggressively and drop pages behind us.
+static void* map_file(const string& filename, size_t& length) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Failed to open file: " << filename << endl;
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 4) {
+        cerr << "Not an IDX file: " << filename << endl;
+        close(fd);
+        return nullptr;
+    }
+    length = (size_t)st.st_size;
+    void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        cerr << "Failed to map file: " << filename << endl;
+        return nullptr;
+    }
+    madvise(base, length, MADV_SEQUENTIAL);
+    return base;
+}
+
+// Checks the IDX header of a mapping against the expected type and rank and
+// returns the dimensions and the payload start, or null.
+static const uint8_t* parse_idx(const string& filename, const void* base, size_t length,
+                                uint8_t& type, size_t ndim, uint32_t* dims) {
+    const uint8_t* p = static_cast<const uint8_t*>(base);
+    size_t header = 4 + 4 * ndim;
+    if (length < header || p[0] != 0 || p[1] != 0 || p[3] != ndim) {
+        cerr << "Not a " << ndim << "-dimensional IDX file: " << filename << endl;
+        return nullptr;
+    }
+    type = p[2];
+    size_t element = (type == kIdxUint8) ? 1 : (type == kIdxFloat32) ? 4 : 0;
+    if (element == 0) {
+        cerr << "Unsupported IDX element type 0x" << hex << (int)type << dec << ": " << filename << endl;
+        return nullptr;
+    }
+    // The dims are untrusted: bound the running product by what the file can
+    // hold before each multiply so three large dims can't wrap it around.
+    const uint64_t capacity = (length - header) / element;
+    uint64_t elements = 1;
+    for (size_t d = 0; d < ndim; ++d) {
+        dims[d] = read_be32(p + 4 + 4 * d);
+        if (dims[d] != 0 && elements > capacity / dims[d]) {
+            cerr << "IDX dimensions exceed the file size: " << filename << endl;
+            return nullptr;
+        }
+        elements *= dims[d];
+    }
+    if (header + elements * element != length) {
+        cerr << "IDX payload size doesn't match its dimensions: " << filename << endl;
+        return nullptr;
+    }
+    return p + header;
+}
+
+IdxDataset::~IdxDataset() {
+    if (images_base) munmap(images_base, images_length);
+    if (labels_base) munmap(labels_base, labels_length);
+}
+
+unique_ptr<IdxDataset> IdxDataset::Open(const string& images_file, const string& labels_file) {
+    unique_ptr<IdxDataset> data(new IdxDataset());
+    data->images_base = map_file(images_file, data->images_length);
+    data->labels_base = map_file(labels_file, data->labels_length);
+    if (!data->images_base || !data->labels_base) {
+        return nullptr;
+    }
+
+    uint32_t image_dims[3], label_dims[1];
+    uint8_t label_type = 0;
+    data->pixels = parse_idx(images_file, data->images_base, data->images_length, data->dtype, 3, image_dims);
+    data->labels = parse_idx(labels_file, data->labels_base, data->labels_length, label_type, 1, label_dims);
+    if (!data->pixels || !data->labels) {
+        return nullptr;
+    }
+    if (label_type != kIdxUint8 || label_dims[0] != image_dims[0]) {
+        cerr << "Expected " << image_dims[0] << " uint8 labels in " << labels_file << endl;
+        return nullptr;
+    }
+    data->count = image_dims[0];
+    data->rows = image_dims[1];
+    data->cols = image_dims[2];
+    return data;
+}
+
+void IdxDataset::Decode(size_t first, size_t n, float* out) const {
+    const size_t total = n * Pixels();
+    if (dtype == kIdxUint8) {
+        const uint8_t* src = pixels + first * Pixels();
+        for (size_t i = 0; i < total; ++i) {
+            out[i] = src[i] * (1.0f / 255.0f);
+        }
+    } else {
+        const uint8_t* src = pixels + first * Pixels() * 4;
+        for (size_t i = 0; i < total; ++i) {
+            uint32_t bits = read_be32(src + 4 * i);
+            memcpy(&out[i], &bits, sizeof(float));
+        }
+    }
+}
+
+void IdxDataset::WillNeed(size_t first, size_t n) const {
+    n = min(n, count - min(first, count));
+    if (n == 0) return;
+    const size_t element = (dtype == kIdxUint8) ? 1 : 4;
+    // madvise wants a page-aligned start.
+    const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)(pixels + first * Pixels() * element);
+    uintptr_t end = start + n * Pixels() * element;
+    start &= ~(page - 1);
+    madvise((void*)start, end - start, MADV_WILLNEED);
+}
+
+bool IdxDataset::Write(const string& images_file, const string& labels_file,
+                       const float* pixels, const uint8_t* labels, size_t count,
+                       size_t rows, size_t cols, uint8_t dtype) {
+    // Both files are replaced by rename: a running eval may have them mapped.
+    const string images_scratch = ScratchPath(images_file);
+    const string labels_scratch = ScratchPath(labels_file);
+    ofstream images(images_scratch, ios::binary);
+    ofstream label_out(labels_scratch, ios::binary);
+    if (!images || !label_out) {
+        cerr << "Failed to open file: " << (images ? labels_scratch : images_scratch) << endl;
+        remove(images_scratch.c_str());
+        remove(labels_scratch.c_str());
+        return false;
+    }
+
+    const char image_magic[4] = {0, 0, (char)dtype, 3};
+    images.write(image_magic, 4);
+    write_be32(images, (uint32_t)count);
+    write_be32(images, (uint32_t)rows);
+    write_be32(images, (uint32_t)cols);
+    const size_t total = count * rows * cols;
+    if (dtype == kIdxUint8) {
+        vector<uint8_t> bytes(total);
+        for (size_t i = 0; i < total; ++i) {
+            bytes[i] = (uint8_t)lrintf(min(max(pixels[i], 0.0f), 1.0f) * 255.0f);
+        }
+        images.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    } else {
+        for (size_t i = 0; i < total; ++i) {
+            uint32_t bits;
+            memcpy(&bits, &pixels[i], sizeof(bits));
+            write_be32(images, bits);
+        }
+    }
+
+    const char label_magic[4] = {0, 0, (char)kIdxUint8, 1};
+    label_out.write(label_magic, 4);
+    write_be32(label_out, (uint32_t)count);
+    label_out.write(reinterpret_cast<const char*>(labels), count);
+
+    images.close();
+    label_out.close();
+    if (!images || !label_out) {
+        cerr << "Error writing " << images_file << " / " << labels_file << endl;
+        remove(images_scratch.c_str());
+        remove(labels_scratch.c_str());
+        return false;
+    }
+    if (!CommitFile(images_scratch, images_file)) {
+        remove(labels_scratch.c_str());
+        return false;
+    }
+    return CommitFile(labels_scratch, labels_file);
+}
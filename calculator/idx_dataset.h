@@ -0,0 +1,65 @@
+#ifndef IDX_DATASET_H
+#define IDX_DATASET_H
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+using namespace std;
+
+// IDX (the MNIST container) element types used here.
+static const uint8_t kIdxUint8 = 0x08;
+static const uint8_t kIdxFloat32 = 0x0D;
+
+// A labeled image set stored as a pair of IDX files: images [N][rows][cols]
+// of uint8 (0..255) or big-endian float32 (0..1), and labels [N] of uint8.
+// Both files are mapped read-only; samples are decoded to floats only when
+// asked for. Readers decode through a PrefetchReader, so the floats resident
+// at any time are its ring of `depth` batches (4 by default), not the set.
+class IdxDataset {
+public:
+  // Maps and validates the pair. Returns null and reports to cerr if either
+  // file is malformed or they disagree on the sample count.
+  static unique_ptr<IdxDataset> Open(const string& images_file, const string& labels_file);
+
+  // Writes `count` samples of `rows` x `cols` floats from `pixels` and their
+  // labels. `dtype` is kIdxUint8 (pixels are scaled by 255 and rounded) or
+  // kIdxFloat32.
+  static bool Write(const string& images_file, const string& labels_file,
+                    const float* pixels, const uint8_t* labels, size_t count,
+                    size_t rows, size_t cols, uint8_t dtype);
+
+  ~IdxDataset();
+  IdxDataset(const IdxDataset&) = delete;
+  IdxDataset& operator=(const IdxDataset&) = delete;
+
+  size_t Size() const { return count; }
+  size_t Rows() const { return rows; }
+  size_t Cols() const { return cols; }
+  size_t Pixels() const { return rows * cols; }
+  uint8_t Dtype() const { return dtype; }
+
+  // Labels of all samples, pointing into the mapping.
+  const uint8_t* Labels() const { return labels; }
+
+  // Decodes samples [first, first + n) into `out` (n * Pixels() floats).
+  void Decode(size_t first, size_t n, float* out) const;
+  // Asks the kernel to start reading samples [first, first + n) in.
+  void WillNeed(size_t first, size_t n) const;
+
+private:
+  IdxDataset() = default;
+
+  void* images_base = nullptr;
+  size_t images_length = 0;
+  void* labels_base = nullptr;
+  size_t labels_length = 0;
+
+  const uint8_t* pixels = nullptr;  // start of the image payload
+  const uint8_t* labels = nullptr;
+  size_t count = 0, rows = 0, cols = 0;
+  uint8_t dtype = 0;
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "image_resample.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RESAMPLE_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Fixed-point precision of the taps, as in PIL: 8 bits of pixel and 2 of
+// headroom for negative lobes leave 22 in an int32 accumulator.
+static const int kPrecisionBits = 32 - 8 - 2;
+
+static double bicubic(double x) {
+    const double a = -0.5;
+    if (x < 0.0) x = -x;
+    if (x < 1.0) return ((a + 2.0) * x - (a + 3.0)) * x * x + 1;
+    if (x < 2.0) return (((x - 5) * x + 8) * x - 4) * a;
+    return 0.0;
+}
+
+namespace {
+
+// Taps mapping an axis of `in_size` pixels onto `out_size`: output i reads
+// inputs [first[i], first[i] + count[i]) with weights taps[i * ksize ...].
+struct Coefficients {
+    int ksize;
+    vector<int> first;
+    vector<int> count;
+    vector<int32_t> taps;
+};
+
+// PIL's precompute_coeffs followed by normalize_coeffs_8bpc.
+Coefficients ComputeCoefficients(int in_size, int out_size) {
+    const double support_1x = 2.0;
+    double scale = (double)in_size / out_size;
+    double filter_scale = scale < 1.0 ? 1.0 : scale;
+    double support = support_1x * filter_scale;
+    double inv_scale = 1.0 / filter_scale;
+
+    Coefficients c;
+    c.ksize = (int)ceil(support) * 2 + 1;
+    c.first.resize(out_size);
+    c.count.resize(out_size);
+    c.taps.assign((size_t)out_size * c.ksize, 0);
+
+    vector<double> k(c.ksize);
+    for (int i = 0; i < out_size; ++i) {
+        double center = (i + 0.5) * scale;
+        int xmin = (int)(center - support + 0.5);
+        if (xmin < 0) xmin = 0;
+        int xmax = (int)(center + support + 0.5);
+        if (xmax > in_size) xmax = in_size;
+        xmax -= xmin;
+
+        double total = 0.0;
+        for (int x = 0; x < xmax; ++x) {
+            k[x] = bicubic((x + xmin - center + 0.5) * inv_scale);
+            total += k[x];
+        }
+        for (int x = 0; x < xmax; ++x) {
+            double w = (total != 0.0) ? k[x] / total : k[x];
+            c.taps[(size_t)i * c.ksize + x] =
+                (int32_t)(w < 0 ? -0.5 + w * (1 << kPrecisionBits) : 0.5 + w * (1 << kPrecisionBits));
+        }
+        c.first[i] = xmin;
+        c.count[i] = xmax;
+    }
+    return c;
+}
+
+inline uint8_t Clip8(int32_t v) {
+    if (v >= (1 << kPrecisionBits << 8)) return 255;
+    if (v <= 0) return 0;
+    return (uint8_t)(v >> kPrecisionBits);
+}
+
+}  // namespace
+
+// sum(src[t] * taps[t]) for t in [0, n). Integer sums are exact, so every
+// kernel returns the same value.
+typedef int32_t (*TapKernel)(const uint8_t* src, const int32_t* taps, int n);
+
+static int32_t taps_scalar(const uint8_t* src, const int32_t* taps, int n) {
+    int32_t sum = 0;
+    for (int t = 0; t < n; ++t) sum += src[t] * taps[t];
+    return sum;
+}
+
+#ifdef RESAMPLE_X86
+
+// Widens 8 pixels to int32 lanes and multiplies them by 8 taps at a time.
+// Downsampling 1200 columns to 28 gives ~170 taps per output pixel, so this
+// loop is nearly all of the resize.
+__attribute__((target("avx2")))
+static int32_t taps_avx2(const uint8_t* src, const int32_t* taps, int n) {
+    __m256i acc = _mm256_setzero_si256();
+    int t = 0;
+    for (; t + 8 <= n; t += 8) {
+        __m256i pixels = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + t)));
+        __m256i weights = _mm256_loadu_si256((const __m256i*)(taps + t));
+        acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(pixels, weights));
+    }
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum) + taps_scalar(src + t, taps + t, n - t);
+}
+
+#endif // RESAMPLE_X86
+
+// Honors PERCEPTRON_KERNEL=scalar the same way dot_kernels() does.
+static TapKernel select_tap_kernel() {
+    const char* forced = getenv("PERCEPTRON_KERNEL");
+    if (forced && strcmp(forced, "scalar") == 0) return taps_scalar;
+#ifdef RESAMPLE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return taps_avx2;
+#endif
+    return taps_scalar;
+}
+
+static TapKernel tap_kernel() {
+    static TapKernel selected = select_tap_kernel();
+    return selected;
+}
+
+GrayImage resize_bicubic(const GrayImage& in, int out_width, int out_height) {
+    Coefficients horizontal = ComputeCoefficients(in.width, out_width);
+    Coefficients vertical = ComputeCoefficients(in.height, out_height);
+
+    // Only the source rows some output row reads need the horizontal pass.
+    const int row_first = vertical.first[0];
+    const int row_last = vertical.first[out_height - 1] + vertical.count[out_height - 1];
+
+    // Rows: each output pixel is a dot product of contiguous uint8 source
+    // pixels with int32 taps.
+    const TapKernel dot_taps = tap_kernel();
+    GrayImage temp;
+    temp.width = out_width;
+    temp.height = row_last - row_first;
+    temp.pixels.resize((size_t)temp.width * temp.height);
+    for (int y = 0; y < temp.height; ++y) {
+        const uint8_t* src = &in.pixels[(size_t)(y + row_first) * in.width];
+        uint8_t* dst = &temp.pixels[(size_t)y * temp.width];
+        for (int x = 0; x < out_width; ++x) {
+            const int32_t* k = &horizontal.taps[(size_t)x * horizontal.ksize];
+            int32_t sum = dot_taps(src + horizontal.first[x], k, horizontal.count[x]);
+            dst[x] = Clip8(sum + (1 << (kPrecisionBits - 1)));
+        }
+    }
+
+    // Columns: accumulate whole rows at a time so the inner loop runs across
+    // contiguous output pixels.
+    GrayImage out;
+    out.width = out_width;
+    out.height = out_height;
+    out.pixels.resize((size_t)out_width * out_height);
+    vector<int32_t> sums(out_width);
+    for (int y = 0; y < out_height; ++y) {
+        const int32_t* k = &vertical.taps[(size_t)y * vertical.ksize];
+        const int first = vertical.first[y] - row_first;
+        for (int x = 0; x < out_width; ++x) sums[x] = 1 << (kPrecisionBits - 1);
+        for (int t = 0; t < vertical.count[y]; ++t) {
+            const uint8_t* src = &temp.pixels[(size_t)(first + t) * out_width];
+            const int32_t kt = k[t];
+            for (int x = 0; x < out_width; ++x) sums[x] += src[x] * kt;
+        }
+        uint8_t* dst = &out.pixels[(size_t)y * out_width];
+        for (int x = 0; x < out_width; ++x) dst[x] = Clip8(sums[x]);
+    }
+    return out;
+}
+
+bool load_png_features(const string& filename, int width, int height, float* out) {
+    GrayImage image;
+    if (!decode_png_gray(filename, image)) {
+        return false;
+    }
+    GrayImage resized = resize_bicubic(image, width, height);
+    // np.array(img) / 255.0 is computed in double and then stored as float32.
+    for (size_t i = 0; i < resized.pixels.size(); ++i) {
+        out[i] = (float)(resized.pixels[i] / 255.0);
+    }
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef IMAGE_RESAMPLE_H
+#define IMAGE_RESAMPLE_H
+
+#include <string>
+#include <stdint.h>
+#include "png_decoder.h"
+using namespace std;
+
+// Resizes an 8-bit grayscale image with PIL's default filter for
+// Image.resize (bicubic, a = -0.5, widened by the scale factor when
+// downsampling so it antialiases). Like PIL's 8-bit path it resamples rows
+// then columns with 22-bit fixed-point taps, rounds the intermediate image
+// back to uint8, and clamps, so results match PIL exactly.
+GrayImage resize_bicubic(const GrayImage& in, int out_width, int out_height);
+
+// The training preprocessing in one call:
+//   Image.open(f).convert("L").resize((width, height)), then / 255.0
+// Writes width * height floats to `out`. Returns false (after reporting why)
+// if the file can't be decoded.
+bool load_png_features(const string& filename, int width, int height, float* out);
+
+#endif
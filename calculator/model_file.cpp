@@ -0,0 +1,199 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "model_file.h"
+#include "atomic_file.h"
+
+using namespace std;
+
+static_assert(sizeof(ModelFileHeader) == 64, "ModelFileHeader must stay 64 bytes");
+static_assert(sizeof(ModelInfo) == 64, "ModelInfo must stay 64 bytes");
+
+static const char kMagic[4] = { 'P', 'C', 'P', 'T' };
+
+struct Crc32Table {
+    uint32_t entries[256];
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+uint32_t Crc32(const void* data, size_t bytes) {
+    static const Crc32Table crc_table;
+    const uint32_t* table = crc_table.entries;
+
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < bytes; ++i) {
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+ModelFile::ModelFile(void* iBase, size_t iLength)
+    : base(iBase), length(iLength),
+      header(static_cast<const ModelFileHeader*>(iBase)) {
+    weights = reinterpret_cast<const float*>(static_cast<const char*>(iBase) + header->payload_offset);
+    info = DefaultModelInfo();
+}
+
+// Version 1 files carry no ModelInfo. Describe the stored shape instead of
+// assuming the a/b model: a square input when the size is a square (else one
+// row), and one label per class (two for a single output), "ab..." like the
+// default contract. Preprocessing keeps the default parameters.
+static ModelInfo info_for_shape(uint32_t inputs, uint32_t classes) {
+    ModelInfo info = DefaultModelInfo();
+    uint32_t side = 0;
+    while ((uint64_t)(side + 1) * (side + 1) <= inputs) side++;
+    if ((uint64_t)side * side == inputs && side <= 0xFFFF) {
+        info.input_width = (uint16_t)side;
+        info.input_height = (uint16_t)side;
+    } else {
+        info.input_width = (uint16_t)min<uint32_t>(inputs, 0xFFFF);
+        info.input_height = 1;
+    }
+    uint32_t labels = (classes == 1) ? 2 : classes;
+    info.num_labels = (uint16_t)min<uint32_t>(labels, 0xFFFF);
+    for (uint32_t k = 0; k < labels && k < (uint32_t)kMaxLabels; ++k) {
+        info.labels[k] = (char)(k < 26 ? 'a' + k : 'A' + (k - 26));
+    }
+    return info;
+}
+
+bool ValidateModelInfo(const ModelInfo& info, size_t inputs, size_t classes) {
+    size_t needed_labels = (classes == 1) ? 2 : classes;
+    if ((size_t)info.input_width * info.input_height != inputs) {
+        cerr << "Model info describes a " << info.input_width << "x" << info.input_height
+             << " input but the model has " << inputs << " inputs" << endl;
+        return false;
+    }
+    if (info.num_labels != needed_labels || info.num_labels >= kMaxLabels) {
+        cerr << "Model info has " << info.num_labels << " labels, expected " << needed_labels
+             << " (at most " << kMaxLabels - 1 << ")" << endl;
+        return false;
+    }
+    if (!(info.threshold >= 0.0f && info.threshold < 1.0f) || info.padding_den == 0) {
+        cerr << "Model info has invalid preprocessing parameters" << endl;
+        return false;
+    }
+    return true;
+}
+
+ModelFile::~ModelFile() {
+    munmap(base, length);
+}
+
+unique_ptr<ModelFile> ModelFile::Open(const string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        cerr << "Failed to open file: " << filename << endl;
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ModelFileHeader)) {
+        cerr << "Not a model file: " << filename << endl;
+        close(fd);
+        return nullptr;
+    }
+    size_t length = (size_t)st.st_size;
+    void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        cerr << "Failed to map file: " << filename << endl;
+        return nullptr;
+    }
+    // Build the owner first so every early return below unmaps.
+    unique_ptr<ModelFile> model(new ModelFile(base, length));
+
+    const ModelFileHeader* h = model->header;
+    if (memcmp(h->magic, kMagic, sizeof(kMagic)) != 0) {
+        cerr << "Not a model file: " << filename << endl;
+        return nullptr;
+    }
+    if (h->version < 1 || h->version > kModelFileVersion || h->dtype != kDtypeFloat32) {
+        cerr << "Unsupported model version " << h->version << " / dtype " << h->dtype
+             << ": " << filename << endl;
+        return nullptr;
+    }
+    // Both shapes are 32-bit, so the value count can't wrap; it is bounded by
+    // the file size before it is scaled to bytes, and the payload range is
+    // checked without adding untrusted offsets.
+    uint64_t values = (uint64_t)h->shape[0] * h->shape[1] + h->shape[1];
+    if (h->ndim < 1 || h->ndim > 2 || h->shape[0] == 0 || h->shape[1] == 0 ||
+        values > length / sizeof(float) || h->payload_bytes != values * sizeof(float) ||
+        h->payload_offset % kModelPayloadAlign != 0 || h->payload_offset > length ||
+        h->payload_bytes > length - h->payload_offset) {
+        cerr << "Corrupt model header: " << filename << endl;
+        return nullptr;
+    }
+    if (Crc32(model->weights, h->payload_bytes) != h->checksum) {
+        cerr << "Model checksum mismatch: " << filename << endl;
+        return nullptr;
+    }
+    if (h->version >= 2) {
+        if (h->payload_offset < sizeof(ModelFileHeader) + sizeof(ModelInfo)) {
+            cerr << "Corrupt model header: " << filename << endl;
+            return nullptr;
+        }
+        memcpy(&model->info, static_cast<const char*>(base) + sizeof(ModelFileHeader), sizeof(ModelInfo));
+    } else {
+        model->info = info_for_shape(h->shape[0], h->shape[1]);
+    }
+    if (!ValidateModelInfo(model->info, h->shape[0], h->shape[1])) {
+        cerr << "Bad model info: " << filename << endl;
+        return nullptr;
+    }
+    return model;
+}
+
+bool ModelFile::Write(const string& filename, const float* weights, size_t inputs,
+                      size_t classes, const float* biases, const ModelInfo& info) {
+    if (!ValidateModelInfo(info, inputs, classes)) {
+        return false;
+    }
+
+    vector<float> payload(weights, weights + inputs * classes);
+    payload.insert(payload.end(), biases, biases + classes);
+
+    ModelFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kModelFileVersion;
+    h.dtype = kDtypeFloat32;
+    h.ndim = (classes == 1) ? 1 : 2;
+    h.shape[0] = (uint32_t)inputs;
+    h.shape[1] = (uint32_t)classes;
+    h.payload_offset = 2 * kModelPayloadAlign;
+    h.payload_bytes = payload.size() * sizeof(float);
+    h.checksum = Crc32(payload.data(), h.payload_bytes);
+
+    // Replaced by rename, never rewritten in place: readers may have the
+    // current file mapped.
+    const string scratch = ScratchPath(filename);
+    ofstream file(scratch, ios::binary);
+    if (!file) {
+        cerr << "Failed to open file: " << scratch << endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    file.write(reinterpret_cast<const char*>(&info), sizeof(info));
+    file.write(reinterpret_cast<const char*>(payload.data()), h.payload_bytes);
+    file.close();
+    if (!file) {
+        cerr << "Error writing file: " << filename << endl;
+        remove(scratch.c_str());
+        return false;
+    }
+    return CommitFile(scratch, filename);
+}
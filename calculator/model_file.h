@@ -0,0 +1,95 @@
+#ifndef MODEL_FILE_H
+#define MODEL_FILE_H
+
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <stdint.h>
+#include "perceptron.h"
+#include "model_info.h"
+using namespace std;
+
+// Binary model container (.pcpt). All fields are little-endian.
+//
+//   offset  size  field
+//        0     4  magic "PCPT"
+//        4     2  version (2; version 1 files are still read)
+//        6     2  dtype (kDtypeFloat32)
+//        8     4  ndim: 1 for [inputs], 2 for [inputs][classes]
+//       12     8  shape[2] (uint32 each; shape[1] is 1 when ndim == 1)
+//       20     4  reserved, zero
+//       24     8  payload offset, a multiple of 64
+//       32     8  payload bytes
+//       40     4  CRC-32 of the payload
+//       44    20  reserved, zero
+//       64    64  ModelInfo (version 2 only; version 1 files get one built
+//                 from the shape: square input, labels "ab...")
+//
+// The payload is the weights in [inputs][classes] order followed by one bias
+// per class, all in `dtype`. Because the payload is 64-byte aligned in the
+// file and mmap returns page-aligned memory, the mapped weights can be used in
+// place.
+struct ModelFileHeader {
+  char magic[4];
+  uint16_t version;
+  uint16_t dtype;
+  uint32_t ndim;
+  uint32_t shape[2];
+  uint32_t reserved0;
+  uint64_t payload_offset;
+  uint64_t payload_bytes;
+  uint32_t checksum;
+  uint8_t reserved1[20];
+};
+
+static const uint16_t kModelFileVersion = 2;
+static const uint16_t kDtypeFloat32 = 0;
+static const size_t kModelPayloadAlign = 64;
+
+uint32_t Crc32(const void* data, size_t bytes);
+
+// A .pcpt file mapped read-only into memory. Nothing is parsed or copied:
+// Weights() and Biases() point into the mapping, which lives as long as the
+// ModelFile does.
+class ModelFile {
+public:
+  // Maps and validates `filename`. Returns null and reports to cerr if the
+  // file is missing, truncated, of an unknown version or dtype, or fails its
+  // checksum.
+  static unique_ptr<ModelFile> Open(const string& filename);
+
+  // Writes a float32 model. `weights` is [inputs][classes]; `biases` holds
+  // `classes` values. `info` must describe `inputs` pixels.
+  static bool Write(const string& filename, const float* weights, size_t inputs,
+                    size_t classes, const float* biases, const ModelInfo& info);
+
+  ~ModelFile();
+  ModelFile(const ModelFile&) = delete;
+  ModelFile& operator=(const ModelFile&) = delete;
+
+  size_t Inputs() const { return header->shape[0]; }
+  size_t Classes() const { return header->shape[1]; }
+  const float* Weights() const { return weights; }
+  const float* Biases() const { return weights + Inputs() * Classes(); }
+  size_t MappedBytes() const { return length; }
+  const ModelInfo& Info() const { return info; }
+
+  // Single-class models only. The Perceptron borrows the mapped weights and
+  // must not outlive this ModelFile.
+  Perceptron MakePerceptron() const { return Perceptron(Weights(), Inputs(), Biases()[0]); }
+
+private:
+  ModelFile(void* iBase, size_t iLength);
+
+  void* base;
+  size_t length;
+  const ModelFileHeader* header;
+  const float* weights;
+  ModelInfo info;
+};
+
+// Checks that `info` is usable with a model of `inputs` inputs and `classes`
+// outputs; reports the problem to cerr when it isn't.
+bool ValidateModelInfo(const ModelInfo& info, size_t inputs, size_t classes);
+
+#endif
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cctype>
+#include "model_header.h"
+#include "fixedpoint_perceptron.h"
+#include "atomic_file.h"
+
+using namespace std;
+
+// %.9g round-trips every float exactly.
+static string float_literal(float v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9gf", v);
+    string s(buf);
+    if (s.find_first_of(".en") == string::npos) s.insert(s.size() - 1, ".0");
+    return s;
+}
+
+static string string_literal(const char* s, size_t n) {
+    string out = "\"";
+    for (size_t i = 0; i < n; ++i) {
+        if (s[i] == '"' || s[i] == '\\') out += '\\';
+        out += s[i];
+    }
+    return out + "\"";
+}
+
+bool write_model_header(const string& filename, const string& name,
+                        const vector<float>& weights, float bias,
+                        const ModelInfo& info, const string& source) {
+    // Written beside the target and renamed over it, so a build never picks
+    // up a half-written header.
+    const string scratch = ScratchPath(filename);
+    ofstream out(scratch);
+    if (!out) {
+        cerr << "Failed to open file: " << scratch << endl;
+        return false;
+    }
+
+    // Guard from the file name, e.g. model_layer1.h -> MODEL_LAYER1_H.
+    string guard;
+    for (char c : filename.substr(filename.find_last_of("/\\") + 1)) {
+        guard += isalnum((unsigned char)c) ? (char)toupper((unsigned char)c) : '_';
+    }
+
+    out << "// Generated by `main export-header` from " << source << ". Do not edit.\n";
+    out << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+    out << "#include <stdint.h>\n";
+    out << "#include \"model_info.h\"\n\n";
+    out << "static const unsigned int " << name << "_len = " << weights.size() << ";\n\n";
+
+    out << "static constexpr float " << name << "[" << weights.size() << "] = {";
+    for (size_t i = 0; i < weights.size(); ++i) {
+        out << (i % 6 == 0 ? "\n  " : " ") << float_literal(weights[i]) << ",";
+    }
+    out << "\n};\n";
+    out << "static constexpr float " << name << "_bias = " << float_literal(bias) << ";\n\n";
+
+    out << "// Q16.16, for FixedPointPerceptron.\n";
+    out << "static constexpr int32_t " << name << "_q16[" << weights.size() << "] = {";
+    for (size_t i = 0; i < weights.size(); ++i) {
+        out << (i % 10 == 0 ? "\n  " : " ") << FixedPointPerceptron::ToWeight(weights[i]) << ",";
+    }
+    out << "\n};\n";
+    out << "static constexpr int32_t " << name << "_bias_q16 = "
+        << FixedPointPerceptron::ToWeight(bias) << ";\n\n";
+
+    out << "// {width, height, num_labels, reserved, threshold, padding_num, padding_den, labels}\n";
+    out << "static constexpr ModelInfo " << name << "_info = {"
+        << info.input_width << ", " << info.input_height << ", " << info.num_labels << ", 0, "
+        << float_literal(info.threshold) << ", " << info.padding_num << ", " << info.padding_den << ", "
+        << string_literal(info.labels, info.num_labels) << "};\n\n";
+
+    out << "#endif\n";
+    out.close();
+    if (!out) {
+        cerr << "Error writing file: " << filename << endl;
+        remove(scratch.c_str());
+        return false;
+    }
+    return CommitFile(scratch, filename);
+}
@@ -0,0 +1,19 @@
+#ifndef MODEL_HEADER_H
+#define MODEL_HEADER_H
+
+#include <vector>
+#include <string>
+#include "model_info.h"
+using namespace std;
+
+// Writes a C++ header that embeds a single-class model as constexpr tables:
+// `<name>` / `<name>_bias` as floats for Perceptron and `<name>_q16` /
+// `<name>_bias_q16` as Q16.16 integers for FixedPointPerceptron, plus the
+// model's ModelInfo as `<name>_info`. The tables
+// land in read-only data, so a front end that includes the header needs no
+// parsing and no heap at startup.
+bool write_model_header(const string& filename, const string& name,
+                        const vector<float>& weights, float bias,
+                        const ModelInfo& info, const string& source);
+
+#endif
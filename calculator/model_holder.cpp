@@ -0,0 +1,201 @@
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#endif
+#include "model_holder.h"
+#include "text_loader.h"
+
+using namespace std;
+
+// How long the watcher waits for a burst of writes (a retrain rewrites the
+// weights and then the biases) to go quiet before reloading.
+static const int kSettleMillis = 200;
+
+unique_ptr<ModelHolder> ModelHolder::Open(const string& model_path, const string& bias_path) {
+    unique_ptr<ModelHolder> holder(new ModelHolder(model_path, bias_path));
+    if (!holder->Reload()) {
+        return nullptr;
+    }
+    return holder;
+}
+
+ModelHolder::ModelHolder(const string& iModelPath, const string& iBiasPath)
+    : model_path(iModelPath), bias_path(iBiasPath), current(nullptr), epoch(0),
+      next_version(0), inotify_fd(-1), wake_fd(-1) {
+    readers[0] = 0;
+    readers[1] = 0;
+}
+
+ModelHolder::~ModelHolder() {
+    if (watcher.joinable()) {
+        uint64_t one = 1;
+        if (write(wake_fd, &one, sizeof(one)) < 0) {
+            cerr << "Failed to stop the model watcher" << endl;
+        }
+        watcher.join();
+    }
+    if (inotify_fd >= 0) close(inotify_fd);
+    if (wake_fd >= 0) close(wake_fd);
+    // No Reader may outlive the holder, so nothing can still see this.
+    delete current.load();
+}
+
+ModelHolder::Reader::Reader(const ModelHolder& iHolder) : holder(iHolder) {
+    // Count ourselves before looking at `current`: a publisher that swapped
+    // the pointer after this increment will wait for us before freeing.
+    slot = holder.epoch.load() & 1;
+    holder.readers[slot].fetch_add(1);
+    snapshot = holder.current.load();
+}
+
+ModelHolder::Reader::~Reader() {
+    holder.readers[slot].fetch_sub(1);
+}
+
+uint64_t ModelHolder::Version() const {
+    Reader reader(*this);
+    return reader->version;
+}
+
+unique_ptr<ModelSnapshot> ModelHolder::Load() const {
+    unique_ptr<ModelFile> file;
+    vector<float> weights;
+    float bias = 0.0f;
+    ModelInfo info = DefaultModelInfo();
+
+    if (bias_path.empty()) {
+        file = ModelFile::Open(model_path);
+        if (!file) return nullptr;
+        if (file->Classes() != 1) {
+            cerr << "Expected a single-class model: " << model_path << endl;
+            return nullptr;
+        }
+        info = file->Info();
+        weights.assign(file->Weights(), file->Weights() + file->Inputs());
+        bias = file->Biases()[0];
+    } else {
+        vector<float> biases;
+        if (!load_float_text(model_path, weights) || !load_float_text(bias_path, biases)) {
+            return nullptr;
+        }
+        if (weights.empty() || biases.size() != 1) {
+            cerr << "Expected a single-class model in " << model_path << " and " << bias_path << endl;
+            return nullptr;
+        }
+        bias = biases[0];
+    }
+
+    Perceptron perceptron(move(weights), bias);
+    if (!ValidateModelInfo(info, perceptron.InputSize(), 1)) {
+        return nullptr;
+    }
+    return unique_ptr<ModelSnapshot>(new ModelSnapshot{move(perceptron), info, 0});
+}
+
+bool ModelHolder::Reload() {
+    unique_ptr<ModelSnapshot> next = Load();
+    if (!next) {
+        return false;
+    }
+    Publish(move(next));
+    return true;
+}
+
+void ModelHolder::WaitForReaders(unsigned slot) const {
+    while (readers[slot].load() != 0) {
+        this_thread::yield();
+    }
+}
+
+void ModelHolder::Publish(unique_ptr<ModelSnapshot> next) {
+    lock_guard<mutex> lock(publish_mutex);
+    next->version = ++next_version;
+    const ModelSnapshot* old = current.exchange(next.release());
+    if (!old) return;
+
+    // Grace period. Any reader still holding `old` counted itself in one of
+    // the two slots before it loaded the pointer. Flip new readers to the
+    // other slot and drain this one, then flip back and drain the other;
+    // readers arriving meanwhile only ever see the new snapshot, so each
+    // wait ends.
+    unsigned e = epoch.load();
+    epoch.store(e + 1);
+    WaitForReaders(e & 1);
+    epoch.store(e + 2);
+    WaitForReaders((e + 1) & 1);
+    delete old;
+}
+
+#ifdef __linux__
+
+bool ModelHolder::Watch() {
+    if (watcher.joinable()) return true;
+
+    inotify_fd = inotify_init1(IN_CLOEXEC);
+    wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (inotify_fd < 0 || wake_fd < 0) {
+        cerr << "Failed to start watching: " << strerror(errno) << endl;
+        return false;
+    }
+
+    // Watch the directories rather than the files: savetxt and most editors
+    // replace a file (a new inode) instead of writing into it.
+    for (const string& path : {model_path, bias_path}) {
+        if (path.empty()) continue;
+        size_t slash = path.find_last_of('/');
+        string dir = (slash == string::npos) ? "." : path.substr(0, slash + 1);
+        string name = (slash == string::npos) ? path : path.substr(slash + 1);
+        int wd = inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            cerr << "Failed to watch " << dir << ": " << strerror(errno) << endl;
+            return false;
+        }
+        watched.push_back(make_pair(wd, name));
+    }
+
+    watcher = thread(&ModelHolder::WatchLoop, this);
+    return true;
+}
+
+void ModelHolder::WatchLoop() {
+    alignas(inotify_event) char buffer[4096];
+    bool pending = false;
+    while (true) {
+        pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {wake_fd, POLLIN, 0}};
+        int ready = poll(fds, 2, pending ? kSettleMillis : -1);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready < 0 || (fds[1].revents & POLLIN)) break;
+
+        if (ready == 0) {
+            // Quiet for kSettleMillis since the last change to a model file.
+            pending = false;
+            Reload();
+            continue;
+        }
+
+        ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            for (const auto& w : watched) {
+                if (event->wd == w.first && event->len > 0 && w.second == event->name) pending = true;
+            }
+            offset += sizeof(inotify_event) + event->len;
+        }
+    }
+}
+
+#else
+
+bool ModelHolder::Watch() {
+    cerr << "Watching model files needs inotify (Linux only)" << endl;
+    return false;
+}
+
+void ModelHolder::WatchLoop() {}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef MODEL_HOLDER_H
+#define MODEL_HOLDER_H
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <cstdint>
+#include <vector>
+#include "perceptron.h"
+#include "model_file.h"
+#include "model_info.h"
+using namespace std;
+
+// One loaded version of the model. Immutable once published. It owns a copy
+// of its weights rather than borrowing a file mapping, so nothing done to the
+// file afterwards (truncation included) reaches an in-flight Predict.
+struct ModelSnapshot {
+  Perceptron perceptron;
+  ModelInfo info;
+  uint64_t version;
+};
+
+// Serves a single-class model to any number of inference threads while the
+// model file is replaced underneath it.
+//
+// The current snapshot is published through an atomic pointer. Readers pin it
+// with a Reader guard, which costs two atomic increments and no lock, so a
+// Predict that is in flight when a new version lands finishes on the weights
+// it started with. Publishing swaps the pointer and then waits, on the
+// publishing thread, until every reader that could still see the old
+// snapshot has left before freeing it (an SRCU-style grace period over two
+// reader counters).
+//
+// Watch() starts a thread that waits for the model file(s) to be rewritten
+// (inotify, Linux only) and reloads them off the hot path. A version that
+// fails to load or validate is reported and the old one stays live.
+class ModelHolder {
+public:
+  // `model_path` is a .pcpt file, or a weights text file when `bias_path`
+  // is given. Returns null and reports to cerr if the first load fails.
+  static unique_ptr<ModelHolder> Open(const string& model_path, const string& bias_path = "");
+
+  ~ModelHolder();
+  ModelHolder(const ModelHolder&) = delete;
+  ModelHolder& operator=(const ModelHolder&) = delete;
+
+  // Pins the current snapshot for the guard's lifetime. Keep it short: a
+  // reload cannot free the previous version until its readers are gone.
+  class Reader {
+  public:
+    explicit Reader(const ModelHolder& iHolder);
+    ~Reader();
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    const ModelSnapshot& operator*() const { return *snapshot; }
+    const ModelSnapshot* operator->() const { return snapshot; }
+
+  private:
+    const ModelHolder& holder;
+    unsigned slot;
+    const ModelSnapshot* snapshot;
+  };
+
+  int Predict(const float* x, size_t count) const {
+    Reader reader(*this);
+    return reader->perceptron.Predict(x, count);
+  }
+
+  // Loads the files again and publishes the result. Returns false, keeping
+  // the current version, if they don't load.
+  bool Reload();
+
+  // Starts the watcher thread. Returns false if the files can't be watched.
+  bool Watch();
+
+  uint64_t Version() const;
+
+private:
+  ModelHolder(const string& iModelPath, const string& iBiasPath);
+
+  unique_ptr<ModelSnapshot> Load() const;
+  void Publish(unique_ptr<ModelSnapshot> next);
+  void WaitForReaders(unsigned slot) const;
+  void WatchLoop();
+
+  string model_path;
+  string bias_path;
+
+  atomic<const ModelSnapshot*> current;
+  // Readers count themselves in readers[epoch & 1] while they hold a snapshot.
+  atomic<unsigned> epoch;
+  mutable atomic<uint32_t> readers[2];
+
+  mutex publish_mutex;  // one publisher at a time
+  uint64_t next_version;
+
+  thread watcher;
+  int inotify_fd;
+  int wake_fd;
+  vector<pair<int, string>> watched;  // inotify watch descriptor, file name
+};
+
+#endif
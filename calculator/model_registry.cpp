@@ -0,0 +1,132 @@
+#include <iostream>
+#include <vector>
+#include "model_registry.h"
+
+using namespace std;
+
+shared_ptr<const LoadedModel> LoadedModel::Load(const string& filename) {
+    unique_ptr<ModelFile> file = ModelFile::Open(filename);
+    if (!file) {
+        return nullptr;
+    }
+
+    shared_ptr<LoadedModel> model(new LoadedModel());
+    model->info = file->Info();
+    model->inputs = file->Inputs();
+    if (file->Classes() == 1) {
+        model->single.reset(new Perceptron(file->MakePerceptron()));
+        model->file = move(file);
+    } else {
+        size_t inputs = file->Inputs(), classes = file->Classes();
+        vector<float> weights(file->Weights(), file->Weights() + inputs * classes);
+        vector<float> biases(file->Biases(), file->Biases() + classes);
+        model->bank.reset(new PerceptronBank(weights, inputs, biases,
+                                             string(model->info.labels, model->info.num_labels)));
+    }
+    return model;
+}
+
+int LoadedModel::Predict(const float* x, size_t count, float* score) const {
+    if (bank) {
+        return bank->Predict(x, count, score);
+    }
+    if (count != inputs) {
+        cerr << "Error: Input size (" << count
+             << ") doesn't match model input size (" << inputs << ")" << endl;
+        return -1;
+    }
+    if (!score) {
+        return single->Predict(x, count);
+    }
+    int label = -1;
+    single->PredictBatch(x, 1, count, &label, score);
+    return label;
+}
+
+size_t LoadedModel::ResidentBytes() const {
+    return bank ? bank->MemoryBytes() : file->MappedBytes();
+}
+
+ModelRegistry::ModelRegistry(const string& iDirectory, size_t iBudgetBytes)
+    : directory(iDirectory), budget(iBudgetBytes), resident(0), stats() {
+    if (!directory.empty() && directory.back() != '/') directory += '/';
+}
+
+shared_ptr<const LoadedModel> ModelRegistry::Get(const string& id) {
+    if (id.empty() || id.find('/') != string::npos || id[0] == '.') {
+        cerr << "Invalid model id: " << id << endl;
+        return nullptr;
+    }
+
+    unique_lock<mutex> guard(lock);
+    auto it = entries.find(id);
+    if (it != entries.end()) {
+        lru.splice(lru.begin(), lru, it->second.lru);
+        ModelFuture model = it->second.model;
+        if (it->second.bytes > 0) {
+            stats.hits++;
+        } else {
+            stats.collapsed++;
+        }
+        guard.unlock();
+        return model.get();
+    }
+
+    // First request: publish a future so later callers wait on this load,
+    // then load without holding the lock.
+    stats.misses++;
+    promise<shared_ptr<const LoadedModel>> loading;
+    lru.push_front(id);
+    entries[id] = Entry{loading.get_future().share(), lru.begin(), 0};
+    guard.unlock();
+
+    shared_ptr<const LoadedModel> model = LoadedModel::Load(directory + id + ".pcpt");
+    loading.set_value(model);
+
+    guard.lock();
+    it = entries.find(id);
+    if (!model) {
+        // Don't cache the failure; the next Get retries.
+        stats.failures++;
+        lru.erase(it->second.lru);
+        entries.erase(it);
+        return nullptr;
+    }
+    it->second.bytes = model->ResidentBytes();
+    resident += it->second.bytes;
+    EvictLocked();
+    return model;
+}
+
+void ModelRegistry::EvictLocked() {
+    // Walk from the least recently used end, never dropping the most recent
+    // entry or one that is still loading.
+    auto it = lru.end();
+    while (resident > budget && it != lru.begin()) {
+        --it;
+        if (it == lru.begin()) break;
+        auto entry = entries.find(*it);
+        if (entry->second.bytes == 0) continue;
+        resident -= entry->second.bytes;
+        stats.evictions++;
+        entries.erase(entry);
+        it = lru.erase(it);
+    }
+}
+
+void ModelRegistry::SetBudget(size_t bytes) {
+    lock_guard<mutex> guard(lock);
+    budget = bytes;
+    EvictLocked();
+}
+
+RegistryStats ModelRegistry::Stats() const {
+    lock_guard<mutex> guard(lock);
+    RegistryStats result = stats;
+    result.resident_models = 0;
+    for (const auto& entry : entries) {
+        if (entry.second.bytes > 0) result.resident_models++;
+    }
+    result.resident_bytes = resident;
+    return result;
+}
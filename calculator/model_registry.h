@@ -0,0 +1,93 @@
+#ifndef MODEL_REGISTRY_H
+#define MODEL_REGISTRY_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include "perceptron.h"
+#include "perceptron_bank.h"
+#include "model_file.h"
+#include "model_info.h"
+using namespace std;
+
+// A model ready to serve. Single-class models borrow the weights from their
+// mapped .pcpt file; multi-class models are repacked into a PerceptronBank
+// and the file is unmapped.
+class LoadedModel {
+public:
+  // Returns null and reports to cerr if `filename` doesn't load.
+  static shared_ptr<const LoadedModel> Load(const string& filename);
+
+  // Index of the predicted label and, if `score` is not null, the winning
+  // linear output. Returns -1 if the size doesn't match.
+  int Predict(const float* x, size_t count, float* score = nullptr) const;
+  char Label(int prediction) const { return info.labels[prediction]; }
+
+  const ModelInfo& Info() const { return info; }
+  size_t InputSize() const { return inputs; }
+  // Memory the model keeps resident: the mapping or the repacked bank.
+  size_t ResidentBytes() const;
+
+private:
+  LoadedModel() = default;
+
+  unique_ptr<ModelFile> file;
+  unique_ptr<Perceptron> single;
+  unique_ptr<PerceptronBank> bank;
+  ModelInfo info;
+  size_t inputs;
+};
+
+struct RegistryStats {
+  uint64_t hits;       // served from a resident model
+  uint64_t misses;     // started a load
+  uint64_t collapsed;  // waited on a load another caller had already started
+  uint64_t evictions;
+  uint64_t failures;   // loads that failed
+  size_t resident_models;
+  size_t resident_bytes;
+};
+
+// Loads models by id on demand and keeps them resident under a byte budget,
+// evicting the least recently used ones first. Model `id` is the file
+// `<directory>/<id>.pcpt`.
+//
+// Callers that ask for a model while it is loading wait for that one load
+// instead of starting their own. Eviction only drops the registry's
+// reference: a caller still holding the shared_ptr keeps using the model,
+// and the memory is released when the last holder lets go. The most
+// recently used model stays resident even if it alone exceeds the budget.
+class ModelRegistry {
+public:
+  ModelRegistry(const string& iDirectory, size_t iBudgetBytes);
+
+  // Returns the model, or null (after reporting why) if it doesn't load.
+  shared_ptr<const LoadedModel> Get(const string& id);
+
+  void SetBudget(size_t bytes);
+  RegistryStats Stats() const;
+
+private:
+  typedef shared_future<shared_ptr<const LoadedModel>> ModelFuture;
+  struct Entry {
+    ModelFuture model;
+    list<string>::iterator lru;
+    size_t bytes;  // 0 while loading
+  };
+
+  void EvictLocked();
+
+  string directory;
+  mutable mutex lock;
+  unordered_map<string, Entry> entries;
+  list<string> lru;  // most recently used first
+  size_t budget;
+  size_t resident;
+  RegistryStats stats;
+};
+
+#endif
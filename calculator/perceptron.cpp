@@ -1,29 +1,169 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <cstring>
 #include "perceptron.h"
+#include "dot_kernels.h"
+#include "sparse_input.h"
 
 using namespace std;
 
-Perceptron::Perceptron(vector<float> iWeights, float iBias) {
-    weights = iWeights;
-    bias = iBias;
+Perceptron::Perceptron(vector<float> iWeights, float iBias)
+    : weights(move(iWeights)), borrowed(nullptr), borrowed_count(0), bias(iBias) {
 }
 
-int Perceptron::Predict(vector<float> x) {
-    if (x.size() != weights.size()) {
-        cerr << "Error: Input size (" << x.size() 
-             << ") doesn't match weights size (" << weights.size() << ")" << endl;
+Perceptron::Perceptron(const float* iWeights, size_t count, float iBias)
+    : borrowed(iWeights), borrowed_count(count), bias(iBias) {
+}
+
+int Perceptron::Predict(const float* x, size_t count) const {
+    if (count != InputSize()) {
+        cerr << "Error: Input size (" << count 
+             << ") doesn't match weights size (" << InputSize() << ")" << endl;
         return -1;
     }
     
-    float linear_output = 0.0;
-    for (unsigned int i = 0; i < x.size(); ++i) {
-        linear_output += x[i] * weights[i];
-    }
+    float linear_output = dot_kernels().dot(x, Weights(), count);
     linear_output += bias;
     
     int prediction = (linear_output > 0) ? 1 : 0;
     
     return prediction;
-}
\ No newline at end of file
+}
+
+// Rows scored per pass over the weights in PredictBatch.
+static const size_t kBatchTile = 4;
+
+bool Perceptron::PredictBatch(const float* x, size_t rows, size_t stride,
+                              int* labels, float* logits) const {
+    const size_t n = InputSize();
+    if (stride < n) {
+        cerr << "Error: Row stride (" << stride
+             << ") is smaller than weights size (" << n << ")" << endl;
+        return false;
+    }
+
+    const float* w = Weights();
+    const DotKernels& kernels = dot_kernels();
+    size_t r = 0;
+
+    // Each weight is loaded once and applied to a whole tile of rows, so the
+    // weight vector is streamed rows / kBatchTile times instead of rows times.
+    for (; r + kBatchTile <= rows; r += kBatchTile) {
+        const float* tile[kBatchTile] = {
+            x + (r + 0) * stride, x + (r + 1) * stride,
+            x + (r + 2) * stride, x + (r + 3) * stride
+        };
+        float acc[kBatchTile];
+        kernels.dot4(tile, w, n, acc);
+
+        for (size_t t = 0; t < kBatchTile; ++t) {
+            float linear_output = acc[t] + bias;
+            if (logits) logits[r + t] = linear_output;
+            if (labels) labels[r + t] = (linear_output > 0) ? 1 : 0;
+        }
+    }
+
+    for (; r < rows; ++r) {
+        float linear_output = kernels.dot(x + r * stride, w, n) + bias;
+        if (logits) logits[r] = linear_output;
+        if (labels) labels[r] = (linear_output > 0) ? 1 : 0;
+    }
+
+    return true;
+}
+
+float Perceptron::LogitBits(const uint8_t* bits) const {
+    const size_t n = InputSize();
+    const float* w = Weights();
+    float linear_output = 0.0f;
+
+    // Walk the mask 64 bits at a time and visit only the set bits.
+    for (size_t base = 0; base < n; base += 64) {
+        size_t nbytes = FeatureBitsBytes(n - base);
+        if (nbytes > 8) nbytes = 8;
+        // Little-endian load: byte b of the mask lands in bits 8b..8b+7.
+        uint64_t word = 0;
+        memcpy(&word, bits + base / 8, nbytes);
+        if (n - base < 64) {
+            word &= ((uint64_t)1 << (n - base)) - 1;
+        }
+        while (word) {
+            linear_output += w[base + __builtin_ctzll(word)];
+            word &= word - 1;
+        }
+    }
+
+    return linear_output + bias;
+}
+
+int Perceptron::PredictBits(const uint8_t* bits, size_t count) const {
+    if (count != InputSize()) {
+        cerr << "Error: Input size (" << count
+             << ") doesn't match weights size (" << InputSize() << ")" << endl;
+        return -1;
+    }
+
+    int prediction = (LogitBits(bits) > 0) ? 1 : 0;
+
+    return prediction;
+}
+
+void PackFeatureBits(const float* x, size_t count, uint8_t* bits, float threshold) {
+    memset(bits, 0, FeatureBitsBytes(count));
+    for (size_t i = 0; i < count; ++i) {
+        if (x[i] > threshold) bits[i / 8] |= (uint8_t)(1u << (i % 8));
+    }
+}
+
+// Gathers the weights at `indices`. A row with all n entries is stored
+// dense (see sparse_input.h), so its values go straight to the SIMD kernel.
+static float sparse_dot(const uint32_t* indices, const float* values, size_t nnz,
+                        const float* w, size_t n) {
+    if (nnz == n) {
+        return dot_kernels().dot(values, w, n);
+    }
+
+    float sum = 0.0f;
+    for (size_t j = 0; j < nnz; ++j) {
+        sum += values[j] * w[indices[j]];
+    }
+    return sum;
+}
+
+float Perceptron::LogitSparse(const SparseVector& x) const {
+    return sparse_dot(x.indices.data(), x.values.data(), x.indices.size(),
+                      Weights(), InputSize()) + bias;
+}
+
+int Perceptron::PredictSparse(const SparseVector& x) const {
+    if (x.size != InputSize()) {
+        cerr << "Error: Input size (" << x.size
+             << ") doesn't match weights size (" << InputSize() << ")" << endl;
+        return -1;
+    }
+
+    int prediction = (LogitSparse(x) > 0) ? 1 : 0;
+
+    return prediction;
+}
+
+bool Perceptron::PredictSparseBatch(const SparseBatch& x, int* labels, float* logits) const {
+    const size_t n = InputSize();
+    if (x.cols != n) {
+        cerr << "Error: Input size (" << x.cols
+             << ") doesn't match weights size (" << n << ")" << endl;
+        return false;
+    }
+
+    for (size_t r = 0; r < x.Rows(); ++r) {
+        size_t begin = x.row_offsets[r];
+        size_t nnz = x.row_offsets[r + 1] - begin;
+        float linear_output = sparse_dot(x.indices.data() + begin, x.values.data() + begin,
+                                         nnz, Weights(), n) + bias;
+        if (logits) logits[r] = linear_output;
+        if (labels) labels[r] = (linear_output > 0) ? 1 : 0;
+    }
+
+    return true;
+}
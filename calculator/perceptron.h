@@ -2,16 +2,58 @@
 #define PERCEPTRON_H
 
 #include <vector>
+#include <cstddef>
+#include <stdint.h>
 using namespace std;
 
+struct SparseVector;
+struct SparseBatch;
+
 class Perceptron {
 public:
+  // Takes ownership of the weights; pass an rvalue to avoid the copy.
   Perceptron(vector<float> iWeights, float iBias);
-  int Predict(vector<float> x);  
+  // Borrows `count` weights owned by the caller (a static table, a mapped
+  // file, ...). The memory must outlive the Perceptron and every copy of it.
+  Perceptron(const float* iWeights, size_t count, float iBias);
+
+  int Predict(const float* x, size_t count) const;
+  int Predict(const vector<float>& x) const { return Predict(x.data(), x.size()); }
+
+  // Scores a binary input given as a bitmask: input i is 1.0 when bit i % 8
+  // of bits[i / 8] is set, else 0.0. Only the weights at set bits are
+  // summed. `count` is the number of inputs, not bytes.
+  int PredictBits(const uint8_t* bits, size_t count) const;
+  float LogitBits(const uint8_t* bits) const;
+
+  // Scores an input given as its nonzero entries by gathering only those
+  // weights. Rows that FromDense kept dense go through the SIMD kernel.
+  int PredictSparse(const SparseVector& x) const;
+  float LogitSparse(const SparseVector& x) const;
+  bool PredictSparseBatch(const SparseBatch& x, int* labels, float* logits) const;
+
+  // Scores `rows` inputs stored row-major in `x`, each row starting `stride`
+  // floats after the previous one. Writes one label per row into `labels`
+  // and the raw linear output into `logits`; either may be null.
+  // Returns false if stride is smaller than the weights size.
+  bool PredictBatch(const float* x, size_t rows, size_t stride,
+                    int* labels, float* logits) const;
+
+  size_t InputSize() const { return borrowed ? borrowed_count : weights.size(); }
+  const float* Weights() const { return borrowed ? borrowed : weights.data(); }
+  float Bias() const { return bias; }
 
 private:
   vector<float> weights;
+  const float* borrowed;
+  size_t borrowed_count;
   float bias;
 };
 
+// Bytes needed to hold `count` binary inputs as a bitmask.
+inline size_t FeatureBitsBytes(size_t count) { return (count + 7) / 8; }
+
+// Packs `count` features into a bitmask, setting bit i when x[i] > threshold.
+void PackFeatureBits(const float* x, size_t count, uint8_t* bits, float threshold = 0.5f);
+
 #endif
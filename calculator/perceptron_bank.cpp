@@ -0,0 +1,61 @@
+#include <vector>
+#include <iostream>
+#include "perceptron_bank.h"
+
+using namespace std;
+
+PerceptronBank::PerceptronBank(const vector<float>& iWeights, size_t inputs,
+                               const vector<float>& iBiases, const string& iLabels)
+    : inputs(inputs), classes(iBiases.size()), labels(iLabels) {
+    padded = (classes + kClassLanes - 1) / kClassLanes * kClassLanes;
+
+    // Padding lanes keep zero weights and a zero bias; Predict never reads
+    // them back.
+    weights.assign(inputs * padded, 0.0f);
+    for (size_t i = 0; i < inputs; ++i) {
+        for (size_t k = 0; k < classes; ++k) {
+            weights[i * padded + k] = iWeights[i * classes + k];
+        }
+    }
+    biases.assign(padded, 0.0f);
+    for (size_t k = 0; k < classes; ++k) {
+        biases[k] = iBiases[k];
+    }
+}
+
+int PerceptronBank::Predict(const float* x, size_t count, float* score) const {
+    if (count != inputs) {
+        cerr << "Error: Input size (" << count
+             << ") doesn't match bank input size (" << inputs << ")" << endl;
+        return -1;
+    }
+
+    if (classes > kMaxClasses) {
+        cerr << "Error: Bank has " << classes << " classes, at most " << kMaxClasses
+             << " are supported" << endl;
+        return -1;
+    }
+
+    // One pass over the input; a fixed stack array keeps the hot path free
+    // of allocations.
+    float acc[(kMaxClasses + kClassLanes - 1) / kClassLanes * kClassLanes];
+    float* a = acc;
+    for (size_t k = 0; k < padded; ++k) a[k] = biases[k];
+    const float* w = weights.data();
+    for (size_t i = 0; i < inputs; ++i, w += padded) {
+        float xi = x[i];
+        // Strokes cover few pixels; blank ones contribute nothing.
+        if (xi == 0.0f) continue;
+        for (size_t k = 0; k < padded; ++k) {
+            a[k] += xi * w[k];
+        }
+    }
+
+    int best = 0;
+    for (size_t k = 1; k < classes; ++k) {
+        if (a[k] > a[best]) best = (int)k;
+    }
+    float best_score = classes ? a[best] : 0.0f;
+    if (score) *score = best_score;
+    return best;
+}
@@ -0,0 +1,49 @@
+#ifndef PERCEPTRON_BANK_H
+#define PERCEPTRON_BANK_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "model_info.h"
+using namespace std;
+
+// One-vs-rest bank of K perceptrons that share one input. Weights are stored
+// pixel-major, class-minor ([input][class]) with the class dimension padded to
+// kClassLanes, so one pass over the input updates all K accumulators with a
+// contiguous, vectorizable row per pixel.
+class PerceptronBank {
+public:
+  static const size_t kClassLanes = 8;
+  // The accumulators live on the stack; a bank has at most as many classes
+  // as a model has labels.
+  static const size_t kMaxClasses = kMaxLabels - 1;
+
+  // `iWeights` is row-major [inputs][classes], the layout of a Dense(K)
+  // kernel written by np.savetxt. `iLabels` names each class, e.g. "ab".
+  PerceptronBank(const vector<float>& iWeights, size_t inputs,
+                 const vector<float>& iBiases, const string& iLabels);
+
+  // Returns the index of the highest scoring class and, if `score` is not
+  // null, its linear output. Returns -1 if the size doesn't match or the bank
+  // has more than kMaxClasses classes.
+  int Predict(const float* x, size_t count, float* score = nullptr) const;
+  int Predict(const vector<float>& x, float* score = nullptr) const {
+    return Predict(x.data(), x.size(), score);
+  }
+
+  char Label(int cls) const { return labels[cls]; }
+  size_t NumClasses() const { return classes; }
+  size_t InputSize() const { return inputs; }
+  // Heap bytes held by the repacked weights.
+  size_t MemoryBytes() const { return (weights.size() + biases.size()) * sizeof(float) + labels.size(); }
+
+private:
+  vector<float> weights;
+  vector<float> biases;
+  size_t inputs;
+  size_t classes;
+  size_t padded;
+  string labels;
+};
+
+#endif
@@ -0,0 +1,455 @@
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cstdlib>
+#include "png_decoder.h"
+#include "model_file.h"
+
+using namespace std;
+
+// ---- inflate ---------------------------------------------------------------
+//
+// A canonical-Huffman decoder in the style of zlib's puff: codes are read a
+// bit at a time against per-length counts. It is not the fastest inflate, but
+// images here are mostly flat background that compresses into long matches,
+// so decoding is a small part of loading one.
+
+namespace {
+
+struct BitReader {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    uint32_t buffer;
+    int available;
+    bool overrun;
+
+    int Bits(int need) {
+        uint32_t value = buffer;
+        while (available < need) {
+            if (pos >= size) {
+                overrun = true;
+                return 0;
+            }
+            value |= (uint32_t)data[pos++] << available;
+            available += 8;
+        }
+        buffer = value >> need;
+        available -= need;
+        return (int)(value & ((1u << need) - 1));
+    }
+};
+
+static const int kMaxCodeBits = 15;
+
+struct Huffman {
+    short count[kMaxCodeBits + 1];  // number of codes of each length
+    short symbol[288];              // symbols ordered by code
+};
+
+// Builds the decoding tables from code lengths. Returns false if the lengths
+// over-subscribe the code space; incomplete codes are allowed, as in zlib,
+// and fail only if an unused code turns up.
+bool BuildHuffman(Huffman& h, const short* lengths, int n) {
+    memset(h.count, 0, sizeof(h.count));
+    for (int s = 0; s < n; ++s) h.count[lengths[s]]++;
+    if (h.count[0] == n) return true;
+
+    int left = 1;
+    for (int len = 1; len <= kMaxCodeBits; ++len) {
+        left = (left << 1) - h.count[len];
+        if (left < 0) return false;
+    }
+
+    short offsets[kMaxCodeBits + 1];
+    offsets[1] = 0;
+    for (int len = 1; len < kMaxCodeBits; ++len) offsets[len + 1] = offsets[len] + h.count[len];
+    for (int s = 0; s < n; ++s) {
+        if (lengths[s] != 0) h.symbol[offsets[lengths[s]]++] = (short)s;
+    }
+    return true;
+}
+
+int Decode(BitReader& in, const Huffman& h) {
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len <= kMaxCodeBits; ++len) {
+        code |= in.Bits(1);
+        int count = h.count[len];
+        if (code - count < first) return h.symbol[index + (code - first)];
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+const short kLengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                               35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const short kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const short kDistBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                             257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                             8193, 12289, 16385, 24577};
+const short kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                              7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Decodes one compressed block's symbols into `out`. `start` is where this
+// stream's output begins; back-references may not reach before it.
+bool InflateCodes(BitReader& in, const Huffman& lengths, const Huffman& distances,
+                  vector<uint8_t>& out, size_t start) {
+    while (true) {
+        int symbol = Decode(in, lengths);
+        if (symbol < 0 || in.overrun) return false;
+        if (symbol < 256) {
+            out.push_back((uint8_t)symbol);
+            continue;
+        }
+        if (symbol == 256) return true;
+
+        symbol -= 257;
+        if (symbol >= 29) return false;
+        size_t length = kLengthBase[symbol] + in.Bits(kLengthExtra[symbol]);
+        int dsym = Decode(in, distances);
+        if (dsym < 0 || dsym >= 30) return false;
+        size_t dist = kDistBase[dsym] + in.Bits(kDistExtra[dsym]);
+        if (in.overrun || dist > out.size() - start) return false;
+
+        // Byte by byte: the source may overlap what is being written.
+        size_t from = out.size() - dist;
+        for (size_t i = 0; i < length; ++i) out.push_back(out[from + i]);
+    }
+}
+
+bool InflateStored(BitReader& in, vector<uint8_t>& out) {
+    in.buffer = 0;
+    in.available = 0;
+    if (in.pos + 4 > in.size) return false;
+    unsigned len = in.data[in.pos] | (in.data[in.pos + 1] << 8);
+    unsigned nlen = in.data[in.pos + 2] | (in.data[in.pos + 3] << 8);
+    in.pos += 4;
+    if (len != (~nlen & 0xFFFF) || in.pos + len > in.size) return false;
+    out.insert(out.end(), in.data + in.pos, in.data + in.pos + len);
+    in.pos += len;
+    return true;
+}
+
+bool InflateFixed(BitReader& in, vector<uint8_t>& out, size_t start) {
+    static Huffman lengths, distances;
+    static bool built = [] {
+        short l[288];
+        int s = 0;
+        for (; s < 144; ++s) l[s] = 8;
+        for (; s < 256; ++s) l[s] = 9;
+        for (; s < 280; ++s) l[s] = 7;
+        for (; s < 288; ++s) l[s] = 8;
+        BuildHuffman(lengths, l, 288);
+        for (s = 0; s < 30; ++s) l[s] = 5;
+        BuildHuffman(distances, l, 30);
+        return true;
+    }();
+    (void)built;
+    return InflateCodes(in, lengths, distances, out, start);
+}
+
+bool InflateDynamic(BitReader& in, vector<uint8_t>& out, size_t start) {
+    static const short kOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    int nlen = in.Bits(5) + 257;
+    int ndist = in.Bits(5) + 1;
+    int ncode = in.Bits(4) + 4;
+    if (nlen > 286 || ndist > 30) return false;
+
+    short lengths[320];
+    int index;
+    for (index = 0; index < ncode; ++index) lengths[kOrder[index]] = (short)in.Bits(3);
+    for (; index < 19; ++index) lengths[kOrder[index]] = 0;
+    Huffman codes, lencode, distcode;
+    if (!BuildHuffman(codes, lengths, 19)) return false;
+
+    for (index = 0; index < nlen + ndist;) {
+        int symbol = Decode(in, codes);
+        if (symbol < 0 || in.overrun) return false;
+        if (symbol < 16) {
+            lengths[index++] = (short)symbol;
+            continue;
+        }
+        short repeat_length = 0;
+        int repeat;
+        if (symbol == 16) {
+            if (index == 0) return false;
+            repeat_length = lengths[index - 1];
+            repeat = 3 + in.Bits(2);
+        } else if (symbol == 17) {
+            repeat = 3 + in.Bits(3);
+        } else {
+            repeat = 11 + in.Bits(7);
+        }
+        if (index + repeat > nlen + ndist) return false;
+        while (repeat--) lengths[index++] = repeat_length;
+    }
+    if (lengths[256] == 0) return false;  // no end-of-block code
+
+    if (!BuildHuffman(lencode, lengths, nlen) || !BuildHuffman(distcode, lengths + nlen, ndist)) {
+        return false;
+    }
+    return InflateCodes(in, lencode, distcode, out, start);
+}
+
+}  // namespace
+
+bool zlib_inflate(const uint8_t* data, size_t size, vector<uint8_t>& out) {
+    // CMF/FLG: deflate, window <= 32K, no preset dictionary, valid check bits.
+    if (size < 6 || (data[0] & 0x0F) != 8 || (data[0] >> 4) > 7 || (data[1] & 0x20) ||
+        ((data[0] << 8) | data[1]) % 31 != 0) {
+        return false;
+    }
+
+    BitReader in = {data, size, 2, 0, 0, false};
+    const size_t start = out.size();
+    int last;
+    do {
+        last = in.Bits(1);
+        int type = in.Bits(2);
+        bool ok = (type == 0) ? InflateStored(in, out)
+                : (type == 1) ? InflateFixed(in, out, start)
+                : (type == 2) ? InflateDynamic(in, out, start)
+                : false;
+        if (!ok || in.overrun) return false;
+    } while (!last);
+
+    // Adler-32 of the output follows, big-endian, on a byte boundary.
+    if (in.pos + 4 > size) return false;
+    uint32_t a = 1, b = 0;
+    for (size_t i = start; i < out.size(); ++i) {
+        a = (a + out[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    const uint8_t* p = data + in.pos;
+    uint32_t expected = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    return ((b << 16) | a) == expected;
+}
+
+// ---- PNG -------------------------------------------------------------------
+
+static uint32_t read_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// PIL's ITU-R 601-2 luma transform in 16-bit fixed point.
+static inline uint8_t luma(uint32_t r, uint32_t g, uint32_t b) {
+    return (uint8_t)((r * 19595 + g * 38470 + b * 7471 + 0x8000) >> 16);
+}
+
+static inline uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return (uint8_t)a;
+    return (uint8_t)(pb <= pc ? b : c);
+}
+
+// Undoes the filter of one scanline in place. `prior` is the unfiltered
+// previous line of the same pass, or null for its first line.
+static bool unfilter(uint8_t filter, uint8_t* row, const uint8_t* prior, size_t stride, size_t bpp) {
+    switch (filter) {
+    case 0:
+        return true;
+    case 1:
+        for (size_t i = bpp; i < stride; ++i) row[i] += row[i - bpp];
+        return true;
+    case 2:
+        if (prior) for (size_t i = 0; i < stride; ++i) row[i] += prior[i];
+        return true;
+    case 3:
+        for (size_t i = 0; i < stride; ++i) {
+            int left = i >= bpp ? row[i - bpp] : 0;
+            int up = prior ? prior[i] : 0;
+            row[i] += (uint8_t)((left + up) >> 1);
+        }
+        return true;
+    case 4:
+        for (size_t i = 0; i < stride; ++i) {
+            int left = i >= bpp ? row[i - bpp] : 0;
+            int up = prior ? prior[i] : 0;
+            int up_left = (prior && i >= bpp) ? prior[i - bpp] : 0;
+            row[i] += paeth(left, up, up_left);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+namespace {
+
+struct PngHeader {
+    uint32_t width, height;
+    int depth;
+    int color_type;
+    int channels;
+    bool interlaced;
+    uint8_t palette_gray[256];
+};
+
+}  // namespace
+
+// Converts one unfiltered scanline of `count` pixels to gray, writing pixel
+// i to out[i * step].
+static void row_to_gray(const PngHeader& h, const uint8_t* row, size_t count, uint8_t* out, size_t step) {
+    const int depth = h.depth;
+    if (depth < 8) {
+        const int mask = (1 << depth) - 1;
+        for (size_t i = 0; i < count; ++i) {
+            size_t bit = i * depth;
+            int v = (row[bit / 8] >> (8 - depth - (int)(bit % 8))) & mask;
+            out[i * step] = (h.color_type == 3) ? h.palette_gray[v] : (uint8_t)(v * 255 / mask);
+        }
+        return;
+    }
+
+    // 16-bit samples keep their high byte, which comes first, except plain
+    // gray: PIL opens that as a 16-bit integer image ("I;16"), and its
+    // conversion to "L" clamps the value to 255 instead of scaling it.
+    const size_t sample = depth / 8;
+    const size_t pixel = h.channels * sample;
+    switch (h.color_type) {
+    case 0:
+        if (sample == 2) {
+            for (size_t i = 0; i < count; ++i) {
+                const uint8_t* p = row + i * pixel;
+                out[i * step] = p[0] ? 255 : p[1];
+            }
+            break;
+        }
+        for (size_t i = 0; i < count; ++i) out[i * step] = row[i * pixel];
+        break;
+    case 4:
+        for (size_t i = 0; i < count; ++i) out[i * step] = row[i * pixel];
+        break;
+    case 2:
+    case 6:
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t* p = row + i * pixel;
+            out[i * step] = luma(p[0], p[sample], p[2 * sample]);
+        }
+        break;
+    case 3:
+        for (size_t i = 0; i < count; ++i) out[i * step] = h.palette_gray[row[i]];
+        break;
+    }
+}
+
+bool decode_png_gray(const string& filename, GrayImage& image) {
+    ifstream file(filename, ios::binary);
+    if (!file) {
+        cerr << "Failed to open file: " << filename << endl;
+        return false;
+    }
+    vector<uint8_t> bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    static const uint8_t kSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (bytes.size() < 8 || memcmp(bytes.data(), kSignature, 8) != 0) {
+        cerr << "Not a PNG file: " << filename << endl;
+        return false;
+    }
+
+    PngHeader h;
+    memset(&h, 0, sizeof(h));
+    bool have_header = false, have_end = false;
+    size_t palette_size = 0;
+    vector<uint8_t> compressed;
+    for (size_t pos = 8; pos + 12 <= bytes.size() && !have_end;) {
+        uint32_t length = read_be32(&bytes[pos]);
+        const uint8_t* type = &bytes[pos + 4];
+        const uint8_t* data = type + 4;
+        if (length > bytes.size() - pos - 12 ||
+            Crc32(type, length + 4) != read_be32(data + length)) {
+            cerr << "Corrupt PNG chunk in " << filename << endl;
+            return false;
+        }
+        pos += 12 + length;
+
+        if (memcmp(type, "IHDR", 4) == 0 && length == 13) {
+            h.width = read_be32(data);
+            h.height = read_be32(data + 4);
+            h.depth = data[8];
+            h.color_type = data[9];
+            h.interlaced = data[12] == 1;
+            static const int kChannels[7] = {1, 0, 3, 1, 2, 0, 4};
+            h.channels = h.color_type <= 6 ? kChannels[h.color_type] : 0;
+            int d = h.depth;
+            bool depth_ok = (h.color_type == 0) ? (d == 1 || d == 2 || d == 4 || d == 8 || d == 16)
+                          : (h.color_type == 3) ? (d == 1 || d == 2 || d == 4 || d == 8)
+                          : (d == 8 || d == 16);
+            if (h.width == 0 || h.height == 0 || h.width > (1u << 15) || h.height > (1u << 15) ||
+                h.channels == 0 || !depth_ok || data[10] != 0 || data[11] != 0 || data[12] > 1) {
+                cerr << "Unsupported PNG header in " << filename << endl;
+                return false;
+            }
+            have_header = true;
+        } else if (memcmp(type, "PLTE", 4) == 0 && length % 3 == 0 && length <= 768) {
+            palette_size = length / 3;
+            for (size_t i = 0; i < palette_size; ++i) {
+                h.palette_gray[i] = luma(data[3 * i], data[3 * i + 1], data[3 * i + 2]);
+            }
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), data, data + length);
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            have_end = true;
+        } else if (!(type[0] & 0x20)) {
+            cerr << "Unsupported critical PNG chunk " << string((const char*)type, 4)
+                 << " in " << filename << endl;
+            return false;
+        }
+    }
+    if (!have_header || !have_end || (h.color_type == 3 && palette_size == 0)) {
+        cerr << "Incomplete PNG file: " << filename << endl;
+        return false;
+    }
+
+    vector<uint8_t> raw;
+    if (!zlib_inflate(compressed.data(), compressed.size(), raw)) {
+        cerr << "Corrupt PNG image data in " << filename << endl;
+        return false;
+    }
+
+    image.width = (int)h.width;
+    image.height = (int)h.height;
+    image.pixels.assign((size_t)h.width * h.height, 0);
+
+    // Adam7 passes: origin and step of each pass's sub-image. A plain image
+    // is the single pass (0, 0, 1, 1).
+    static const int kAdam7[7][4] = {{0, 0, 8, 8}, {4, 0, 8, 8}, {0, 4, 4, 8}, {2, 0, 4, 4},
+                                     {0, 2, 2, 4}, {1, 0, 2, 2}, {0, 1, 1, 2}};
+    static const int kSinglePass[1][4] = {{0, 0, 1, 1}};
+    const int (*passes)[4] = h.interlaced ? kAdam7 : kSinglePass;
+    const int num_passes = h.interlaced ? 7 : 1;
+
+    const size_t bits_per_pixel = (size_t)h.channels * h.depth;
+    const size_t bpp = (bits_per_pixel + 7) / 8;
+    size_t offset = 0;
+    for (int p = 0; p < num_passes; ++p) {
+        const int x0 = passes[p][0], y0 = passes[p][1], dx = passes[p][2], dy = passes[p][3];
+        if (h.width <= (uint32_t)x0 || h.height <= (uint32_t)y0) continue;
+        const size_t pass_width = (h.width - x0 + dx - 1) / dx;
+        const size_t pass_height = (h.height - y0 + dy - 1) / dy;
+        const size_t stride = (pass_width * bits_per_pixel + 7) / 8;
+        if (raw.size() - offset < (stride + 1) * pass_height) {
+            cerr << "Truncated PNG image data in " << filename << endl;
+            return false;
+        }
+
+        const uint8_t* prior = nullptr;
+        for (size_t y = 0; y < pass_height; ++y) {
+            uint8_t* row = &raw[offset + 1];
+            if (!unfilter(raw[offset], row, prior, stride, bpp)) {
+                cerr << "Bad PNG filter type in " << filename << endl;
+                return false;
+            }
+            uint8_t* out = &image.pixels[(y0 + y * dy) * h.width + x0];
+            row_to_gray(h, row, pass_width, out, dx);
+            prior = row;
+            offset += stride + 1;
+        }
+    }
+    return true;
+}
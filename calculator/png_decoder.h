@@ -0,0 +1,30 @@
+#ifndef PNG_DECODER_H
+#define PNG_DECODER_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+using namespace std;
+
+// Decompresses a zlib stream (RFC 1950/1951) and appends the result to `out`.
+// Returns false on a malformed stream or a bad Adler-32 checksum.
+bool zlib_inflate(const uint8_t* data, size_t size, vector<uint8_t>& out);
+
+// An 8-bit grayscale image, row-major.
+struct GrayImage {
+  int width;
+  int height;
+  vector<uint8_t> pixels;
+};
+
+// Decodes a PNG file to 8-bit grayscale the way PIL's convert("L") does:
+// RGB and palette colors become (R*19595 + G*38470 + B*7471 + 0x8000) >> 16,
+// alpha is dropped, gray depths below 8 bits are scaled up to 0..255,
+// 16-bit gray is clamped to 255 (PIL reads it as a 16-bit integer image) and
+// other 16-bit samples keep their high byte. All color types, bit depths and
+// Adam7 interlacing are supported. Reports to cerr and returns false if the
+// file is not a valid PNG.
+bool decode_png_gray(const string& filename, GrayImage& image);
+
+#endif
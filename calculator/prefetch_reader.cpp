@@ -0,0 +1,101 @@
+#include <chrono>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include "prefetch_reader.h"
+
+using namespace std;
+
+BatchLoader FileBatchLoader(const vector<string>& files,
+                            function<bool(const string&, float*, size_t)> read, size_t row_size) {
+    return [files, read, row_size](size_t first, size_t count, float* out, uint8_t* ok) {
+        // Queue readahead for the whole batch first; the advice outlives the
+        // descriptor.
+        for (size_t i = 0; i < count; ++i) {
+            int fd = open(files[first + i].c_str(), O_RDONLY);
+            if (fd < 0) continue;
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            close(fd);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            ok[i] = read(files[first + i], out + i * row_size, row_size) ? 1 : 0;
+        }
+    };
+}
+
+PrefetchReader::PrefetchReader(size_t iRows, size_t iRowSize, size_t iBatchSize, BatchLoader iLoad,
+                               size_t iDepth, unsigned threads)
+    : rows(iRows), row_size(iRowSize), batch_size(max<size_t>(iBatchSize, 1)),
+      num_batches((iRows + batch_size - 1) / batch_size), load(iLoad),
+      slots(max<size_t>(iDepth, 2)), next_claim(0), next_read(0), holding(false), stop(false),
+      stalls(0), stall_seconds(0.0) {
+    for (Slot& slot : slots) {
+        slot.inputs.resize(batch_size * row_size);
+        slot.ok.resize(batch_size);
+        slot.batch = 0;
+        slot.ready = false;
+    }
+    // More loaders than buffers would only queue on free slots.
+    threads = (unsigned)min<size_t>(max(threads, 1u), slots.size());
+    for (unsigned t = 0; t < threads && t < num_batches; ++t) {
+        loaders.emplace_back(&PrefetchReader::LoaderLoop, this);
+    }
+}
+
+PrefetchReader::~PrefetchReader() {
+    {
+        lock_guard<mutex> guard(lock);
+        stop = true;
+    }
+    freed.notify_all();
+    for (thread& t : loaders) t.join();
+}
+
+void PrefetchReader::LoaderLoop() {
+    unique_lock<mutex> guard(lock);
+    while (!stop && next_claim < num_batches) {
+        size_t b = next_claim++;
+        // Batch b reuses the slot of batch b - depth; wait until the
+        // consumer is done with that one.
+        freed.wait(guard, [&] { return stop || b < next_read - (holding ? 1 : 0) + slots.size(); });
+        if (stop) break;
+
+        Slot& slot = slots[b % slots.size()];
+        guard.unlock();
+        size_t first = b * batch_size;
+        load(first, min(batch_size, rows - first), slot.inputs.data(), slot.ok.data());
+        guard.lock();
+
+        slot.batch = b;
+        slot.ready = true;
+        filled.notify_all();
+    }
+}
+
+bool PrefetchReader::Next(PrefetchBatch& batch) {
+    unique_lock<mutex> guard(lock);
+    if (holding) {
+        slots[(next_read - 1) % slots.size()].ready = false;
+        holding = false;
+        freed.notify_all();
+    }
+    if (next_read >= num_batches) {
+        return false;
+    }
+
+    Slot& slot = slots[next_read % slots.size()];
+    if (!(slot.ready && slot.batch == next_read)) {
+        auto start = chrono::steady_clock::now();
+        filled.wait(guard, [&] { return slot.ready && slot.batch == next_read; });
+        stalls++;
+        stall_seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    batch.first = next_read * batch_size;
+    batch.count = min(batch_size, rows - batch.first);
+    batch.inputs = slot.inputs.data();
+    batch.ok = slot.ok.data();
+    next_read++;
+    holding = true;
+    return true;
+}
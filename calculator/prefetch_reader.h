@@ -0,0 +1,82 @@
+#ifndef PREFETCH_READER_H
+#define PREFETCH_READER_H
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <stdint.h>
+using namespace std;
+
+// Fills rows [first, first + count) of the input stream into `out`
+// (count * row_size floats) and sets ok[i] to 0 for any row that failed.
+typedef function<void(size_t first, size_t count, float* out, uint8_t* ok)> BatchLoader;
+
+// Reads `files` with `read` (e.g. read_image). Before reading a batch it
+// hints every file in it to the kernel with posix_fadvise(WILLNEED), so the
+// disk fetches them in parallel instead of one open+read at a time.
+BatchLoader FileBatchLoader(const vector<string>& files,
+                            function<bool(const string&, float*, size_t)> read, size_t row_size);
+
+// One batch handed to the consumer; valid until the next Next() call.
+struct PrefetchBatch {
+  size_t first;
+  size_t count;
+  const float* inputs;  // count * row_size floats
+  const uint8_t* ok;    // count flags
+};
+
+// Loads an input stream of `rows` rows on background threads, a batch at a
+// time, into a ring of `depth` preallocated batch buffers, and hands the
+// batches out in order. Loaders run up to `depth` - 1 batches ahead of the
+// consumer, so Next() only blocks when inference outruns the disk.
+class PrefetchReader {
+public:
+  PrefetchReader(size_t iRows, size_t iRowSize, size_t iBatchSize, BatchLoader iLoad,
+                 size_t iDepth = 4, unsigned threads = 2);
+  ~PrefetchReader();
+  PrefetchReader(const PrefetchReader&) = delete;
+  PrefetchReader& operator=(const PrefetchReader&) = delete;
+
+  // Returns the next batch, waiting for it if it isn't loaded yet, and
+  // recycles the previous one's buffer. Returns false at the end.
+  bool Next(PrefetchBatch& batch);
+
+  // How often and for how long Next() had to wait for a batch.
+  size_t Stalls() const { return stalls; }
+  double StallSeconds() const { return stall_seconds; }
+
+private:
+  struct Slot {
+    vector<float> inputs;
+    vector<uint8_t> ok;
+    size_t batch;
+    bool ready;
+  };
+
+  void LoaderLoop();
+
+  const size_t rows;
+  const size_t row_size;
+  const size_t batch_size;
+  const size_t num_batches;
+  BatchLoader load;
+
+  vector<Slot> slots;
+  mutex lock;
+  condition_variable filled;  // a slot became ready
+  condition_variable freed;   // the consumer released a slot
+  size_t next_claim;  // next batch a loader will take
+  size_t next_read;   // next batch Next() returns
+  bool holding;       // the consumer holds batch next_read - 1
+  bool stop;
+
+  size_t stalls;
+  double stall_seconds;
+  vector<thread> loaders;
+};
+
+#endif
@@ -0,0 +1,232 @@
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include "quantized_perceptron.h"
+#include "atomic_file.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUANTIZED_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static const char kMagic[4] = { 'P', 'Q', '8', 1 };
+
+typedef int32_t (*Int8DotKernel)(const uint8_t* x, const int8_t* w, size_t n);
+
+// Plain integer math; this is what runs on the calculator.
+static int32_t dot_u8s8_scalar(const uint8_t* x, const int8_t* w, size_t n) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += (int32_t)x[i] * w[i];
+    }
+    return sum;
+}
+
+#ifdef QUANTIZED_X86
+
+// SSE2 has no byte multiply: widen 16 inputs and weights to int16 and let
+// pmaddwd multiply and add pairs into int32 lanes.
+__attribute__((target("sse2")))
+static int32_t dot_u8s8_sse2(const uint8_t* x, const int8_t* w, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i xv = _mm_loadu_si128((const __m128i*)(x + i));
+        __m128i wv = _mm_loadu_si128((const __m128i*)(w + i));
+        // Sign-extend by placing each byte in the high half and shifting back.
+        __m128i wlo = _mm_srai_epi16(_mm_unpacklo_epi8(wv, wv), 8);
+        __m128i whi = _mm_srai_epi16(_mm_unpackhi_epi8(wv, wv), 8);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(xv, zero), wlo));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpackhi_epi8(xv, zero), whi));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(acc) + dot_u8s8_scalar(x + i, w + i, n - i);
+}
+
+// pmaddubsw: 32 uint8 * int8 products summed pairwise into int16, then
+// pmaddwd against ones widens those pairs into int32 lanes.
+__attribute__((target("avx2")))
+static int32_t dot_u8s8_avx2(const uint8_t* x, const int8_t* w, size_t n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i xv = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i wv = _mm256_loadu_si256((const __m256i*)(w + i));
+        __m256i pairs = _mm256_maddubs_epi16(xv, wv);
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, ones));
+    }
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum) + dot_u8s8_scalar(x + i, w + i, n - i);
+}
+
+// vpdpbusd does the uint8 * int8 multiply and the 4-way int32 accumulate
+// in one instruction.
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static int32_t dot_u8s8_vnni(const uint8_t* x, const int8_t* w, size_t n) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i xv = _mm512_loadu_si512((const void*)(x + i));
+        __m512i wv = _mm512_loadu_si512((const void*)(w + i));
+        acc = _mm512_dpbusd_epi32(acc, xv, wv);
+    }
+    if (i < n) {
+        __mmask64 mask = (((__mmask64)1) << (n - i)) - 1;
+        __m512i xv = _mm512_maskz_loadu_epi8(mask, x + i);
+        __m512i wv = _mm512_maskz_loadu_epi8(mask, w + i);
+        acc = _mm512_dpbusd_epi32(acc, xv, wv);
+    }
+    int32_t lanes[16];
+    _mm512_storeu_si512((void*)lanes, acc);
+    int32_t sum = 0;
+    for (int l = 0; l < 16; ++l) sum += lanes[l];
+    return sum;
+}
+
+#endif // QUANTIZED_X86
+
+struct Int8Kernel {
+    const char* name;
+    Int8DotKernel dot;
+};
+
+// Honors PERCEPTRON_KERNEL the same way dot_kernels() does: the named ISA is
+// used when the CPU has its kernel, anything else gets the fastest one. The
+// integer sums are exact, so a "-det" suffix changes nothing. "avx512" is the
+// VNNI kernel and needs avx512vnni and avx512bw, not just avx512f.
+static Int8DotKernel select_int8_kernel() {
+    vector<Int8Kernel> supported = { { "scalar", dot_u8s8_scalar } };
+#ifdef QUANTIZED_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) supported.push_back({ "sse2", dot_u8s8_sse2 });
+    if (__builtin_cpu_supports("avx2")) supported.push_back({ "avx2", dot_u8s8_avx2 });
+    if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512bw")) {
+        supported.push_back({ "avx512", dot_u8s8_vnni });
+    }
+#endif
+
+    const char* forced = getenv("PERCEPTRON_KERNEL");
+    if (forced) {
+        string isa(forced);
+        if (isa.size() > 4 && isa.compare(isa.size() - 4, 4, "-det") == 0) isa.resize(isa.size() - 4);
+        for (const Int8Kernel& kernel : supported) {
+            if (isa == kernel.name) return kernel.dot;
+        }
+    }
+    return supported.back().dot;
+}
+
+static Int8DotKernel int8_kernel() {
+    static Int8DotKernel selected = select_int8_kernel();
+    return selected;
+}
+
+QuantizedPerceptron::QuantizedPerceptron(const float* iWeights, size_t count, float iBias) {
+    float max_abs = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        max_abs = max(max_abs, fabsf(iWeights[i]));
+    }
+    scale = (max_abs > 0.0f) ? max_abs / 127.0f : 1.0f;
+
+    weights.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        long q = lrintf(iWeights[i] / scale);
+        weights[i] = (int8_t)max(-127L, min(127L, q));
+    }
+    bias = (int32_t)lrintf(iBias * kInputMax / scale);
+}
+
+QuantizedPerceptron::QuantizedPerceptron(vector<int8_t> iWeights, float iScale, int32_t iBias)
+    : weights(move(iWeights)), scale(iScale), bias(iBias) {
+}
+
+void QuantizedPerceptron::QuantizeInput(const float* x, size_t count, uint8_t* out) {
+    for (size_t i = 0; i < count; ++i) {
+        float v = x[i] < 0.0f ? 0.0f : (x[i] > 1.0f ? 1.0f : x[i]);
+        out[i] = (uint8_t)lrintf(v * kInputMax);
+    }
+}
+
+int32_t QuantizedPerceptron::Logit(const uint8_t* x) const {
+    return int8_kernel()(x, weights.data(), weights.size()) + bias;
+}
+
+int QuantizedPerceptron::Predict(const uint8_t* x, size_t count) const {
+    if (count != weights.size()) {
+        cerr << "Error: Input size (" << count
+             << ") doesn't match weights size (" << weights.size() << ")" << endl;
+        return -1;
+    }
+
+    int prediction = (Logit(x) > 0) ? 1 : 0;
+
+    return prediction;
+}
+
+bool QuantizedPerceptron::Save(const string& filename) const {
+    const string scratch = ScratchPath(filename);
+    ofstream file(scratch, ios::binary);
+    if (!file) {
+        cerr << "Failed to open file: " << scratch << endl;
+        return false;
+    }
+    uint32_t count = (uint32_t)weights.size();
+    file.write(kMagic, sizeof(kMagic));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    file.write(reinterpret_cast<const char*>(&scale), sizeof(scale));
+    file.write(reinterpret_cast<const char*>(&bias), sizeof(bias));
+    file.write(reinterpret_cast<const char*>(weights.data()), weights.size());
+    file.close();
+    if (!file) {
+        cerr << "Error writing file: " << filename << endl;
+        remove(scratch.c_str());
+        return false;
+    }
+    return CommitFile(scratch, filename);
+}
+
+bool QuantizedPerceptron::Load(const string& filename, vector<int8_t>& oWeights,
+                               float& oScale, int32_t& oBias) {
+    ifstream file(filename, ios::binary);
+    if (!file) {
+        cerr << "Failed to open file: " << filename << endl;
+        return false;
+    }
+    char magic[4];
+    uint32_t count = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    file.read(reinterpret_cast<char*>(&oScale), sizeof(oScale));
+    file.read(reinterpret_cast<char*>(&oBias), sizeof(oBias));
+    if (!file || memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        cerr << "Not a q8 model file: " << filename << endl;
+        return false;
+    }
+    // Bound the count by what the file holds before allocating for it.
+    streampos header_end = file.tellg();
+    file.seekg(0, ios::end);
+    streamoff remaining = file.tellg() - header_end;
+    file.seekg(header_end);
+    if (!file || remaining < 0 || (uint64_t)remaining < count) {
+        cerr << "Truncated q8 model file: " << filename << endl;
+        return false;
+    }
+    oWeights.resize(count);
+    file.read(reinterpret_cast<char*>(oWeights.data()), count);
+    if (!file) {
+        cerr << "Error reading file: " << filename << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef QUANTIZED_PERCEPTRON_H
+#define QUANTIZED_PERCEPTRON_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+using namespace std;
+
+// Perceptron with int8 weights. Quantization is symmetric and per-tensor:
+// weight = q * scale with q in [-127, 127]. Inputs in [0, 1] are quantized
+// to uint8 in [0, kInputMax] and the bias is stored in the int32 accumulator
+// domain, so a prediction is one int8 x uint8 -> int32 dot product plus a
+// sign test.
+//
+// kInputMax is 127 rather than 255 so that pmaddubsw, which adds two
+// uint8 * int8 products into a saturating int16, can never saturate.
+//
+// Host only. The Nspire build keeps Q16.16 weights (FixedPointPerceptron):
+// its inputs are binary, so scoring is already a multiply-free sum of
+// weights, and the correction key nudges weights by steps far finer than an
+// int8 grid could hold.
+class QuantizedPerceptron {
+public:
+  static const int kInputMax = 127;
+
+  // Quantizes a float model.
+  QuantizedPerceptron(const float* iWeights, size_t count, float iBias);
+  // Wraps already quantized weights, e.g. read back from a .q8 file.
+  QuantizedPerceptron(vector<int8_t> iWeights, float iScale, int32_t iBias);
+
+  static void QuantizeInput(const float* x, size_t count, uint8_t* out);
+
+  int Predict(const uint8_t* x, size_t count) const;
+  int32_t Logit(const uint8_t* x) const;
+  // Converts an accumulator value back to the float model's logit scale.
+  float Dequantize(int32_t logit) const { return logit * scale / kInputMax; }
+
+  size_t InputSize() const { return weights.size(); }
+  float Scale() const { return scale; }
+
+  // .q8 file: "PQ8" magic, version byte, uint32 count, float scale,
+  // int32 bias, then `count` int8 weights; all little-endian.
+  bool Save(const string& filename) const;
+  static bool Load(const string& filename, vector<int8_t>& oWeights,
+                   float& oScale, int32_t& oBias);
+
+private:
+  vector<int8_t> weights;
+  float scale;
+  int32_t bias;
+};
+
+#endif
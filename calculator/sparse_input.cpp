@@ -0,0 +1,108 @@
+#include <vector>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include "sparse_input.h"
+#include "perceptron.h"
+
+using namespace std;
+
+// Measured with `main bench-sparse` on the 784-input model: against the
+// AVX2/AVX-512 kernels gathering stops paying off at 5-9% set pixels
+// (about 17% against SSE2).
+// Atomic because MeasureSparseBreakEven publishes its result while other
+// threads may be deciding how to predict; relaxed is enough for a tuning knob.
+static atomic<float> sparse_break_even(0.06f);
+
+float SparseBreakEven() {
+    return sparse_break_even.load(memory_order_relaxed);
+}
+
+void SetSparseBreakEven(float density) {
+    sparse_break_even.store(density, memory_order_relaxed);
+}
+
+static size_t count_nonzero(const float* x, size_t count) {
+    size_t nnz = 0;
+    for (size_t i = 0; i < count; ++i) nnz += (x[i] != 0.0f);
+    return nnz;
+}
+
+// Appends row `x` to `indices`/`values`, keeping it dense above `break_even`.
+static void append_row(const float* x, size_t count, float break_even,
+                       vector<uint32_t>& indices, vector<float>& values) {
+    bool dense = count_nonzero(x, count) > break_even * count;
+    for (size_t i = 0; i < count; ++i) {
+        if (dense || x[i] != 0.0f) {
+            indices.push_back((uint32_t)i);
+            values.push_back(x[i]);
+        }
+    }
+}
+
+SparseVector SparseVector::FromDense(const float* x, size_t count) {
+    SparseVector v;
+    v.size = count;
+    append_row(x, count, SparseBreakEven(), v.indices, v.values);
+    return v;
+}
+
+SparseBatch SparseBatch::FromDense(const float* x, size_t rows, size_t cols, size_t stride) {
+    SparseBatch b;
+    b.cols = cols;
+    b.row_offsets.reserve(rows + 1);
+    b.row_offsets.push_back(0);
+    const float break_even = SparseBreakEven();
+    for (size_t r = 0; r < rows; ++r) {
+        append_row(x + r * stride, cols, break_even, b.indices, b.values);
+        b.row_offsets.push_back(b.indices.size());
+    }
+    return b;
+}
+
+float MeasureSparseBreakEven(const Perceptron& perceptron, bool report) {
+    typedef chrono::steady_clock Clock;
+    const size_t n = perceptron.InputSize();
+    const int kReps = 2000;
+    const int kTrials = 5;
+    mt19937 rng(1234);
+
+    float break_even = 1.0f;
+    for (int percent = 2; percent <= 50; percent += 2) {
+        vector<float> dense(n, 0.0f);
+        for (size_t i = 0; i < n; ++i) {
+            if ((int)(rng() % 100) < percent) dense[i] = 1.0f;
+        }
+        // Built locally at a break-even of 1 so the row is always gathered,
+        // whatever the current setting.
+        SparseVector sparse;
+        sparse.size = n;
+        append_row(dense.data(), n, 1.0f, sparse.indices, sparse.values);
+
+        // Best of several trials to keep scheduler noise out of the result.
+        double gather_ns = 1e30, dense_ns = 1e30;
+        volatile int sink = 0;
+        for (int trial = 0; trial < kTrials; ++trial) {
+            Clock::time_point start = Clock::now();
+            for (int rep = 0; rep < kReps; ++rep) sink += perceptron.PredictSparse(sparse);
+            gather_ns = min(gather_ns, chrono::duration<double, nano>(Clock::now() - start).count() / kReps);
+
+            start = Clock::now();
+            for (int rep = 0; rep < kReps; ++rep) sink += perceptron.Predict(dense.data(), n);
+            dense_ns = min(dense_ns, chrono::duration<double, nano>(Clock::now() - start).count() / kReps);
+        }
+        (void)sink;
+
+        if (report) {
+            cout << "density " << sparse.Density() << ": gather " << gather_ns
+                 << " ns, dense " << dense_ns << " ns" << endl;
+        }
+        if (dense_ns < gather_ns && break_even == 1.0f) {
+            break_even = sparse.Density();
+        }
+    }
+
+    SetSparseBreakEven(break_even);
+    return break_even;
+}
@@ -0,0 +1,49 @@
+#ifndef SPARSE_INPUT_H
+#define SPARSE_INPUT_H
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+using namespace std;
+
+class Perceptron;
+
+// Indices are sorted and unique. A row whose entry count equals its dense
+// length therefore holds every index in order, and its values are the dense
+// row itself: FromDense stores rows above SparseBreakEven() density that way
+// so they are scored with the SIMD dense kernel instead of a gather.
+
+// One input held as the indices and values of its nonzero entries.
+struct SparseVector {
+  size_t size;  // dense length
+  vector<uint32_t> indices;
+  vector<float> values;
+
+  static SparseVector FromDense(const float* x, size_t count);
+  float Density() const { return size ? (float)indices.size() / size : 0.0f; }
+};
+
+// A batch of inputs in CSR form: row r owns entries
+// [row_offsets[r], row_offsets[r + 1]) of `indices` and `values`.
+struct SparseBatch {
+  size_t cols;
+  vector<size_t> row_offsets;
+  vector<uint32_t> indices;
+  vector<float> values;
+
+  static SparseBatch FromDense(const float* x, size_t rows, size_t cols, size_t stride);
+  size_t Rows() const { return row_offsets.empty() ? 0 : row_offsets.size() - 1; }
+};
+
+// Density (nonzeros / size) above which FromDense keeps a row dense, because
+// the SIMD dot product over the whole row beats gathering one weight per
+// nonzero. Safe to read and set from any thread.
+float SparseBreakEven();
+void SetSparseBreakEven(float density);
+
+// Times the gather kernel against the dense kernel on random inputs of
+// increasing density, sets the break-even to the first density where dense
+// wins and returns it. Prints the timings when `report` is set.
+float MeasureSparseBreakEven(const Perceptron& perceptron, bool report);
+
+#endif
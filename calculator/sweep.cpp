@@ -0,0 +1,172 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include "sweep.h"
+#include "work_stealing_pool.h"
+
+using namespace std;
+
+namespace {
+
+// One training run: a (learning rate, epochs, l2) point on one fold, scored
+// at every threshold.
+struct SweepRun {
+    size_t config;  // index into the (lr, epochs, l2) combinations
+    size_t fold;
+    float learning_rate;
+    size_t epochs;
+    float l2;
+    double seconds = 0.0;
+    vector<EvalResult> scores;  // one per threshold
+};
+
+}  // namespace
+
+vector<SweepResult> RunSweep(const IdxDataset& data, const SweepGrid& grid, unsigned threads) {
+    const size_t k = max<size_t>(grid.folds, 2);
+    const vector<vector<size_t>> folds = StratifiedFolds(data, k, grid.base.seed);
+
+    // Training rows of fold f: every other fold's rows.
+    vector<vector<size_t>> train_rows(k);
+    for (size_t f = 0; f < k; ++f) {
+        for (size_t g = 0; g < k; ++g) {
+            if (g != f) train_rows[f].insert(train_rows[f].end(), folds[g].begin(), folds[g].end());
+        }
+        sort(train_rows[f].begin(), train_rows[f].end());
+    }
+
+    vector<SweepRun> runs;
+    size_t configs = 0;
+    for (float lr : grid.learning_rates) {
+        for (size_t epochs : grid.epochs) {
+            for (float l2 : grid.l2) {
+                for (size_t f = 0; f < k; ++f) {
+                    SweepRun run;
+                    run.config = configs;
+                    run.fold = f;
+                    run.learning_rate = lr;
+                    run.epochs = epochs;
+                    run.l2 = l2;
+                    runs.push_back(run);
+                }
+                configs++;
+            }
+        }
+    }
+
+    // Longest first, so the pool ends on short runs that fill in around them.
+    vector<size_t> schedule(runs.size());
+    for (size_t i = 0; i < runs.size(); ++i) schedule[i] = i;
+    stable_sort(schedule.begin(), schedule.end(),
+                [&runs](size_t a, size_t b) { return runs[a].epochs > runs[b].epochs; });
+
+    vector<function<void()>> tasks;
+    for (size_t i : schedule) {
+        SweepRun* run = &runs[i];
+        tasks.push_back([run, &data, &grid, &folds, &train_rows] {
+            TrainOptions options = grid.base;
+            options.learning_rate = run->learning_rate;
+            options.epochs = run->epochs;
+            options.l2 = run->l2;
+            options.threads = 1;
+            options.report_every = 0;
+            auto start = chrono::steady_clock::now();
+            LogisticModel model = TrainLogistic(data, train_rows[run->fold], options);
+            run->seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            for (float threshold : grid.thresholds) {
+                run->scores.push_back(EvaluateLogistic(model, data, folds[run->fold], threshold));
+            }
+        });
+    }
+
+    {
+        // Queued in one go, so the first runs to start are the longest.
+        WorkStealingPool pool(threads);
+        pool.SubmitAll(move(tasks));
+        pool.Wait();
+        cerr << "Sweep: " << runs.size() << " runs on " << pool.Threads() << " threads, "
+             << pool.Steals() << " steals" << endl;
+    }
+
+    vector<SweepResult> results;
+    for (size_t c = 0; c < configs; ++c) {
+        const SweepRun* first = nullptr;
+        double seconds = 0.0;
+        for (const SweepRun& run : runs) {
+            if (run.config != c) continue;
+            if (!first) first = &run;
+            seconds += run.seconds;
+        }
+        for (size_t t = 0; t < grid.thresholds.size(); ++t) {
+            SweepResult result;
+            result.learning_rate = first->learning_rate;
+            result.epochs = first->epochs;
+            result.l2 = first->l2;
+            result.threshold = grid.thresholds[t];
+            result.train_seconds = seconds;
+            double sum = 0.0, loss = 0.0;
+            for (const SweepRun& run : runs) {
+                if (run.config != c) continue;
+                result.fold_accuracy.push_back(run.scores[t].Accuracy());
+                sum += run.scores[t].Accuracy();
+                loss += run.scores[t].loss;
+            }
+            result.mean_accuracy = sum / k;
+            result.mean_loss = loss / k;
+            double var = 0.0;
+            for (double a : result.fold_accuracy) var += (a - result.mean_accuracy) * (a - result.mean_accuracy);
+            result.stddev_accuracy = sqrt(var / k);
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+
+bool WriteSweepJson(const string& filename, const vector<SweepResult>& results) {
+    ofstream out(filename);
+    if (!out) {
+        cerr << "Failed to open file: " << filename << endl;
+        return false;
+    }
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const SweepResult& r = results[i];
+        out << "  {\"learning_rate\": " << r.learning_rate << ", \"epochs\": " << r.epochs
+            << ", \"l2\": " << r.l2 << ", \"threshold\": " << r.threshold
+            << ", \"mean_accuracy\": " << r.mean_accuracy << ", \"stddev_accuracy\": " << r.stddev_accuracy
+            << ", \"mean_loss\": " << r.mean_loss << ", \"train_seconds\": " << r.train_seconds
+            << ", \"fold_accuracy\": [";
+        for (size_t f = 0; f < r.fold_accuracy.size(); ++f) {
+            out << (f ? ", " : "") << r.fold_accuracy[f];
+        }
+        out << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+    if (!out) {
+        cerr << "Error writing file: " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+bool WriteSweepCsv(const string& filename, const vector<SweepResult>& results) {
+    ofstream out(filename);
+    if (!out) {
+        cerr << "Failed to open file: " << filename << endl;
+        return false;
+    }
+    out << "learning_rate,epochs,l2,threshold,mean_accuracy,stddev_accuracy,mean_loss,train_seconds\n";
+    for (const SweepResult& r : results) {
+        out << r.learning_rate << "," << r.epochs << "," << r.l2 << "," << r.threshold << ","
+            << r.mean_accuracy << "," << r.stddev_accuracy << "," << r.mean_loss << ","
+            << r.train_seconds << "\n";
+    }
+    if (!out) {
+        cerr << "Error writing file: " << filename << endl;
+        return false;
+    }
+    return true;
+}
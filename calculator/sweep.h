@@ -0,0 +1,48 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+#include "trainer.h"
+using namespace std;
+
+// Hyperparameter grid; every combination is cross-validated. Thresholds
+// only change how a trained model is scored, so each trained model is
+// evaluated at all of them instead of being retrained.
+struct SweepGrid {
+  vector<float> learning_rates = {0.01f};
+  vector<size_t> epochs = {1000};
+  vector<float> l2 = {0.0f};
+  vector<float> thresholds = {0.5f};
+  size_t folds = 5;
+  // Options shared by every run; its learning rate, epochs and l2 are
+  // overridden from the grid.
+  TrainOptions base;
+};
+
+struct SweepResult {
+  float learning_rate;
+  size_t epochs;
+  float l2;
+  float threshold;
+  vector<double> fold_accuracy;  // validation accuracy per fold
+  double mean_accuracy;
+  double stddev_accuracy;
+  double mean_loss;              // validation cross-entropy, averaged over folds
+  double train_seconds;          // summed over folds
+};
+
+// Trains every fold x (learning rate, epochs, l2) combination as its own task
+// on a work-stealing pool of `threads` workers (0 = one per core), each run
+// single-threaded, longest runs queued first. All runs read the same mapped
+// dataset through row lists; nothing is copied per fold. Results come back
+// in grid order.
+vector<SweepResult> RunSweep(const IdxDataset& data, const SweepGrid& grid, unsigned threads);
+
+// Machine-readable summaries, one record per grid point.
+bool WriteSweepJson(const string& filename, const vector<SweepResult>& results);
+bool WriteSweepCsv(const string& filename, const vector<SweepResult>& results);
+
+#endif
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <fstream>
+#include <charconv>
+#include <cstdio>
+#include <thread>
+#include <algorithm>
+#include "text_loader.h"
+#include "atomic_file.h"
+
+using namespace std;
+
+// Below this size a single thread finishes before extra ones would start.
+static const size_t kParallelThreshold = 256 * 1024;
+
+struct ChunkResult {
+    vector<float> values;
+    size_t lines = 0;         // newlines seen in the chunk
+    bool ok = true;
+    size_t error_line = 0;    // relative to the chunk start
+    string error_token;
+};
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+static void parse_chunk(const char* begin, const char* end, ChunkResult& result) {
+    const char* p = begin;
+    while (p < end) {
+        if (is_space(*p)) {
+            if (*p == '\n') result.lines++;
+            ++p;
+            continue;
+        }
+        float value;
+        from_chars_result r = from_chars(p, end, value);
+        if (r.ec != errc() || (r.ptr < end && !is_space(*r.ptr))) {
+            const char* token_end = p;
+            while (token_end < end && !is_space(*token_end)) ++token_end;
+            result.ok = false;
+            result.error_line = result.lines;
+            result.error_token.assign(p, min<size_t>(token_end - p, 40));
+            return;
+        }
+        result.values.push_back(value);
+        p = r.ptr;
+    }
+}
+
+bool load_float_text(const string& filename, vector<float>& out, unsigned threads) {
+    out.clear();
+    ifstream file(filename, ios::binary | ios::ate);
+    if (!file) {
+        cerr << "Failed to open file: " << filename << endl;
+        return false;
+    }
+    string text((size_t)file.tellg(), '\0');
+    file.seekg(0);
+    file.read(&text[0], text.size());
+    if (!file) {
+        cerr << "Error reading file: " << filename << endl;
+        return false;
+    }
+
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    size_t chunks = (text.size() < kParallelThreshold) ? 1 : threads;
+
+    // Chunk boundaries sit just after a newline so no token is split.
+    vector<const char*> bounds(1, text.data());
+    const char* end = text.data() + text.size();
+    for (size_t c = 1; c < chunks; ++c) {
+        const char* cut = text.data() + text.size() * c / chunks;
+        cut = max(cut, bounds.back());
+        while (cut < end && *cut != '\n') ++cut;
+        if (cut < end) ++cut;
+        bounds.push_back(cut);
+    }
+    bounds.push_back(end);
+
+    vector<ChunkResult> results(chunks);
+    vector<thread> workers;
+    for (size_t c = 1; c < chunks; ++c) {
+        workers.emplace_back(parse_chunk, bounds[c], bounds[c + 1], ref(results[c]));
+    }
+    parse_chunk(bounds[0], bounds[1], results[0]);
+    for (thread& t : workers) t.join();
+
+    size_t line = 1, total = 0;
+    for (const ChunkResult& r : results) {
+        if (!r.ok) {
+            cerr << filename << ":" << line + r.error_line
+                 << ": expected a number, found \"" << r.error_token << "\"" << endl;
+            return false;
+        }
+        line += r.lines;
+        total += r.values.size();
+    }
+
+    out.reserve(total);
+    for (const ChunkResult& r : results) {
+        out.insert(out.end(), r.values.begin(), r.values.end());
+    }
+    return true;
+}
+
+bool save_float_text(const string& filename, const float* values, size_t count) {
+    // Replaced by rename, so a watcher never parses a half-written file.
+    const string scratch = ScratchPath(filename);
+    ofstream file(scratch, ios::binary);
+    if (!file) {
+        cerr << "Failed to open file: " << scratch << endl;
+        return false;
+    }
+    char line[64];
+    for (size_t i = 0; i < count; ++i) {
+        int len = snprintf(line, sizeof(line), "%.18e\n", (double)values[i]);
+        file.write(line, len);
+    }
+    file.close();
+    if (!file) {
+        cerr << "Error writing file: " << filename << endl;
+        remove(scratch.c_str());
+        return false;
+    }
+    return CommitFile(scratch, filename);
+}
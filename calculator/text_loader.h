@@ -0,0 +1,23 @@
+#ifndef TEXT_LOADER_H
+#define TEXT_LOADER_H
+
+#include <vector>
+#include <string>
+using namespace std;
+
+// Reads every whitespace-separated float in `filename` (the np.savetxt text
+// format) into `out`, in file order. The file is read in one go and parsed
+// with std::from_chars, so parsing is locale-independent and allocation-free.
+// Files larger than a few hundred KB are split at newline boundaries and the
+// pieces are parsed on `threads` threads (0 = one per core); the output order
+// does not depend on the thread count.
+//
+// On a token that is not a float, reports "file:line: ..." to cerr, leaves
+// `out` empty and returns false.
+bool load_float_text(const string& filename, vector<float>& out, unsigned threads = 0);
+
+// Writes one value per line in np.savetxt's default "%.18e" format, so the
+// file reads back bit-exactly with load_float_text or np.loadtxt.
+bool save_float_text(const string& filename, const float* values, size_t count);
+
+#endif
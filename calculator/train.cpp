@@ -0,0 +1,266 @@
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include "trainer.h"
+#include "sweep.h"
+#include "work_stealing_pool.h"
+#include "idx_dataset.h"
+#include "model_file.h"
+#include "text_loader.h"
+
+using namespace std;
+
+// Trains the a/b perceptron natively, replacing the training notebook's
+// Keras loop. The dataset is an IDX pair written by `main pack-idx`.
+//
+//   train [bench | sweep] images.idx labels.idx [key=value ...]
+//   train check-pool [threads]
+//
+// epochs=1000 batch=32 lr=0.01 l2=0 threads=0 seed=42 test=0.2 report=100
+// mode=sync|hogwild
+// augment=0 shift=2 scale=0.15 dilate=0.3 binarize=0.3 augment_threads=2
+// weights=weights_layer1.txt biases=biases_layer1.txt  (np.savetxt format)
+// model=out.pcpt labels=ab                              (optional .pcpt)
+//
+// sweep takes comma-separated lists for lr, epochs, l2 and threshold, plus
+// folds=5 json=FILE csv=FILE (the summary goes to stdout as CSV if neither).
+
+static void usage() {
+    cerr << "Usage: train [bench | sweep] images.idx labels.idx [epochs=N] [batch=N] [lr=X] [l2=X]\n"
+            "             [threads=N] [seed=N]\n"
+            "             [test=F] [report=N] [mode=sync|hogwild] [augment=0|1] [shift=N] [scale=F]\n"
+            "             [dilate=P] [binarize=P] [augment_threads=N] [weights=FILE] [biases=FILE]\n"
+            "             [model=FILE] [labels=AB]\n"
+            "       sweep: [lr=X,...] [epochs=N,...] [l2=X,...] [threshold=X,...] [folds=N]\n"
+            "              [json=FILE] [csv=FILE]\n"
+            "       train check-pool [threads]" << endl;
+}
+
+template <typename T>
+static bool parse_list(const string& value, vector<T>& out) {
+    out.clear();
+    size_t start = 0;
+    while (start <= value.size()) {
+        size_t end = value.find(',', start);
+        if (end == string::npos) end = value.size();
+        string item = value.substr(start, end - start);
+        char* parsed_end = nullptr;
+        double v = strtod(item.c_str(), &parsed_end);
+        if (item.empty() || *parsed_end != '\0') return false;
+        out.push_back((T)v);
+        start = end + 1;
+    }
+    return !out.empty();
+}
+
+// Trains with both modes at 1, 2, 4, ... threads (up to `threads`, or one
+// per core) for the same number of epochs and prints the wall-clock time
+// and the loss and accuracy reached, so the speedup of each mode can be
+// weighed against what it does to convergence.
+static int bench_threads(const IdxDataset& data, const vector<size_t>& train_rows,
+                         const vector<size_t>& test_rows, TrainOptions options) {
+    unsigned max_threads = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+    options.report_every = 0;
+    cout << "mode     threads  seconds  train loss  train acc  test acc" << endl;
+    for (int hogwild = 0; hogwild < 2; ++hogwild) {
+        for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+            options.hogwild = hogwild != 0;
+            options.threads = threads;
+            auto start = chrono::steady_clock::now();
+            LogisticModel model = TrainLogistic(data, train_rows, options);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            EvalResult train = EvaluateLogistic(model, data, train_rows);
+            printf("%-8s %7u %8.3f %11.4f %9.2f%%", hogwild ? "hogwild" : "sync", threads,
+                   seconds, train.loss, 100.0 * train.Accuracy());
+            // No test split (test=0 or a tiny set): nothing to report.
+            if (test_rows.empty()) {
+                printf(" %9s\n", "-");
+            } else {
+                EvalResult test = EvaluateLogistic(model, data, test_rows);
+                printf(" %8.2f%%\n", 100.0 * test.Accuracy());
+            }
+        }
+    }
+    return 0;
+}
+
+// Checks the scheduling sweep relies on: runs queued longest first on a
+// work-stealing pool of `threads` workers must start longest first. Queues
+// tasks costing 4 * threads .. 1 ms in that order and fails if any of the
+// first `threads` tasks to start isn't one of the `threads` longest.
+static int check_pool(unsigned threads) {
+    WorkStealingPool pool(threads);
+    threads = pool.Threads();
+    const size_t n = 4 * threads;
+    vector<size_t> started(n);
+    atomic<size_t> next_start(0);
+    vector<function<void()>> tasks;
+    for (size_t i = 0; i < n; ++i) {
+        const size_t cost = n - i;
+        tasks.push_back([cost, &started, &next_start] {
+            started[next_start++] = cost;
+            this_thread::sleep_for(chrono::milliseconds(cost));
+        });
+    }
+    pool.SubmitAll(move(tasks));
+    pool.Wait();
+
+    bool ok = true;
+    cout << "Start order:";
+    for (size_t i = 0; i < n; ++i) {
+        cout << " " << started[i];
+        ok = ok && (i >= threads || started[i] > n - threads);
+    }
+    cout << endl << (ok ? "Longest tasks started first" : "FAILED: a shorter task started before the longest ones")
+         << " (" << threads << " workers, " << pool.Steals() << " steals)" << endl;
+    return ok ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "check-pool") == 0) {
+        return check_pool(argc > 2 ? (unsigned)atoi(argv[2]) : 2);
+    }
+
+    bool bench = argc > 1 && strcmp(argv[1], "bench") == 0;
+    bool sweep = argc > 1 && strcmp(argv[1], "sweep") == 0;
+    if (bench || sweep) {
+        argc--;
+        argv++;
+    }
+    if (argc < 3) {
+        usage();
+        return -1;
+    }
+
+    TrainOptions options;
+    options.report_every = 100;
+    double test_fraction = 0.2;
+    string weights_file = "weights_layer1.txt", biases_file = "biases_layer1.txt";
+    string model_file, labels = "ab";
+    SweepGrid grid;
+    string json_file, csv_file;
+    for (int i = 3; i < argc; ++i) {
+        string option = argv[i];
+        size_t eq = option.find('=');
+        string key = option.substr(0, eq), value = eq == string::npos ? "" : option.substr(eq + 1);
+        if (value.empty()) {
+            cerr << "Expected key=value: " << option << endl;
+            usage();
+            return -1;
+        }
+        if (sweep && (key == "lr" || key == "epochs" || key == "l2" || key == "threshold")) {
+            bool ok = (key == "lr") ? parse_list(value, grid.learning_rates)
+                    : (key == "epochs") ? parse_list(value, grid.epochs)
+                    : (key == "l2") ? parse_list(value, grid.l2)
+                    : parse_list(value, grid.thresholds);
+            if (!ok) {
+                cerr << "Expected a comma-separated list of numbers: " << option << endl;
+                return -1;
+            }
+        }
+        else if (sweep && key == "folds") grid.folds = strtoul(value.c_str(), nullptr, 10);
+        else if (sweep && key == "json") json_file = value;
+        else if (sweep && key == "csv") csv_file = value;
+        else if (key == "epochs") options.epochs = strtoul(value.c_str(), nullptr, 10);
+        else if (key == "batch") options.batch_size = strtoul(value.c_str(), nullptr, 10);
+        else if (key == "lr") options.learning_rate = strtof(value.c_str(), nullptr);
+        else if (key == "l2") options.l2 = strtof(value.c_str(), nullptr);
+        else if (key == "threads") options.threads = (unsigned)strtoul(value.c_str(), nullptr, 10);
+        else if (key == "seed") options.seed = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+        else if (key == "test") test_fraction = strtod(value.c_str(), nullptr);
+        else if (key == "report") options.report_every = strtoul(value.c_str(), nullptr, 10);
+        else if (key == "mode" && (value == "sync" || value == "hogwild")) options.hogwild = value == "hogwild";
+        else if (key == "augment") options.augment = value != "0";
+        else if (key == "shift") options.augmentation.max_shift = atoi(value.c_str());
+        else if (key == "scale") options.augmentation.max_scale = strtof(value.c_str(), nullptr);
+        else if (key == "dilate") options.augmentation.dilate_probability = strtof(value.c_str(), nullptr);
+        else if (key == "binarize") options.augmentation.binarize_probability = strtof(value.c_str(), nullptr);
+        else if (key == "augment_threads") options.augment_threads = (unsigned)strtoul(value.c_str(), nullptr, 10);
+        else if (key == "weights") weights_file = value;
+        else if (key == "biases") biases_file = value;
+        else if (key == "model") model_file = value;
+        else if (key == "labels" && value.size() == 2) labels = value;
+        else if (key == "labels") {
+            cerr << "Expected two labels, got \"" << value << "\"" << endl;
+            return -1;
+        }
+        else {
+            cerr << "Unknown option: " << option << endl;
+            usage();
+            return -1;
+        }
+    }
+
+    unique_ptr<IdxDataset> data = IdxDataset::Open(argv[1], argv[2]);
+    if (!data) return -1;
+    for (size_t i = 0; i < data->Size(); ++i) {
+        if (data->Labels()[i] > 1) {
+            cerr << "Sample " << i << " has label " << (int)data->Labels()[i]
+                 << "; a single perceptron needs labels 0 and 1" << endl;
+            return -1;
+        }
+    }
+
+    // Check the model contract before spending the training time on it.
+    ModelInfo info = DefaultModelInfo();
+    if (!model_file.empty()) {
+        if (data->Cols() > 0xFFFF || data->Rows() > 0xFFFF) {
+            cerr << "A " << data->Cols() << "x" << data->Rows()
+                 << " input doesn't fit in a model file" << endl;
+            return -1;
+        }
+        info.input_width = (uint16_t)data->Cols();
+        info.input_height = (uint16_t)data->Rows();
+        info.labels[0] = labels[0];
+        info.labels[1] = labels[1];
+        if (!ValidateModelInfo(info, data->Pixels(), 1)) return -1;
+    }
+
+    if (sweep) {
+        grid.base = options;
+        vector<SweepResult> results = RunSweep(*data, grid, options.threads);
+        if (json_file.empty() && csv_file.empty()) csv_file = "/dev/stdout";
+        if ((!json_file.empty() && !WriteSweepJson(json_file, results)) ||
+            (!csv_file.empty() && !WriteSweepCsv(csv_file, results))) {
+            return -1;
+        }
+        return 0;
+    }
+
+    vector<size_t> train_rows, test_rows;
+    StratifiedSplit(*data, test_fraction, options.seed, train_rows, test_rows);
+    cout << "Training on " << train_rows.size() << " samples, testing on " << test_rows.size() << endl;
+    if (bench) {
+        return bench_threads(*data, train_rows, test_rows, options);
+    }
+
+    auto start = chrono::steady_clock::now();
+    LogisticModel model = TrainLogistic(*data, train_rows, options);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Trained " << options.epochs << " epochs in " << seconds << " s" << endl;
+
+    EvalResult train = EvaluateLogistic(model, *data, train_rows);
+    cout << "Train accuracy: " << 100.0 * train.Accuracy() << "%, loss " << train.loss << endl;
+    if (!test_rows.empty()) {
+        EvalResult test = EvaluateLogistic(model, *data, test_rows);
+        cout << "Test accuracy: " << 100.0 * test.Accuracy() << "%, loss " << test.loss << endl;
+    }
+
+    if (!save_float_text(weights_file, model.weights.data(), model.weights.size()) ||
+        !save_float_text(biases_file, &model.bias, 1)) {
+        return -1;
+    }
+    cout << "Wrote " << weights_file << " and " << biases_file << endl;
+
+    if (!model_file.empty()) {
+        if (!ModelFile::Write(model_file, model.weights.data(), model.weights.size(), 1, &model.bias, info)) {
+            return -1;
+        }
+        cout << "Wrote " << model_file << endl;
+    }
+    return 0;
+}
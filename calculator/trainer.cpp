@@ -0,0 +1,424 @@
+#include <iostream>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <pthread.h>
+#include <sched.h>
+#include "trainer.h"
+#include "perceptron.h"
+#include "dot_kernels.h"
+#include "prefetch_reader.h"
+
+using namespace std;
+
+namespace {
+
+// Reusable barrier for a fixed set of threads. Batches take microseconds, so
+// waiters spin (yielding) rather than sleep on a condition variable.
+class SpinBarrier {
+public:
+    explicit SpinBarrier(unsigned n) : count(n), waiting(0), generation(0) {}
+
+    void Wait() {
+        if (count == 1) return;
+        unsigned gen = generation.load(memory_order_acquire);
+        if (waiting.fetch_add(1, memory_order_acq_rel) + 1 == count) {
+            waiting.store(0, memory_order_relaxed);
+            generation.fetch_add(1, memory_order_release);
+            return;
+        }
+        while (generation.load(memory_order_acquire) == gen) this_thread::yield();
+    }
+
+private:
+    const unsigned count;
+    atomic<unsigned> waiting;
+    atomic<unsigned> generation;
+};
+
+// Per-chunk partial sums: the gradient of every weight, then the bias, loss
+// and correct-count slots.
+const size_t kBiasSlot = 0, kLossSlot = 1, kCorrectSlot = 2, kExtraSlots = 3;
+
+struct SyncTrainer {
+    const IdxDataset& data;
+    const TrainOptions& options;
+    const size_t n;
+    const size_t stride;  // floats per chunk buffer, a multiple of 16
+    vector<size_t> order;
+    vector<float> params;  // n weights, then the bias
+    vector<float> chunk_sums;
+    SpinBarrier barrier;
+    unsigned threads;
+    mt19937 shuffle_rng;
+    double epoch_loss = 0.0;
+    size_t epoch_correct = 0;
+    // With augmentation: this epoch's distorted samples, in `order`, and the
+    // batch being trained on.
+    unique_ptr<PrefetchReader> augmented;
+    PrefetchBatch batch;
+
+    SyncTrainer(const IdxDataset& iData, const vector<size_t>& rows, const TrainOptions& iOptions,
+                unsigned iThreads)
+        : data(iData), options(iOptions), n(iData.Pixels()),
+          stride((iData.Pixels() + kExtraSlots + 15) / 16 * 16), order(rows), params(n + 1, 0.0f),
+          chunk_sums(stride * ((iOptions.batch_size + kTrainChunkRows - 1) / kTrainChunkRows)),
+          barrier(iThreads), threads(iThreads), shuffle_rng(iOptions.seed + 1) {}
+
+    // Shuffles the samples for `epoch` and, when augmenting, starts
+    // distorting them in the background and waits for the first batch.
+    void StartEpoch(size_t epoch) {
+        augmented.reset();
+        shuffle(order.begin(), order.end(), shuffle_rng);
+        if (!options.augment) return;
+
+        auto load = [this, epoch](size_t first, size_t count, float* out, uint8_t* ok) {
+            vector<float> raw(n);
+            for (size_t i = 0; i < count; ++i) {
+                data.Decode(order[first + i], 1, raw.data());
+                AugmentImage(raw.data(), data.Cols(), data.Rows(), options.augmentation,
+                             AugmentSeed(options.seed, epoch, first + i), out + i * n);
+                ok[i] = 1;
+            }
+        };
+        augmented.reset(new PrefetchReader(order.size(), n, options.batch_size, load,
+                                           options.queue_depth, options.augment_threads));
+        augmented->Next(batch);
+    }
+
+    // Forward pass and gradient of rows [start, start + count) of `order`
+    // into chunk buffer `c`, in row order.
+    void ComputeChunk(size_t c, size_t start, size_t count, float* scratch) {
+        const float* x[kTrainChunkRows];
+        if (augmented) {
+            for (size_t r = 0; r < kTrainChunkRows; ++r) {
+                x[r] = batch.inputs + (start - batch.first + min(r, count - 1)) * n;
+            }
+        } else {
+            for (size_t r = 0; r < kTrainChunkRows; ++r) {
+                x[r] = scratch + min(r, count - 1) * n;
+            }
+            for (size_t r = 0; r < count; ++r) data.Decode(order[start + r], 1, scratch + r * n);
+        }
+
+        float z[kTrainChunkRows];
+        const DotKernels& kernels = dot_kernels();
+        for (size_t r = 0; r < kTrainChunkRows; r += 4) kernels.dot4(x + r, params.data(), n, z + r);
+
+        float* g = &chunk_sums[c * stride];
+        fill(g, g + n + kExtraSlots, 0.0f);
+        float* extra = g + n;
+        for (size_t r = 0; r < count; ++r) {
+            const float logit = z[r] + params[n];
+            const float y = (float)data.Labels()[order[start + r]];
+            const float err = 1.0f / (1.0f + expf(-logit)) - y;
+            // Cross-entropy from the logit, stable for large |logit|.
+            extra[kLossSlot] += max(logit, 0.0f) - logit * y + log1pf(expf(-fabsf(logit)));
+            extra[kCorrectSlot] += ((logit > 0) == (y > 0.5f)) ? 1.0f : 0.0f;
+            extra[kBiasSlot] += err;
+            const float* xr = x[r];
+            for (size_t j = 0; j < n; ++j) g[j] += err * xr[j];
+        }
+    }
+
+    void Run(unsigned t) {
+        vector<float> scratch(kTrainChunkRows * n);
+        const size_t batch_size = options.batch_size;
+        const size_t batches = (order.size() + batch_size - 1) / batch_size;
+        // This thread's slice of the parameters for the update step.
+        const size_t per_thread = ((n + 1 + threads - 1) / threads + 15) / 16 * 16;
+        const size_t lo = min(n + 1, t * per_thread), hi = min(n + 1, lo + per_thread);
+
+        for (size_t epoch = 0; epoch < options.epochs; ++epoch) {
+            if (t == 0) {
+                StartEpoch(epoch);
+                epoch_loss = 0.0;
+                epoch_correct = 0;
+            }
+            barrier.Wait();
+
+            for (size_t b = 0; b < batches; ++b) {
+                const size_t first = b * batch_size;
+                const size_t count = min(batch_size, order.size() - first);
+                const size_t chunks = (count + kTrainChunkRows - 1) / kTrainChunkRows;
+                for (size_t c = t; c < chunks; c += threads) {
+                    ComputeChunk(c, first + c * kTrainChunkRows,
+                                 min(kTrainChunkRows, count - c * kTrainChunkRows), scratch.data());
+                }
+                barrier.Wait();
+
+                // Mean gradient over the batch, summed chunk by chunk.
+                const float step = options.learning_rate / count;
+                const float decay = options.learning_rate * options.l2;
+                for (size_t j = lo; j < hi; ++j) {
+                    float sum = 0.0f;
+                    for (size_t c = 0; c < chunks; ++c) sum += chunk_sums[c * stride + j];
+                    params[j] -= step * sum + (j < n ? decay * params[j] : 0.0f);
+                }
+                if (t == 0) {
+                    for (size_t c = 0; c < chunks; ++c) {
+                        epoch_loss += chunk_sums[c * stride + n + kLossSlot];
+                        epoch_correct += (size_t)chunk_sums[c * stride + n + kCorrectSlot];
+                    }
+                    // Nobody reads this batch's inputs any more; the next
+                    // barrier publishes the next one.
+                    if (augmented && b + 1 < batches) augmented->Next(batch);
+                }
+                barrier.Wait();
+            }
+
+            if (t == 0 && options.report_every && (epoch + 1) % options.report_every == 0) {
+                cout << "Epoch " << epoch + 1 << "/" << options.epochs
+                     << ": loss " << epoch_loss / order.size()
+                     << ", accuracy " << 100.0 * epoch_correct / order.size() << "%" << endl;
+            }
+        }
+    }
+};
+
+static_assert(atomic<float>::is_always_lock_free, "Hogwild needs lock-free float atomics");
+
+// Pins the calling thread to the t-th CPU it is allowed on (wrapping), so
+// memory it touches first is allocated on, and stays near, that CPU's node.
+void PinToCpu(unsigned t) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+    int count = CPU_COUNT(&allowed);
+    if (count == 0) return;
+    int target = (int)(t % count);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed) || target-- > 0) continue;
+        cpu_set_t one;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+        return;
+    }
+}
+
+struct HogwildTrainer {
+    const IdxDataset& data;
+    const vector<size_t>& rows;
+    const TrainOptions& options;
+    const size_t n;
+    const unsigned threads;
+    unique_ptr<atomic<float>[]> params;  // n weights, then the bias
+    // Per thread, per epoch: summed loss and correct count over its shard.
+    vector<vector<double>> losses;
+    vector<vector<size_t>> corrects;
+
+    HogwildTrainer(const IdxDataset& iData, const vector<size_t>& iRows, const TrainOptions& iOptions,
+                   unsigned iThreads)
+        : data(iData), rows(iRows), options(iOptions), n(iData.Pixels()), threads(iThreads),
+          params(new atomic<float>[iData.Pixels() + 1]),
+          losses(iThreads, vector<double>(iOptions.epochs)),
+          corrects(iThreads, vector<size_t>(iOptions.epochs)) {}
+
+    // The SIMD kernels read plain floats, which other threads are writing;
+    // this reads each weight with a relaxed atomic load instead.
+    float Logit(const float* x) const {
+        float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        size_t j = 0;
+        for (; j + 4 <= n; j += 4) {
+            for (int k = 0; k < 4; ++k) acc[k] += params[j + k].load(memory_order_relaxed) * x[j + k];
+        }
+        for (; j < n; ++j) acc[0] += params[j].load(memory_order_relaxed) * x[j];
+        return (acc[0] + acc[1]) + (acc[2] + acc[3]) + params[n].load(memory_order_relaxed);
+    }
+
+    void Run(unsigned t) {
+        PinToCpu(t);
+
+        // Deal rows t, t + threads, ... into this thread's shard. Decoding
+        // here means the shard's pages are first touched, and so placed, by
+        // the thread that reads them every epoch.
+        vector<size_t> shard_rows;
+        for (size_t i = t; i < rows.size(); i += threads) shard_rows.push_back(rows[i]);
+        const size_t count = shard_rows.size();
+        vector<float> inputs(count * n);
+        vector<float> labels(count);
+        for (size_t i = 0; i < count; ++i) {
+            data.Decode(shard_rows[i], 1, &inputs[i * n]);
+            labels[i] = (float)data.Labels()[shard_rows[i]];
+        }
+
+        vector<size_t> order(count);
+        for (size_t i = 0; i < count; ++i) order[i] = i;
+        vector<float> distorted(options.augment ? n : 0);
+        mt19937 rng(options.seed + 1 + t);
+        for (size_t epoch = 0; epoch < options.epochs; ++epoch) {
+            shuffle(order.begin(), order.end(), rng);
+            double loss = 0.0;
+            size_t correct = 0;
+            for (size_t i : order) {
+                const float* x = &inputs[i * n];
+                if (options.augment) {
+                    AugmentImage(x, data.Cols(), data.Rows(), options.augmentation,
+                                 AugmentSeed(options.seed, epoch, shard_rows[i]), distorted.data());
+                    x = distorted.data();
+                }
+                const float y = labels[i];
+                const float logit = Logit(x);
+                loss += max(logit, 0.0f) - logit * y + log1pf(expf(-fabsf(logit)));
+                correct += (logit > 0) == (y > 0.5f);
+
+                // Racy read-modify-write: a concurrent update to the same
+                // weight can be lost, which Hogwild tolerates. Zero inputs
+                // have zero gradient and are skipped.
+                const float step = options.learning_rate * (1.0f / (1.0f + expf(-logit)) - y);
+                const float decay = options.learning_rate * options.l2;
+                for (size_t j = 0; j < n; ++j) {
+                    if (x[j] == 0.0f) continue;
+                    float w = params[j].load(memory_order_relaxed);
+                    params[j].store(w - step * x[j] - decay * w, memory_order_relaxed);
+                }
+                float b = params[n].load(memory_order_relaxed);
+                params[n].store(b - step, memory_order_relaxed);
+            }
+            losses[t][epoch] = loss;
+            corrects[t][epoch] = correct;
+        }
+    }
+};
+
+// Glorot uniform for a [n][1] kernel; Keras starts the bias at zero.
+vector<float> GlorotInit(size_t n, uint32_t seed) {
+    vector<float> params(n + 1, 0.0f);
+    mt19937 rng(seed);
+    const float limit = sqrtf(6.0f / (n + 1));
+    uniform_real_distribution<float> init(-limit, limit);
+    for (size_t j = 0; j < n; ++j) params[j] = init(rng);
+    return params;
+}
+
+LogisticModel TrainHogwild(const IdxDataset& data, const vector<size_t>& rows,
+                           const TrainOptions& options) {
+    const size_t n = data.Pixels();
+    unsigned threads = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+    threads = (unsigned)max<size_t>(min<size_t>(threads, rows.size()), 1);
+
+    HogwildTrainer trainer(data, rows, options, threads);
+    vector<float> init = GlorotInit(n, options.seed);
+    for (size_t j = 0; j <= n; ++j) trainer.params[j].store(init[j], memory_order_relaxed);
+
+    // The calling thread isn't a worker so that pinning doesn't stick to it.
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; ++t) workers.emplace_back(&HogwildTrainer::Run, &trainer, t);
+    for (thread& w : workers) w.join();
+
+    // Shards finish epochs at different times, so the report is assembled
+    // afterwards.
+    for (size_t epoch = 0; options.report_every && epoch < options.epochs; ++epoch) {
+        if ((epoch + 1) % options.report_every != 0 || rows.empty()) continue;
+        double loss = 0.0;
+        size_t correct = 0;
+        for (unsigned t = 0; t < threads; ++t) {
+            loss += trainer.losses[t][epoch];
+            correct += trainer.corrects[t][epoch];
+        }
+        cout << "Epoch " << epoch + 1 << "/" << options.epochs << ": loss " << loss / rows.size()
+             << ", accuracy " << 100.0 * correct / rows.size() << "%" << endl;
+    }
+
+    LogisticModel model;
+    model.weights.resize(n);
+    for (size_t j = 0; j < n; ++j) model.weights[j] = trainer.params[j].load(memory_order_relaxed);
+    model.bias = trainer.params[n].load(memory_order_relaxed);
+    return model;
+}
+
+}  // namespace
+
+LogisticModel TrainLogistic(const IdxDataset& data, const vector<size_t>& rows,
+                            const TrainOptions& options) {
+    if (options.hogwild) {
+        return TrainHogwild(data, rows, options);
+    }
+
+    const size_t n = data.Pixels();
+    TrainOptions opts = options;
+    opts.batch_size = max<size_t>(opts.batch_size, 1);
+
+    unsigned threads = opts.threads ? opts.threads : max(1u, thread::hardware_concurrency());
+    threads = (unsigned)min<size_t>(threads, (opts.batch_size + kTrainChunkRows - 1) / kTrainChunkRows);
+
+    SyncTrainer trainer(data, rows, opts, threads);
+    trainer.params = GlorotInit(n, opts.seed);
+
+    if (!rows.empty()) {
+        vector<thread> workers;
+        for (unsigned t = 1; t < threads; ++t) workers.emplace_back(&SyncTrainer::Run, &trainer, t);
+        trainer.Run(0);
+        for (thread& w : workers) w.join();
+    }
+
+    LogisticModel model;
+    model.bias = trainer.params[n];
+    trainer.params.resize(n);
+    model.weights = move(trainer.params);
+    return model;
+}
+
+EvalResult EvaluateLogistic(const LogisticModel& model, const IdxDataset& data,
+                            const vector<size_t>& rows, float threshold) {
+    const size_t kBlock = 256;
+    const size_t n = data.Pixels();
+    Perceptron perceptron(model.weights.data(), model.weights.size(), model.bias);
+    vector<float> inputs(kBlock * n);
+    vector<float> logits(kBlock);
+    // sigmoid(logit) > threshold  <=>  logit > log(threshold / (1 - threshold))
+    const float cutoff = logf(threshold / (1.0f - threshold));
+
+    EvalResult result;
+    for (size_t first = 0; first < rows.size(); first += kBlock) {
+        const size_t count = min(kBlock, rows.size() - first);
+        for (size_t r = 0; r < count; ++r) data.Decode(rows[first + r], 1, &inputs[r * n]);
+        perceptron.PredictBatch(inputs.data(), count, n, nullptr, logits.data());
+        for (size_t r = 0; r < count; ++r) {
+            const float y = (float)data.Labels()[rows[first + r]];
+            const float logit = logits[r];
+            result.loss += max(logit, 0.0f) - logit * y + log1pf(expf(-fabsf(logit)));
+            result.correct += ((logit > cutoff) ? 1 : 0) == (int)y;
+        }
+    }
+    result.samples = rows.size();
+    if (result.samples) result.loss /= result.samples;
+    return result;
+}
+
+void StratifiedSplit(const IdxDataset& data, double test_fraction, uint32_t seed,
+                     vector<size_t>& train_rows, vector<size_t>& test_rows) {
+    vector<vector<size_t>> by_label(256);
+    for (size_t i = 0; i < data.Size(); ++i) by_label[data.Labels()[i]].push_back(i);
+
+    mt19937 rng(seed);
+    train_rows.clear();
+    test_rows.clear();
+    for (vector<size_t>& rows : by_label) {
+        shuffle(rows.begin(), rows.end(), rng);
+        size_t test = (size_t)lround(rows.size() * test_fraction);
+        test_rows.insert(test_rows.end(), rows.begin(), rows.begin() + test);
+        train_rows.insert(train_rows.end(), rows.begin() + test, rows.end());
+    }
+    sort(train_rows.begin(), train_rows.end());
+    sort(test_rows.begin(), test_rows.end());
+}
+
+vector<vector<size_t>> StratifiedFolds(const IdxDataset& data, size_t k, uint32_t seed) {
+    vector<vector<size_t>> by_label(256);
+    for (size_t i = 0; i < data.Size(); ++i) by_label[data.Labels()[i]].push_back(i);
+
+    // Dealing continues across labels so the fold sizes differ by at most one.
+    mt19937 rng(seed);
+    vector<vector<size_t>> folds(max<size_t>(k, 1));
+    size_t next = 0;
+    for (vector<size_t>& rows : by_label) {
+        shuffle(rows.begin(), rows.end(), rng);
+        for (size_t row : rows) folds[next++ % folds.size()].push_back(row);
+    }
+    for (vector<size_t>& fold : folds) sort(fold.begin(), fold.end());
+    return folds;
+}
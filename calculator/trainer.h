@@ -0,0 +1,81 @@
+#ifndef TRAINER_H
+#define TRAINER_H
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include "idx_dataset.h"
+#include "augment.h"
+using namespace std;
+
+// The notebook's Keras setup: one Dense(1, sigmoid) unit trained with plain
+// SGD on binary cross-entropy, glorot-uniform weights and a zero bias.
+struct TrainOptions {
+  size_t epochs = 1000;
+  size_t batch_size = 32;
+  float learning_rate = 0.01f;
+  // L2 penalty: l2 / 2 * |w|^2 is added to the loss (the bias is exempt).
+  // Hogwild applies it only to the weights a sample touches.
+  float l2 = 0.0f;
+  // Worker threads; 0 = one per core. Synchronous mode uses no more than a
+  // batch has chunks of kTrainChunkRows.
+  unsigned threads = 0;
+  // Seeds the initial weights and the per-epoch shuffles.
+  uint32_t seed = 42;
+  // Print the epoch's mean loss and accuracy every this many epochs; 0 = never.
+  size_t report_every = 0;
+  // Hogwild: every thread runs per-sample SGD over its own shard and writes
+  // the shared weights with relaxed atomics and no locks. batch_size is
+  // ignored and the result depends on thread timing.
+  bool hogwild = false;
+  // Train on a freshly distorted copy of every sample in every epoch (see
+  // AugmentImage). In synchronous mode the copies are made on
+  // augment_threads threads into a ring of queue_depth batches running
+  // ahead of the optimizer; Hogwild workers distort their own samples.
+  // Nothing is written to disk.
+  bool augment = false;
+  AugmentOptions augmentation;
+  unsigned augment_threads = 2;
+  size_t queue_depth = 4;
+};
+
+// A batch is split into chunks of this many rows. Each chunk's gradient is
+// summed in row order and the chunk sums are added in chunk order, so the
+// trained weights don't depend on the thread count.
+static const size_t kTrainChunkRows = 8;
+
+struct LogisticModel {
+  vector<float> weights;
+  float bias = 0.0f;
+};
+
+struct EvalResult {
+  size_t samples = 0;
+  size_t correct = 0;
+  double loss = 0.0;  // mean binary cross-entropy
+  double Accuracy() const { return samples ? (double)correct / samples : 0.0; }
+};
+
+// Trains on the samples of `data` listed in `rows`, whose labels must be 0 or
+// 1. Synchronous mode decodes samples from the mapping a batch at a time; the
+// forward pass uses dot_kernels().dot4 and the gradient is reduced across the
+// workers. Hogwild mode deals the rows out into per-thread shards, each
+// decoded into memory first touched by the thread that owns it, with workers
+// pinned to distinct CPUs so the shard stays on their NUMA node.
+LogisticModel TrainLogistic(const IdxDataset& data, const vector<size_t>& rows,
+                            const TrainOptions& options);
+
+// Scores `rows`, predicting 1 when the sigmoid output exceeds `threshold`.
+EvalResult EvaluateLogistic(const LogisticModel& model, const IdxDataset& data,
+                            const vector<size_t>& rows, float threshold = 0.5f);
+
+// Splits the samples into a training and a test set, keeping each label's
+// share in both (like train_test_split(..., stratify=labels)).
+void StratifiedSplit(const IdxDataset& data, double test_fraction, uint32_t seed,
+                     vector<size_t>& train_rows, vector<size_t>& test_rows);
+
+// Deals the samples into `k` folds of (nearly) equal size and label mix, like
+// StratifiedKFold(k, shuffle=True). Fold f's validation rows are folds[f].
+vector<vector<size_t>> StratifiedFolds(const IdxDataset& data, size_t k, uint32_t seed);
+
+#endif
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include "work_stealing_pool.h"
+
+using namespace std;
+
+// The pool and worker index the calling thread belongs to, if any.
+static thread_local const WorkStealingPool* current_pool = nullptr;
+static thread_local int current_worker = -1;
+
+WorkStealingPool::WorkStealingPool(unsigned threads)
+    : queued(0), pending(0), steals(0), next_queue(0), stop(false) {
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    for (unsigned t = 0; t < threads; ++t) queues.emplace_back(new Queue());
+    for (unsigned t = 0; t < threads; ++t) workers.emplace_back(&WorkStealingPool::WorkerLoop, this, t);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    Wait();
+    {
+        lock_guard<mutex> guard(lock);
+        stop = true;
+    }
+    work_ready.notify_all();
+    for (thread& t : workers) t.join();
+}
+
+void WorkStealingPool::Submit(function<void()> task) {
+    const bool spawned = (current_pool == this);
+    unsigned target = spawned ? (unsigned)current_worker : next_queue.fetch_add(1) % queues.size();
+    pending++;
+    {
+        // Counted before it is pushed so `queued` never goes below zero, and
+        // under `lock` so a worker can't check it and then miss the wakeup.
+        lock_guard<mutex> guard(lock);
+        queued++;
+    }
+    {
+        lock_guard<mutex> guard(queues[target]->lock);
+        if (spawned) {
+            queues[target]->tasks.push_front(move(task));
+        } else {
+            queues[target]->tasks.push_back(move(task));
+        }
+    }
+    work_ready.notify_one();
+}
+
+void WorkStealingPool::SubmitAll(vector<function<void()>> tasks) {
+    pending += tasks.size();
+    {
+        lock_guard<mutex> guard(lock);
+        queued += tasks.size();
+    }
+    {
+        // Workers take one deque lock at a time, so holding them all (in
+        // order) keeps every worker out until the deal is done.
+        vector<unique_lock<mutex>> guards;
+        for (const unique_ptr<Queue>& queue : queues) guards.emplace_back(queue->lock);
+        for (function<void()>& task : tasks) {
+            queues[next_queue.fetch_add(1) % queues.size()]->tasks.push_back(move(task));
+        }
+    }
+    work_ready.notify_all();
+}
+
+void WorkStealingPool::Wait() {
+    unique_lock<mutex> guard(lock);
+    all_done.wait(guard, [this] { return pending.load() == 0; });
+}
+
+// Runs one task: the front of our own deque, else the back of the first
+// other worker's deque that has one. Returns false if every deque was empty.
+bool WorkStealingPool::TryRun(unsigned self) {
+    function<void()> task;
+    const size_t n = queues.size();
+    for (size_t i = 0; i < n && !task; ++i) {
+        Queue& queue = *queues[(self + i) % n];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.tasks.empty()) continue;
+        if (i == 0) {
+            task = move(queue.tasks.front());
+            queue.tasks.pop_front();
+        } else {
+            task = move(queue.tasks.back());
+            queue.tasks.pop_back();
+            steals++;
+        }
+    }
+    if (!task) return false;
+
+    queued--;
+    task();
+    if (--pending == 0) {
+        lock_guard<mutex> guard(lock);
+        all_done.notify_all();
+    }
+    return true;
+}
+
+void WorkStealingPool::WorkerLoop(unsigned self) {
+    current_pool = this;
+    current_worker = (int)self;
+    while (true) {
+        if (TryRun(self)) continue;
+        unique_lock<mutex> guard(lock);
+        work_ready.wait(guard, [this] { return stop || queued.load() > 0; });
+        if (stop && queued.load() == 0) return;
+    }
+}
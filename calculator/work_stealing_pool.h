@@ -0,0 +1,68 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+using namespace std;
+
+// Fixed set of workers, each with its own task deque. Tasks submitted from
+// outside run in submission order: a worker takes the front of its own
+// deque, so a caller that queues its longest tasks first gets them started
+// first. A task spawned by a running task goes to the front of its worker's
+// deque and runs next (newest first, while its data is warm). A worker that
+// runs dry steals from the back of another's deque, i.e. the task that owner
+// would have reached last, so short tasks fill in around long ones and
+// tasks of very different cost (1000 vs 10 epochs) keep every core busy
+// without one shared queue to contend on.
+class WorkStealingPool {
+public:
+  // 0 = one worker per core.
+  explicit WorkStealingPool(unsigned threads = 0);
+  // Finishes every submitted task, then joins the workers.
+  ~WorkStealingPool();
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  // Queues `task`: at the front of the calling worker's own deque when
+  // called from a task, otherwise at the back of the workers' deques in turn.
+  void Submit(function<void()> task);
+  // Deals `tasks` out to the workers' deques in turn, all at once: no worker
+  // starts or steals until every task is queued, so with at least as many
+  // tasks as workers, the first Threads() tasks are the first to start.
+  void SubmitAll(vector<function<void()>> tasks);
+  // Blocks until every submitted task has finished.
+  void Wait();
+
+  unsigned Threads() const { return (unsigned)workers.size(); }
+  // Tasks a worker took from another worker's deque.
+  size_t Steals() const { return steals.load(); }
+
+private:
+  struct Queue {
+    mutex lock;
+    deque<function<void()>> tasks;
+  };
+
+  void WorkerLoop(unsigned self);
+  bool TryRun(unsigned self);
+
+  vector<unique_ptr<Queue>> queues;
+  vector<thread> workers;
+  mutex lock;
+  condition_variable work_ready;  // a task was queued, or stopping
+  condition_variable all_done;    // pending dropped to zero
+  atomic<size_t> queued;    // tasks sitting in deques
+  atomic<size_t> pending;   // tasks submitted and not yet finished
+  atomic<size_t> steals;
+  atomic<unsigned> next_queue;
+  bool stop;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef FIXEDPOINT_PERCEPTRON_H
+#define FIXEDPOINT_PERCEPTRON_H
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+using namespace std;
+
+// Integer-only perceptron for targets without a hardware FPU (the Nspire's
+// ARM9). Weights and bias are converted to Q16.16 once when the model is
+// loaded; features are Q8 integers (1.0 == 256), so a prediction is nothing
+// but integer multiply-adds into a 64-bit accumulator and a sign test.
+class FixedPointPerceptron {
+public:
+  static const int kWeightFracBits = 16;
+  static const int kFeatureFracBits = 8;
+  static const int32_t kFeatureOne = 1 << kFeatureFracBits;
+
+  FixedPointPerceptron(const vector<float>& iWeights, float iBias);
+  // Borrows `count` Q16.16 weights owned by the caller, e.g. the constexpr
+  // tables in a generated model header. No conversion, no heap.
+  FixedPointPerceptron(const int32_t* iWeights, size_t count, int32_t iBias);
+
+  // `x` holds `count` Q8 features. Returns 1 or 0 like Perceptron::Predict,
+  // or -1 if the size doesn't match.
+  int Predict(const int32_t* x, size_t count) const;
+  int Predict(const vector<int32_t>& x) const { return Predict(x.data(), x.size()); }
+
+  // Scores a binary input given as a bitmask (bit i % 8 of bits[i / 8] is
+  // input i) by summing the Q16 weights at the set bits; no multiplies.
+  int PredictBits(const uint8_t* bits, size_t count) const;
+
+  // Linear output in Q24 (weight bits + feature bits).
+  int64_t Logit(const int32_t* x) const;
+  int64_t LogitBits(const uint8_t* bits) const;
+
+  size_t InputSize() const { return borrowed ? borrowed_count : weights.size(); }
+  // Q16.16 weight of input i and the Q16.16 bias.
+  int32_t Weight(size_t i) const { return Weights()[i]; }
+  int32_t Bias() const { return bias; }
+
+  static int32_t ToWeight(float w);
+  static int32_t ToFeature(float x);
+
+  // On-device learning (perceptron rule for a binary input): adds `delta`
+  // (Q16.16) to the weight of every set bit and to the bias. A borrowed
+  // table is copied into owned memory first.
+  void UpdateBits(const uint8_t* bits, int32_t delta);
+  // Moves the weights toward `target` (0 or 1) by the smallest multiple of
+  // `rate` after which PredictBits(bits) returns `target`. Returns the delta
+  // applied, 0 if the prediction was already right.
+  int32_t CorrectBits(const uint8_t* bits, int target, int32_t rate);
+
+  // FNV-1a hash of the weights and bias; identifies the model an adapted
+  // weight file was derived from.
+  uint32_t Fingerprint() const;
+
+  // Adapted weights on disk, little-endian:
+  //   "PCAD", uint16 version (1), uint16 0, uint32 count, uint32 base
+  //   fingerprint, int32 bias, int32 weights[count], uint32 FNV-1a of all
+  //   preceding bytes.
+  bool Save(const char* path, uint32_t base) const;
+  // Replaces the weights with those saved by Save. Returns false and leaves
+  // the model alone if the file is missing, corrupt, of another size or was
+  // derived from a different base model.
+  bool Load(const char* path, uint32_t base);
+
+private:
+  const int32_t* Weights() const { return borrowed ? borrowed : weights.data(); }
+  void MakeWritable();
+
+  vector<int32_t> weights;
+  const int32_t* borrowed;
+  size_t borrowed_count;
+  int32_t bias;
+};
+
+#endif
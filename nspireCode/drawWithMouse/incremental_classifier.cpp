@@ -0,0 +1,103 @@
+#include <os.h>
+#include <cstring>
+#include <algorithm>
+#include "incremental_classifier.h"
+
+using namespace std;
+
+IncrementalClassifier::IncrementalClassifier(const FixedPointPerceptron& iModel,
+                                             const Preprocessor& iPreprocessor)
+    : model(iModel), preprocessor(iPreprocessor) {
+    Clear();
+}
+
+void IncrementalClassifier::Clear() {
+    memset(bits, 0, sizeof(bits));
+    logit = model.Bias();
+    empty = true;
+    min_x = min_y = max_x = max_y = 0;
+    mapping.min_x = mapping.min_y = mapping.size = 0;
+    dirty = false;
+}
+
+void IncrementalClassifier::MarkDirty(int x0, int y0, int x1, int y1) {
+    if (x0 > x1) swap(x0, x1);
+    if (y0 > y1) swap(y0, y1);
+    x0 = max(x0, 0);
+    y0 = max(y0, 0);
+    x1 = min(x1, SCREEN_WIDTH - 1);
+    y1 = min(y1, SCREEN_HEIGHT - 1);
+    if (x0 > x1 || y0 > y1) return;
+
+    if (!dirty) {
+        dirty_x0 = x0; dirty_x1 = x1;
+        dirty_y0 = y0; dirty_y1 = y1;
+        dirty = true;
+    } else {
+        dirty_x0 = min(dirty_x0, x0); dirty_x1 = max(dirty_x1, x1);
+        dirty_y0 = min(dirty_y0, y0); dirty_y1 = max(dirty_y1, y1);
+    }
+}
+
+void IncrementalClassifier::Update(const unsigned short* buffer) {
+    if (!dirty) return;
+    dirty = false;
+
+    // Grow the bounding box from the dirty rectangle only.
+    bool grew = false;
+    for (int y = dirty_y0; y <= dirty_y1; y++) {
+        for (int x = dirty_x0; x <= dirty_x1; x++) {
+            if (buffer[y * SCREEN_WIDTH + x] == 0x0000) continue;
+            if (empty) {
+                min_x = max_x = x;
+                min_y = max_y = y;
+                empty = false;
+                grew = true;
+            } else if (x < min_x || x > max_x || y < min_y || y > max_y) {
+                min_x = min(min_x, x); max_x = max(max_x, x);
+                min_y = min(min_y, y); max_y = max(max_y, y);
+                grew = true;
+            }
+        }
+    }
+
+    if (empty) return;
+    if (grew) {
+        Rebase(buffer);
+        return;
+    }
+
+    // Same mapping: recount only the cells whose source block overlaps the
+    // dirty rectangle.
+    const int grid_width = preprocessor.GridWidth();
+    for (int ty = 0; ty < preprocessor.GridHeight(); ty++) {
+        if (preprocessor.CellEndY(mapping, ty) <= dirty_y0 ||
+            preprocessor.CellStartY(mapping, ty) > dirty_y1) continue;
+        for (int tx = 0; tx < grid_width; tx++) {
+            if (preprocessor.CellEndX(mapping, tx) <= dirty_x0 ||
+                preprocessor.CellStartX(mapping, tx) > dirty_x1) continue;
+
+            int cell = ty * grid_width + tx;
+            bool on = preprocessor.CellIsOn(buffer, mapping, tx, ty);
+            if (on == getBit(bits, cell)) continue;
+            setBit(bits, cell, on);
+            logit += on ? model.Weight(cell) : -model.Weight(cell);
+        }
+    }
+}
+
+void IncrementalClassifier::Rebase(const unsigned short* buffer) {
+    mapping = preprocessor.MappingForBounds(min_x, max_x, min_y, max_y);
+    memset(bits, 0, sizeof(bits));
+    const int grid_width = preprocessor.GridWidth();
+    for (int ty = 0; ty < preprocessor.GridHeight(); ty++) {
+        for (int tx = 0; tx < grid_width; tx++) {
+            if (preprocessor.CellIsOn(buffer, mapping, tx, ty)) setBit(bits, ty * grid_width + tx, true);
+        }
+    }
+    RecomputeLogit();
+}
+
+void IncrementalClassifier::RecomputeLogit() {
+    logit = model.LogitBits(bits) >> FixedPointPerceptron::kFeatureFracBits;
+}
@@ -0,0 +1,53 @@
+#ifndef INCREMENTAL_CLASSIFIER_H
+#define INCREMENTAL_CLASSIFIER_H
+
+#include <stdint.h>
+#include "screen_features.h"
+#include "fixedpoint_perceptron.h"
+
+// Keeps the model's input grid and the running fixed-point logit in step with the
+// drawing, so a prediction costs work proportional to what changed since the
+// last one instead of a full screen scan and a full dot product.
+//
+// Drawing only ever turns pixels on, so the caller reports each stroke's
+// screen rectangle with MarkDirty. Update then grows the bounding box from
+// just that rectangle. If the box is unchanged, only cells overlapping the
+// rectangle are recounted and each flipped cell adds or subtracts its weight.
+// A grown box moves every cell boundary, so the grid is rebuilt (rebased)
+// from the content window alone.
+class IncrementalClassifier {
+public:
+  IncrementalClassifier(const FixedPointPerceptron& iModel, const Preprocessor& iPreprocessor);
+
+  // Forget everything; call after the screen is cleared.
+  void Clear();
+  // Pixels inside [x0, x1] x [y0, y1] (inclusive, any order) may have changed.
+  void MarkDirty(int x0, int y0, int x1, int y1);
+  // Applies all pending dirty rectangles.
+  void Update(const unsigned short* buffer);
+
+  // Same result as PredictBits on ConvertScreenToBits(buffer).
+  int Predict() const { return (logit > 0) ? 1 : 0; }
+  const uint8_t* Bits() const { return bits; }
+
+  // Re-derives the logit from the current grid, e.g. after the model's
+  // weights were changed.
+  void RecomputeLogit();
+
+private:
+  void Rebase(const unsigned short* buffer);
+
+  const FixedPointPerceptron& model;
+  const Preprocessor& preprocessor;
+  uint8_t bits[kMaxFeatureBytes];
+  int64_t logit;  // Q16.16: bias plus the weights of every set cell
+
+  bool empty;
+  int min_x, max_x, min_y, max_y;
+  GridMapping mapping;
+
+  bool dirty;
+  int dirty_x0, dirty_x1, dirty_y0, dirty_y1;
+};
+
+#endif
@@ -2,10 +2,11 @@
 #include <libndls.h>
 #include <vector>
 #include <iostream>
-#include <sstream>
-#include "perceptron.h"
-#include "weights_layer1.h"
-#include "biases_layer1.h"
+#include <cstring>
+#include "fixedpoint_perceptron.h"
+#include "screen_features.h"
+#include "incremental_classifier.h"
+#include "model_layer1.h"
 
 using namespace std;
 
@@ -50,83 +51,63 @@ void drawLine(unsigned short* buffer, int x0, int y0, int x1, int y1, unsigned s
     }
 }
 
-vector<float> load_weights_from_data() {
-    vector<float> weights;
-    istringstream iss(reinterpret_cast<const char*>(weights_layer1_txt));
-    float w;
-    while (iss >> w) weights.push_back(w);
-    return weights;
-}
-
-float load_bias_from_data() {
-    istringstream iss(reinterpret_cast<const char*>(biases_layer1_txt));
-    float bias = 0.0f;
-    iss >> bias;
-    return bias;
-}
-
-vector<float> convertScreenToFeatures(unsigned short* buffer) {
-    vector<float> features;
-    int min_x = SCREEN_WIDTH, max_x = -1;
-    int min_y = SCREEN_HEIGHT, max_y = -1;
-
-    for (int y = 0; y < SCREEN_HEIGHT; y++) {
-        for (int x = 0; x < SCREEN_WIDTH; x++) {
-            if (buffer[y * SCREEN_WIDTH + x] != 0x0000) {
-                min_x = min(x, min_x);
-                max_x = max(x, max_x);
-                min_y = min(y, min_y);
-                max_y = max(y, max_y);
-            }
-        }
-    }
-
-    if (max_x == -1) {
-        for (int i = 0; i < 784; i++) features.push_back(0.0f);
-        return features;
-    }
-
-    int content_width = max_x - min_x + 1;
-    int content_height = max_y - min_y + 1;
-    int content_size = max(content_width, content_height);
-    int padding = content_size / 5;
-    content_size += 2 * padding;
-    int center_x = (min_x + max_x) / 2;
-    int center_y = (min_y + max_y) / 2;
-    int content_min_x = center_x - content_size / 2;
-    int content_min_y = center_y - content_size / 2;
-
-    const int target_width = 28;
-    const int target_height = 28;
-
-    for (int ty = 0; ty < target_height; ty++) {
-        for (int tx = 0; tx < target_width; tx++) {
-            int start_x = content_min_x + (tx * content_size) / target_width;
-            int end_x = content_min_x + ((tx + 1) * content_size) / target_width;
-            int start_y = content_min_y + (ty * content_size) / target_height;
-            int end_y = content_min_y + ((ty + 1) * content_size) / target_height;
-
-            int white_pixels = 0, total_pixels = 0;
-            for (int y = start_y; y < end_y; y++) {
-                for (int x = start_x; x < end_x; x++) {
-                    if (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT) {
-                        unsigned short pixel = buffer[y * SCREEN_WIDTH + x];
-                        if (pixel != 0x0000) white_pixels++;
-                    }
-                    total_pixels++;
-                }
+// 5x7 glyphs for the prediction readout, one row per byte (bit 4 is the
+// leftmost column): digits, then letters. Letters draw in upper case.
+static const unsigned char kGlyphs[36][7] = {
+    {0x0E,0x11,0x13,0x15,0x19,0x11,0x0E}, {0x04,0x0C,0x04,0x04,0x04,0x04,0x0E},
+    {0x0E,0x11,0x01,0x02,0x04,0x08,0x1F}, {0x1F,0x02,0x04,0x02,0x01,0x11,0x0E},
+    {0x02,0x06,0x0A,0x12,0x1F,0x02,0x02}, {0x1F,0x10,0x1E,0x01,0x01,0x11,0x0E},
+    {0x06,0x08,0x10,0x1E,0x11,0x11,0x0E}, {0x1F,0x01,0x02,0x04,0x08,0x08,0x08},
+    {0x0E,0x11,0x11,0x0E,0x11,0x11,0x0E}, {0x0E,0x11,0x11,0x0F,0x01,0x02,0x0C},
+    {0x0E,0x11,0x11,0x1F,0x11,0x11,0x11}, {0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E},
+    {0x0E,0x11,0x10,0x10,0x10,0x11,0x0E}, {0x1C,0x12,0x11,0x11,0x11,0x12,0x1C},
+    {0x1F,0x10,0x10,0x1E,0x10,0x10,0x1F}, {0x1F,0x10,0x10,0x1E,0x10,0x10,0x10},
+    {0x0E,0x11,0x10,0x17,0x11,0x11,0x0F}, {0x11,0x11,0x11,0x1F,0x11,0x11,0x11},
+    {0x0E,0x04,0x04,0x04,0x04,0x04,0x0E}, {0x07,0x02,0x02,0x02,0x02,0x12,0x0C},
+    {0x11,0x12,0x14,0x18,0x14,0x12,0x11}, {0x10,0x10,0x10,0x10,0x10,0x10,0x1F},
+    {0x11,0x1B,0x15,0x15,0x11,0x11,0x11}, {0x11,0x11,0x19,0x15,0x13,0x11,0x11},
+    {0x0E,0x11,0x11,0x11,0x11,0x11,0x0E}, {0x1E,0x11,0x11,0x1E,0x10,0x10,0x10},
+    {0x0E,0x11,0x11,0x11,0x15,0x12,0x0D}, {0x1E,0x11,0x11,0x1E,0x14,0x12,0x11},
+    {0x0F,0x10,0x10,0x0E,0x01,0x01,0x1E}, {0x1F,0x04,0x04,0x04,0x04,0x04,0x04},
+    {0x11,0x11,0x11,0x11,0x11,0x11,0x0E}, {0x11,0x11,0x11,0x11,0x11,0x0A,0x04},
+    {0x11,0x11,0x11,0x15,0x15,0x15,0x0A}, {0x11,0x11,0x0A,0x04,0x0A,0x11,0x11},
+    {0x11,0x11,0x11,0x0A,0x04,0x04,0x04}, {0x1F,0x01,0x02,0x04,0x08,0x10,0x1F},
+};
+static const unsigned char kUnknownGlyph[7] = {0x0E,0x11,0x01,0x02,0x04,0x00,0x04};
+
+// Draws `label` at twice the font size with its top-left corner at (x, y);
+// characters outside 0-9, a-z and A-Z draw as '?'.
+void drawLabel(unsigned short* buffer, int x, int y, char label, unsigned short color) {
+    const unsigned char* glyph = kUnknownGlyph;
+    if (label >= '0' && label <= '9') glyph = kGlyphs[label - '0'];
+    else if (label >= 'a' && label <= 'z') glyph = kGlyphs[10 + label - 'a'];
+    else if (label >= 'A' && label <= 'Z') glyph = kGlyphs[10 + label - 'A'];
+
+    for (int row = 0; row < 7; row++) {
+        for (int col = 0; col < 5; col++) {
+            if (!(glyph[row] & (0x10 >> col))) continue;
+            for (int i = 0; i < 4; i++) {
+                setPixel(buffer, x + 2 * col + i % 2, y + 2 * row + i / 2, color);
             }
-
-            float feature = (total_pixels > 0) ? (float)white_pixels / total_pixels : 0.0f;
-            feature = (feature > 0.25f) ? 1.0f : 0.0f;
-            features.push_back(feature);
         }
     }
+}
 
-    return features;
+// Weights adapted by the correction key are kept next to the program, so
+// they survive a restart; .tns keeps the file visible on the calculator.
+static const char kAdaptedFileName[] = "mouseDraw_weights.tns";
+// Q16.16 learning rate of one correction step (0.01, the training rate).
+static const int32_t kCorrectionRate = 655;
+
+void adaptedWeightsPath(const char* program, char* path, size_t size) {
+    const char* slash = strrchr(program ? program : "", '/');
+    size_t dir = slash ? (size_t)(slash - program) + 1 : 0;
+    if (dir + sizeof(kAdaptedFileName) > size) dir = 0;
+    memcpy(path, program, dir);
+    memcpy(path + dir, kAdaptedFileName, sizeof(kAdaptedFileName));
 }
 
-int main(void) {
+int main(int argc, char** argv) {
     const unsigned short COLOR_WHITE = 0xFFFF;
     const unsigned short COLOR_BLACK = 0x0000;
     const unsigned short COLOR_GREEN = 0x07E0;
@@ -134,9 +115,17 @@ int main(void) {
     const unsigned short COLOR_BLUE = 0x001F;
     const unsigned short COLOR_YELLOW = 0xFFE0;
 
-    vector<float> weights = load_weights_from_data();
-    float bias = load_bias_from_data();
-    Perceptron perceptron(weights, bias);
+    // Grid, preprocessing and labels all come from the generated model header.
+    const ModelInfo& info = weights_layer1_info;
+    FixedPointPerceptron perceptron(weights_layer1_q16, weights_layer1_len, weights_layer1_bias_q16);
+    // Pick up earlier corrections, unless the header's model has changed
+    // since they were made.
+    const uint32_t base_model = perceptron.Fingerprint();
+    char adapted_path[256];
+    adaptedWeightsPath(argc > 0 ? argv[0] : nullptr, adapted_path, sizeof(adapted_path));
+    perceptron.Load(adapted_path, base_model);
+    Preprocessor preprocessor(info);
+    IncrementalClassifier classifier(perceptron, preprocessor);
     clearScreen(screen_buffer, COLOR_BLACK);
 
     int x = 160, y = 120;
@@ -183,6 +172,9 @@ int main(void) {
                 // Draw line if we're in drawing mode
                 if (drawing) {
                     drawLine(screen_buffer, prevX, prevY, x, y, COLOR_WHITE);
+                    // The 5x5 brush reaches 2 pixels past the line's end points.
+                    classifier.MarkDirty(min(prevX, x) - 2, min(prevY, y) - 2,
+                                         max(prevX, x) + 2, max(prevY, y) + 2);
                 }
                 
                 // Update last trackpad position
@@ -203,14 +195,32 @@ int main(void) {
 
         if (isKeyPressed(KEY_NSPIRE_C)) {
             clearScreen(screen_buffer, COLOR_BLACK);
+            classifier.Clear();
             show_prediction = 0;
         }
 
         if (isKeyPressed(KEY_NSPIRE_P)) {
-            vector<float> features = convertScreenToFeatures(screen_buffer);
-            if (features.size() == weights.size()) {
-                int prediction = perceptron.Predict(features);
-                last_prediction = (prediction == 0) ? 'a' : 'b';
+            if (preprocessor.IsValid() && perceptron.InputSize() == (size_t)preprocessor.FeatureCount()) {
+                classifier.Update(screen_buffer);
+                int prediction = classifier.Predict();
+                last_prediction = info.labels[prediction];
+                show_prediction = 1;
+                prediction_timer = 0;
+            }
+            msleep(200);
+        }
+
+        // The prediction for this drawing is wrong: nudge the weights until
+        // it flips to the other label, then save them.
+        if (isKeyPressed(KEY_NSPIRE_X)) {
+            if (preprocessor.IsValid() && perceptron.InputSize() == (size_t)preprocessor.FeatureCount()) {
+                classifier.Update(screen_buffer);
+                int target = 1 - classifier.Predict();
+                if (perceptron.CorrectBits(classifier.Bits(), target, kCorrectionRate) != 0) {
+                    classifier.RecomputeLogit();
+                    perceptron.Save(adapted_path, base_model);
+                }
+                last_prediction = info.labels[classifier.Predict()];
                 show_prediction = 1;
                 prediction_timer = 0;
             }
@@ -226,71 +236,10 @@ int main(void) {
         }
 
         if (show_prediction) {
-            unsigned short pred_color = (last_prediction == 'a') ? COLOR_BLUE : COLOR_YELLOW;
+            unsigned short pred_color = (last_prediction == info.labels[0]) ? COLOR_BLUE : COLOR_YELLOW;
 
-            if (last_prediction == 'a') {
-                // Draw a 'A' pattern
-                int base_x = 289;
-                int base_y = 8;
-                
-                // Left diagonal line
-                for (int i = 0; i < 12; i++) {
-                    setPixel(display_buffer, base_x - i/2, base_y + i, pred_color);
-                    setPixel(display_buffer, base_x - i/2 + 1, base_y + i, pred_color);
-                }
-                
-                // Right diagonal line
-                for (int i = 0; i < 12; i++) {
-                    setPixel(display_buffer, base_x + i/2, base_y + i, pred_color);
-                    setPixel(display_buffer, base_x + i/2 + 1, base_y + i, pred_color);
-                }
-                
-                // Horizontal crossbar
-                for (int i = -3; i <= 3; i++) {
-                    setPixel(display_buffer, base_x + i, base_y + 7, pred_color);
-                    setPixel(display_buffer, base_x + i, base_y + 8, pred_color);
-                }
-            } else {
-                // Draw a 'B' pattern
-                int base_x = 285;
-                int base_y = 8;
-                
-                // Left vertical line
-                for (int i = 0; i < 14; i++) {
-                    setPixel(display_buffer, base_x, base_y + i, pred_color);
-                    setPixel(display_buffer, base_x + 1, base_y + i, pred_color);
-                }
-                
-                // Top horizontal line
-                for (int i = 0; i < 8; i++) {
-                    setPixel(display_buffer, base_x + i, base_y, pred_color);
-                    setPixel(display_buffer, base_x + i, base_y + 1, pred_color);
-                }
-                
-                // Middle horizontal line
-                for (int i = 0; i < 7; i++) {
-                    setPixel(display_buffer, base_x + i, base_y + 6, pred_color);
-                    setPixel(display_buffer, base_x + i, base_y + 7, pred_color);
-                }
-                
-                // Bottom horizontal line
-                for (int i = 0; i < 8; i++) {
-                    setPixel(display_buffer, base_x + i, base_y + 12, pred_color);
-                    setPixel(display_buffer, base_x + i, base_y + 13, pred_color);
-                }
-                
-                // Right edges for top bump
-                for (int i = 2; i < 6; i++) {
-                    setPixel(display_buffer, base_x + 7, base_y + i, pred_color);
-                    setPixel(display_buffer, base_x + 8, base_y + i, pred_color);
-                }
-                
-                // Right edges for bottom bump
-                for (int i = 8; i < 12; i++) {
-                    setPixel(display_buffer, base_x + 7, base_y + i, pred_color);
-                    setPixel(display_buffer, base_x + 8, base_y + i, pred_color);
-                }
-            }
+            // Whatever labels the model header carries.
+            drawLabel(display_buffer, 284, 8, last_prediction, pred_color);
 
             prediction_timer++;
             if (prediction_timer > 100) {
@@ -0,0 +1,86 @@
+#include <os.h>
+#include <cstring>
+#include <algorithm>
+#include "screen_features.h"
+
+using namespace std;
+
+Preprocessor::Preprocessor(const ModelInfo& iInfo)
+    : grid_width(iInfo.input_width), grid_height(iInfo.input_height),
+      padding_num(iInfo.padding_num), padding_den(iInfo.padding_den) {
+    if (grid_width <= 0 || grid_width > kMaxGridSide ||
+        grid_height <= 0 || grid_height > kMaxGridSide || padding_den <= 0) {
+        return;
+    }
+
+    // The largest window is a full-width drawing plus its padding; a cell of
+    // it spans at most size / grid + 1 pixels in each direction.
+    int max_size = SCREEN_WIDTH + 2 * (SCREEN_WIDTH * padding_num / padding_den) + 1;
+    int max_cell = (max_size / grid_width + 1) * (max_size / grid_height + 1);
+    min_white.resize(max_cell + 1);
+    for (int n = 0; n <= max_cell; n++) {
+        min_white[n] = (uint16_t)(n * iInfo.threshold) + 1;
+    }
+}
+
+GridMapping Preprocessor::MappingForBounds(int min_x, int max_x, int min_y, int max_y) const {
+    int content_width = max_x - min_x + 1;
+    int content_height = max_y - min_y + 1;
+    int content_size = max(content_width, content_height);
+    int padding = content_size * padding_num / padding_den;
+    content_size += 2 * padding;
+    int center_x = (min_x + max_x) / 2;
+    int center_y = (min_y + max_y) / 2;
+
+    GridMapping m;
+    m.min_x = center_x - content_size / 2;
+    m.min_y = center_y - content_size / 2;
+    m.size = content_size;
+    return m;
+}
+
+bool Preprocessor::CellIsOn(const unsigned short* buffer, const GridMapping& m, int tx, int ty) const {
+    int start_x = CellStartX(m, tx);
+    int end_x = CellEndX(m, tx);
+    int start_y = CellStartY(m, ty);
+    int end_y = CellEndY(m, ty);
+
+    int white_pixels = 0;
+    for (int y = max(start_y, 0); y < min(end_y, SCREEN_HEIGHT); y++) {
+        for (int x = max(start_x, 0); x < min(end_x, SCREEN_WIDTH); x++) {
+            if (buffer[y * SCREEN_WIDTH + x] != 0x0000) white_pixels++;
+        }
+    }
+
+    // Off-screen pixels count towards the total but are never drawn.
+    int total_pixels = (end_x - start_x) * (end_y - start_y);
+    return white_pixels >= min_white[total_pixels];
+}
+
+void Preprocessor::ConvertScreenToBits(const unsigned short* buffer, uint8_t* bits) const {
+    memset(bits, 0, FeatureBytes());
+    int min_x = SCREEN_WIDTH, max_x = -1;
+    int min_y = SCREEN_HEIGHT, max_y = -1;
+
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            if (buffer[y * SCREEN_WIDTH + x] != 0x0000) {
+                min_x = min(x, min_x);
+                max_x = max(x, max_x);
+                min_y = min(y, min_y);
+                max_y = max(y, max_y);
+            }
+        }
+    }
+
+    if (max_x == -1) {
+        return;
+    }
+
+    GridMapping m = MappingForBounds(min_x, max_x, min_y, max_y);
+    for (int ty = 0; ty < grid_height; ty++) {
+        for (int tx = 0; tx < grid_width; tx++) {
+            if (CellIsOn(buffer, m, tx, ty)) setBit(bits, ty * grid_width + tx, true);
+        }
+    }
+}
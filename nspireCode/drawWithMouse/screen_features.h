@@ -0,0 +1,64 @@
+#ifndef SCREEN_FEATURES_H
+#define SCREEN_FEATURES_H
+
+#include <stdint.h>
+#include <vector>
+#include "model_info.h"
+
+// Largest grid a model may ask for; sizes the bitmask buffers.
+static const int kMaxGridSide = 64;
+static const int kMaxFeatureBytes = kMaxGridSide * kMaxGridSide / 8;
+
+// Square window of the screen that is downsampled onto the model's grid: the
+// drawing's bounding box, centered and padded on each side.
+struct GridMapping {
+    int min_x;
+    int min_y;
+    int size;
+};
+
+inline void setBit(uint8_t* bits, int cell, bool on) {
+    if (on) bits[cell / 8] |= (uint8_t)(1u << (cell % 8));
+    else bits[cell / 8] &= (uint8_t)~(1u << (cell % 8));
+}
+
+inline bool getBit(const uint8_t* bits, int cell) {
+    return (bits[cell / 8] >> (cell % 8)) & 1;
+}
+
+// Turns the drawing into the model's input bitmask (bit i % 8 of bits[i / 8]
+// is cell i) as the ModelInfo describes: grid size, bounding-box padding and
+// on-threshold. Everything that depends only on the model is worked out once
+// in the constructor, including the per-cell-size threshold table, so the
+// conversion itself is integer math with no soft-float calls.
+class Preprocessor {
+public:
+  explicit Preprocessor(const ModelInfo& iInfo);
+
+  bool IsValid() const { return !min_white.empty(); }
+  int GridWidth() const { return grid_width; }
+  int GridHeight() const { return grid_height; }
+  int FeatureCount() const { return grid_width * grid_height; }
+  int FeatureBytes() const { return (FeatureCount() + 7) / 8; }
+
+  GridMapping MappingForBounds(int min_x, int max_x, int min_y, int max_y) const;
+
+  // Screen columns (rows) [start, end) feeding grid column (row) `t`.
+  int CellStartX(const GridMapping& m, int t) const { return m.min_x + (t * m.size) / grid_width; }
+  int CellEndX(const GridMapping& m, int t) const { return m.min_x + ((t + 1) * m.size) / grid_width; }
+  int CellStartY(const GridMapping& m, int t) const { return m.min_y + (t * m.size) / grid_height; }
+  int CellEndY(const GridMapping& m, int t) const { return m.min_y + ((t + 1) * m.size) / grid_height; }
+
+  // True when more than the model's threshold of the cell's source pixels are drawn.
+  bool CellIsOn(const unsigned short* buffer, const GridMapping& m, int tx, int ty) const;
+
+  void ConvertScreenToBits(const unsigned short* buffer, uint8_t* bits) const;
+
+private:
+  int grid_width, grid_height;
+  int padding_num, padding_den;
+  // min_white[n]: fewest drawn pixels that turn on a cell of n source pixels.
+  std::vector<uint16_t> min_white;
+};
+
+#endif
@@ -1,1670 +0,0 @@
-unsigned char weights_layer1_txt[] = {
-  0x2d, 0x35, 0x2e, 0x39, 0x32, 0x35, 0x34, 0x37, 0x35, 0x34, 0x33, 0x33,
-  0x34, 0x36, 0x38, 0x38, 0x31, 0x38, 0x36, 0x36, 0x35, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x36, 0x35, 0x37, 0x33, 0x34, 0x37, 0x30,
-  0x38, 0x33, 0x30, 0x39, 0x31, 0x37, 0x33, 0x35, 0x38, 0x34, 0x30, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x34, 0x37, 0x30, 0x38, 0x33,
-  0x32, 0x37, 0x31, 0x32, 0x39, 0x34, 0x38, 0x33, 0x32, 0x32, 0x32, 0x39,
-  0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x37, 0x39, 0x30,
-  0x31, 0x32, 0x38, 0x33, 0x35, 0x30, 0x32, 0x35, 0x37, 0x38, 0x37, 0x33,
-  0x35, 0x33, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x39, 0x2e, 0x31,
-  0x36, 0x35, 0x38, 0x36, 0x39, 0x36, 0x35, 0x33, 0x32, 0x32, 0x34, 0x39,
-  0x34, 0x35, 0x30, 0x36, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37,
-  0x2e, 0x32, 0x36, 0x37, 0x37, 0x39, 0x38, 0x32, 0x39, 0x37, 0x31, 0x30,
-  0x37, 0x32, 0x31, 0x39, 0x36, 0x39, 0x36, 0x65, 0x2d, 0x30, 0x33, 0x0a,
-  0x2d, 0x36, 0x2e, 0x35, 0x37, 0x34, 0x34, 0x34, 0x37, 0x34, 0x35, 0x33,
-  0x30, 0x32, 0x32, 0x30, 0x30, 0x33, 0x31, 0x37, 0x34, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x34, 0x2e, 0x31, 0x39, 0x30, 0x34, 0x31, 0x39, 0x39, 0x38,
-  0x36, 0x38, 0x34, 0x34, 0x30, 0x36, 0x32, 0x38, 0x30, 0x35, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x36, 0x2e, 0x31, 0x34, 0x33, 0x38, 0x33, 0x30, 0x33,
-  0x34, 0x34, 0x30, 0x38, 0x30, 0x39, 0x32, 0x34, 0x39, 0x38, 0x38, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x32, 0x37, 0x36, 0x38, 0x37, 0x30,
-  0x33, 0x31, 0x30, 0x33, 0x30, 0x36, 0x35, 0x34, 0x39, 0x30, 0x37, 0x32,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x33, 0x36, 0x37, 0x34,
-  0x31, 0x32, 0x37, 0x39, 0x30, 0x36, 0x35, 0x36, 0x30, 0x38, 0x39, 0x37,
-  0x38, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x30, 0x35, 0x34,
-  0x31, 0x30, 0x34, 0x34, 0x39, 0x32, 0x30, 0x36, 0x38, 0x32, 0x39, 0x30,
-  0x37, 0x31, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x30,
-  0x36, 0x30, 0x33, 0x39, 0x37, 0x35, 0x30, 0x35, 0x37, 0x36, 0x30, 0x31,
-  0x39, 0x32, 0x38, 0x37, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31,
-  0x2e, 0x32, 0x32, 0x35, 0x39, 0x35, 0x32, 0x35, 0x32, 0x34, 0x36, 0x39,
-  0x31, 0x38, 0x32, 0x30, 0x31, 0x34, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x38, 0x2e, 0x34, 0x38, 0x37, 0x39, 0x38, 0x31, 0x35, 0x35, 0x37,
-  0x38, 0x34, 0x36, 0x30, 0x36, 0x39, 0x33, 0x33, 0x36, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x39, 0x35, 0x36, 0x35, 0x37, 0x38, 0x33,
-  0x37, 0x33, 0x39, 0x30, 0x38, 0x39, 0x39, 0x36, 0x35, 0x38, 0x32, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x37, 0x33, 0x37, 0x37, 0x34, 0x32,
-  0x38, 0x34, 0x38, 0x36, 0x39, 0x34, 0x33, 0x32, 0x34, 0x34, 0x39, 0x33,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x32, 0x37, 0x37, 0x37, 0x34,
-  0x31, 0x33, 0x32, 0x37, 0x38, 0x38, 0x31, 0x38, 0x31, 0x33, 0x30, 0x34,
-  0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x38, 0x35, 0x30,
-  0x37, 0x32, 0x30, 0x34, 0x35, 0x30, 0x32, 0x38, 0x32, 0x30, 0x39, 0x36,
-  0x38, 0x36, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x37, 0x37,
-  0x31, 0x31, 0x31, 0x35, 0x32, 0x35, 0x38, 0x33, 0x33, 0x36, 0x30, 0x36,
-  0x37, 0x32, 0x30, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x32,
-  0x34, 0x34, 0x39, 0x30, 0x33, 0x33, 0x33, 0x33, 0x34, 0x38, 0x35, 0x31,
-  0x32, 0x36, 0x34, 0x39, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e,
-  0x31, 0x32, 0x32, 0x30, 0x35, 0x37, 0x39, 0x32, 0x39, 0x36, 0x33, 0x35,
-  0x30, 0x34, 0x37, 0x39, 0x31, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35,
-  0x2e, 0x32, 0x30, 0x35, 0x31, 0x32, 0x30, 0x35, 0x31, 0x38, 0x38, 0x30,
-  0x33, 0x35, 0x39, 0x36, 0x34, 0x39, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x31, 0x2e, 0x36, 0x36, 0x33, 0x38, 0x31, 0x36, 0x31, 0x36, 0x31,
-  0x34, 0x35, 0x33, 0x37, 0x32, 0x33, 0x39, 0x30, 0x37, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x37, 0x32, 0x36, 0x38, 0x34, 0x33, 0x32,
-  0x33, 0x30, 0x34, 0x32, 0x36, 0x33, 0x31, 0x31, 0x34, 0x39, 0x33, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x30, 0x36, 0x33, 0x31, 0x34, 0x35,
-  0x36, 0x37, 0x34, 0x37, 0x36, 0x35, 0x31, 0x31, 0x30, 0x30, 0x31, 0x36,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x34, 0x30, 0x33, 0x37,
-  0x38, 0x31, 0x30, 0x35, 0x36, 0x34, 0x30, 0x34, 0x31, 0x31, 0x33, 0x37,
-  0x37, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x35, 0x33, 0x39,
-  0x30, 0x36, 0x33, 0x30, 0x35, 0x38, 0x37, 0x39, 0x33, 0x35, 0x34, 0x34,
-  0x37, 0x36, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x33,
-  0x31, 0x35, 0x39, 0x30, 0x35, 0x33, 0x39, 0x32, 0x31, 0x36, 0x39, 0x39,
-  0x35, 0x32, 0x33, 0x39, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33,
-  0x2e, 0x31, 0x36, 0x39, 0x33, 0x37, 0x33, 0x30, 0x35, 0x30, 0x33, 0x33,
-  0x32, 0x30, 0x36, 0x39, 0x33, 0x39, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x35, 0x2e, 0x34, 0x36, 0x33, 0x37, 0x36, 0x32, 0x32, 0x30, 0x38,
-  0x38, 0x31, 0x39, 0x33, 0x38, 0x39, 0x33, 0x34, 0x33, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x37, 0x35, 0x38, 0x30, 0x30, 0x36, 0x39,
-  0x31, 0x35, 0x34, 0x35, 0x30, 0x30, 0x39, 0x36, 0x31, 0x33, 0x30, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x38, 0x30, 0x35, 0x31, 0x33,
-  0x38, 0x30, 0x32, 0x39, 0x31, 0x35, 0x38, 0x31, 0x31, 0x35, 0x33, 0x38,
-  0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x37, 0x36, 0x38, 0x39,
-  0x36, 0x39, 0x37, 0x32, 0x32, 0x30, 0x39, 0x32, 0x31, 0x35, 0x31, 0x36,
-  0x34, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x35, 0x35, 0x32,
-  0x33, 0x32, 0x30, 0x35, 0x35, 0x34, 0x38, 0x35, 0x32, 0x34, 0x38, 0x35,
-  0x36, 0x35, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x31, 0x33,
-  0x37, 0x35, 0x37, 0x39, 0x32, 0x31, 0x30, 0x31, 0x30, 0x32, 0x35, 0x35,
-  0x38, 0x31, 0x33, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e,
-  0x31, 0x31, 0x33, 0x30, 0x30, 0x34, 0x32, 0x36, 0x37, 0x32, 0x31, 0x35,
-  0x37, 0x32, 0x38, 0x37, 0x36, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x32, 0x2e, 0x35, 0x32, 0x37, 0x30, 0x37, 0x34, 0x33, 0x32, 0x39, 0x35,
-  0x35, 0x35, 0x30, 0x33, 0x34, 0x36, 0x33, 0x37, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x36, 0x2e, 0x38, 0x32, 0x39, 0x37, 0x38, 0x30, 0x33, 0x34,
-  0x30, 0x31, 0x39, 0x34, 0x37, 0x30, 0x32, 0x31, 0x34, 0x38, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x32, 0x36, 0x32, 0x36, 0x35, 0x37,
-  0x39, 0x39, 0x36, 0x32, 0x36, 0x37, 0x30, 0x38, 0x30, 0x33, 0x30, 0x37,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x35, 0x39, 0x31, 0x30, 0x37,
-  0x34, 0x30, 0x30, 0x34, 0x37, 0x36, 0x39, 0x33, 0x32, 0x35, 0x32, 0x35,
-  0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x38, 0x37, 0x36,
-  0x38, 0x31, 0x38, 0x38, 0x33, 0x35, 0x37, 0x33, 0x35, 0x33, 0x32, 0x31,
-  0x30, 0x34, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x37, 0x30,
-  0x39, 0x36, 0x32, 0x32, 0x34, 0x32, 0x37, 0x38, 0x32, 0x31, 0x31, 0x35,
-  0x39, 0x33, 0x36, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x38,
-  0x33, 0x35, 0x34, 0x37, 0x34, 0x36, 0x31, 0x30, 0x33, 0x32, 0x38, 0x36,
-  0x37, 0x34, 0x33, 0x31, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e,
-  0x36, 0x38, 0x36, 0x37, 0x37, 0x31, 0x31, 0x32, 0x34, 0x36, 0x30, 0x31,
-  0x33, 0x36, 0x34, 0x31, 0x33, 0x36, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d,
-  0x34, 0x2e, 0x31, 0x37, 0x37, 0x30, 0x31, 0x36, 0x33, 0x39, 0x32, 0x33,
-  0x35, 0x30, 0x31, 0x39, 0x36, 0x38, 0x33, 0x38, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x33, 0x2e, 0x35, 0x36, 0x35, 0x32, 0x35, 0x36, 0x36, 0x37, 0x30,
-  0x31, 0x31, 0x37, 0x33, 0x37, 0x38, 0x32, 0x33, 0x35, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x35, 0x33, 0x30, 0x37, 0x36, 0x33, 0x38,
-  0x35, 0x37, 0x30, 0x36, 0x36, 0x36, 0x33, 0x31, 0x33, 0x31, 0x37, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x35, 0x34, 0x31, 0x34, 0x32, 0x32,
-  0x39, 0x35, 0x39, 0x34, 0x31, 0x37, 0x31, 0x30, 0x34, 0x37, 0x32, 0x31,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x38, 0x30, 0x38, 0x34,
-  0x32, 0x39, 0x35, 0x33, 0x39, 0x32, 0x30, 0x33, 0x36, 0x34, 0x33, 0x37,
-  0x39, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x34, 0x31, 0x37,
-  0x32, 0x35, 0x36, 0x34, 0x32, 0x39, 0x37, 0x39, 0x31, 0x34, 0x35, 0x30,
-  0x35, 0x30, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x37, 0x39,
-  0x31, 0x39, 0x30, 0x35, 0x33, 0x35, 0x38, 0x34, 0x33, 0x33, 0x37, 0x32,
-  0x33, 0x34, 0x35, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e,
-  0x32, 0x39, 0x37, 0x32, 0x36, 0x37, 0x30, 0x31, 0x39, 0x37, 0x34, 0x38,
-  0x36, 0x38, 0x37, 0x37, 0x34, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33,
-  0x2e, 0x37, 0x34, 0x35, 0x31, 0x35, 0x35, 0x34, 0x30, 0x38, 0x39, 0x37,
-  0x38, 0x34, 0x36, 0x32, 0x32, 0x31, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x36, 0x2e, 0x32, 0x38, 0x38, 0x31, 0x34, 0x34, 0x37, 0x33, 0x37,
-  0x34, 0x38, 0x32, 0x30, 0x37, 0x30, 0x39, 0x32, 0x33, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x30, 0x32, 0x32, 0x39, 0x35, 0x34, 0x33,
-  0x35, 0x39, 0x36, 0x35, 0x30, 0x36, 0x31, 0x31, 0x38, 0x37, 0x37, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x39, 0x31, 0x32, 0x37, 0x39, 0x33,
-  0x34, 0x37, 0x32, 0x34, 0x30, 0x39, 0x32, 0x34, 0x38, 0x33, 0x35, 0x32,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x33, 0x37, 0x30, 0x34,
-  0x39, 0x38, 0x37, 0x37, 0x36, 0x34, 0x33, 0x35, 0x38, 0x35, 0x32, 0x30,
-  0x35, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x39, 0x32, 0x35,
-  0x34, 0x37, 0x33, 0x34, 0x30, 0x36, 0x39, 0x31, 0x30, 0x38, 0x39, 0x36,
-  0x33, 0x30, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x38,
-  0x38, 0x31, 0x37, 0x37, 0x37, 0x32, 0x34, 0x31, 0x38, 0x32, 0x36, 0x30,
-  0x35, 0x37, 0x34, 0x33, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e,
-  0x35, 0x35, 0x33, 0x38, 0x31, 0x38, 0x38, 0x32, 0x31, 0x39, 0x30, 0x37,
-  0x30, 0x34, 0x33, 0x34, 0x35, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x38, 0x2e, 0x37, 0x38, 0x31, 0x33, 0x39, 0x34, 0x33, 0x36, 0x32, 0x34,
-  0x34, 0x39, 0x36, 0x34, 0x35, 0x39, 0x39, 0x36, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x33, 0x2e, 0x32, 0x34, 0x38, 0x38, 0x35, 0x37, 0x33, 0x33, 0x34,
-  0x32, 0x35, 0x36, 0x31, 0x37, 0x32, 0x31, 0x38, 0x30, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x36, 0x31, 0x31, 0x37, 0x34, 0x37, 0x31,
-  0x39, 0x37, 0x38, 0x30, 0x36, 0x38, 0x33, 0x35, 0x31, 0x37, 0x35, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x31, 0x37, 0x35, 0x32, 0x33, 0x35,
-  0x34, 0x35, 0x30, 0x32, 0x36, 0x37, 0x37, 0x39, 0x31, 0x37, 0x34, 0x38,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x30, 0x33, 0x35, 0x34, 0x36,
-  0x34, 0x35, 0x33, 0x32, 0x36, 0x37, 0x33, 0x33, 0x35, 0x38, 0x39, 0x31,
-  0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x30, 0x32, 0x31, 0x34,
-  0x34, 0x36, 0x33, 0x36, 0x32, 0x31, 0x33, 0x37, 0x37, 0x39, 0x34, 0x34,
-  0x39, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x39, 0x31,
-  0x39, 0x32, 0x33, 0x34, 0x37, 0x33, 0x30, 0x33, 0x30, 0x33, 0x32, 0x38,
-  0x37, 0x35, 0x30, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x32, 0x2e,
-  0x34, 0x31, 0x33, 0x35, 0x37, 0x33, 0x32, 0x30, 0x39, 0x31, 0x39, 0x36,
-  0x33, 0x32, 0x39, 0x31, 0x31, 0x37, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x31,
-  0x2e, 0x36, 0x30, 0x36, 0x37, 0x31, 0x36, 0x35, 0x38, 0x38, 0x31, 0x33,
-  0x39, 0x35, 0x33, 0x33, 0x39, 0x39, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x37, 0x2e, 0x31, 0x37, 0x30, 0x39, 0x34, 0x39, 0x38, 0x37, 0x36, 0x33,
-  0x30, 0x38, 0x34, 0x34, 0x31, 0x31, 0x36, 0x32, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x37, 0x2e, 0x36, 0x38, 0x39, 0x36, 0x38, 0x31, 0x36, 0x34, 0x39,
-  0x32, 0x30, 0x38, 0x30, 0x36, 0x38, 0x38, 0x34, 0x38, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x32, 0x2e, 0x30, 0x30, 0x34, 0x31, 0x31, 0x32, 0x33, 0x34,
-  0x39, 0x38, 0x32, 0x33, 0x31, 0x31, 0x37, 0x32, 0x35, 0x36, 0x65, 0x2d,
-  0x30, 0x33, 0x0a, 0x2d, 0x36, 0x2e, 0x33, 0x37, 0x30, 0x31, 0x32, 0x35,
-  0x33, 0x33, 0x38, 0x34, 0x33, 0x35, 0x31, 0x37, 0x33, 0x30, 0x33, 0x35,
-  0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x33, 0x2e, 0x30, 0x37, 0x32, 0x39,
-  0x38, 0x31, 0x31, 0x36, 0x33, 0x38, 0x35, 0x39, 0x33, 0x36, 0x37, 0x33,
-  0x37, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x37, 0x38, 0x39,
-  0x35, 0x32, 0x30, 0x39, 0x36, 0x34, 0x30, 0x32, 0x36, 0x34, 0x35, 0x31,
-  0x31, 0x31, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x38,
-  0x36, 0x39, 0x39, 0x33, 0x39, 0x35, 0x30, 0x36, 0x30, 0x35, 0x33, 0x39,
-  0x32, 0x34, 0x35, 0x36, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e,
-  0x38, 0x31, 0x31, 0x38, 0x30, 0x30, 0x35, 0x39, 0x39, 0x30, 0x39, 0x38,
-  0x32, 0x30, 0x35, 0x35, 0x36, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35,
-  0x2e, 0x32, 0x35, 0x31, 0x36, 0x31, 0x35, 0x31, 0x32, 0x31, 0x39, 0x36,
-  0x30, 0x36, 0x33, 0x39, 0x39, 0x35, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x31, 0x2e, 0x30, 0x33, 0x35, 0x35, 0x31, 0x38, 0x32, 0x39, 0x32,
-  0x33, 0x33, 0x37, 0x36, 0x35, 0x36, 0x30, 0x32, 0x31, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x30, 0x32, 0x32, 0x35, 0x30, 0x30, 0x30,
-  0x33, 0x38, 0x31, 0x34, 0x36, 0x39, 0x37, 0x32, 0x36, 0x35, 0x36, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x39, 0x38, 0x30, 0x30, 0x30, 0x34,
-  0x36, 0x34, 0x35, 0x38, 0x38, 0x34, 0x30, 0x33, 0x37, 0x30, 0x31, 0x38,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x31, 0x30, 0x38, 0x32,
-  0x34, 0x32, 0x33, 0x31, 0x38, 0x30, 0x33, 0x34, 0x31, 0x37, 0x32, 0x30,
-  0x35, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x38, 0x37, 0x33,
-  0x36, 0x38, 0x35, 0x31, 0x32, 0x31, 0x35, 0x33, 0x36, 0x32, 0x35, 0x34,
-  0x38, 0x38, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x32,
-  0x33, 0x30, 0x39, 0x36, 0x30, 0x33, 0x36, 0x39, 0x31, 0x31, 0x30, 0x31,
-  0x30, 0x37, 0x34, 0x32, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e,
-  0x32, 0x39, 0x32, 0x30, 0x31, 0x34, 0x32, 0x31, 0x35, 0x31, 0x34, 0x31,
-  0x35, 0x33, 0x34, 0x38, 0x30, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31,
-  0x2e, 0x37, 0x32, 0x32, 0x31, 0x33, 0x37, 0x38, 0x31, 0x36, 0x32, 0x35,
-  0x30, 0x33, 0x32, 0x34, 0x32, 0x34, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x35, 0x2e, 0x35, 0x31, 0x31, 0x31, 0x30, 0x39, 0x39, 0x30, 0x33, 0x34,
-  0x35, 0x34, 0x37, 0x38, 0x30, 0x35, 0x37, 0x39, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x33, 0x2e, 0x31, 0x30, 0x33, 0x37, 0x35, 0x32, 0x34, 0x33,
-  0x34, 0x32, 0x35, 0x33, 0x36, 0x39, 0x32, 0x36, 0x32, 0x37, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x32, 0x2e, 0x33, 0x34, 0x38, 0x34, 0x37, 0x32, 0x33,
-  0x36, 0x34, 0x32, 0x34, 0x36, 0x38, 0x34, 0x35, 0x32, 0x34, 0x35, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x39, 0x33, 0x36, 0x35, 0x30,
-  0x39, 0x32, 0x30, 0x36, 0x38, 0x39, 0x31, 0x30, 0x35, 0x39, 0x38, 0x37,
-  0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x30, 0x32, 0x37,
-  0x36, 0x37, 0x30, 0x34, 0x30, 0x39, 0x35, 0x33, 0x30, 0x34, 0x30, 0x31,
-  0x32, 0x33, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x35, 0x36,
-  0x31, 0x39, 0x32, 0x33, 0x30, 0x32, 0x37, 0x30, 0x33, 0x38, 0x35, 0x37,
-  0x34, 0x32, 0x31, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e,
-  0x33, 0x31, 0x31, 0x33, 0x32, 0x31, 0x35, 0x38, 0x33, 0x35, 0x37, 0x36,
-  0x35, 0x30, 0x30, 0x34, 0x31, 0x36, 0x65, 0x2d, 0x30, 0x34, 0x0a, 0x36,
-  0x2e, 0x39, 0x36, 0x38, 0x34, 0x34, 0x37, 0x39, 0x33, 0x38, 0x35, 0x36,
-  0x31, 0x34, 0x33, 0x39, 0x35, 0x31, 0x34, 0x65, 0x2d, 0x30, 0x33, 0x0a,
-  0x2d, 0x38, 0x2e, 0x35, 0x37, 0x39, 0x36, 0x39, 0x37, 0x34, 0x35, 0x39,
-  0x39, 0x33, 0x36, 0x31, 0x34, 0x31, 0x39, 0x36, 0x38, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x34, 0x2e, 0x34, 0x34, 0x39, 0x36, 0x37, 0x37, 0x38, 0x33,
-  0x39, 0x38, 0x37, 0x35, 0x32, 0x32, 0x31, 0x32, 0x35, 0x32, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x38, 0x38, 0x30, 0x39, 0x36, 0x39,
-  0x38, 0x30, 0x37, 0x35, 0x30, 0x35, 0x36, 0x30, 0x37, 0x36, 0x30, 0x35,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x36, 0x36, 0x35, 0x30, 0x32,
-  0x39, 0x34, 0x32, 0x31, 0x34, 0x34, 0x38, 0x37, 0x30, 0x37, 0x35, 0x38,
-  0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x31, 0x30, 0x35, 0x37,
-  0x32, 0x33, 0x38, 0x31, 0x33, 0x31, 0x37, 0x36, 0x31, 0x35, 0x35, 0x30,
-  0x39, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x37, 0x33,
-  0x33, 0x38, 0x33, 0x30, 0x33, 0x31, 0x37, 0x38, 0x35, 0x34, 0x38, 0x38,
-  0x31, 0x32, 0x38, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e,
-  0x30, 0x31, 0x30, 0x37, 0x39, 0x37, 0x39, 0x39, 0x32, 0x33, 0x34, 0x38,
-  0x36, 0x37, 0x30, 0x39, 0x35, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x32, 0x2e, 0x32, 0x33, 0x37, 0x34, 0x37, 0x36, 0x32, 0x32, 0x32, 0x32,
-  0x31, 0x37, 0x30, 0x38, 0x32, 0x39, 0x37, 0x37, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x37, 0x2e, 0x38, 0x33, 0x37, 0x39, 0x37, 0x32, 0x30, 0x34, 0x34,
-  0x39, 0x34, 0x34, 0x37, 0x36, 0x33, 0x31, 0x38, 0x34, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x37, 0x2e, 0x31, 0x36, 0x31, 0x32, 0x31, 0x33, 0x34, 0x35,
-  0x37, 0x35, 0x38, 0x34, 0x33, 0x38, 0x31, 0x31, 0x30, 0x34, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x37, 0x2e, 0x31, 0x39, 0x31, 0x30, 0x31, 0x34, 0x32,
-  0x38, 0x39, 0x38, 0x35, 0x35, 0x39, 0x35, 0x37, 0x30, 0x33, 0x31, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x37, 0x32, 0x33, 0x39, 0x39, 0x33,
-  0x33, 0x31, 0x36, 0x32, 0x39, 0x32, 0x37, 0x36, 0x32, 0x37, 0x35, 0x36,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x31, 0x37, 0x39, 0x34, 0x36,
-  0x38, 0x38, 0x37, 0x30, 0x31, 0x36, 0x32, 0x39, 0x36, 0x33, 0x38, 0x36,
-  0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x32, 0x39, 0x34,
-  0x32, 0x38, 0x33, 0x38, 0x30, 0x37, 0x32, 0x37, 0x37, 0x36, 0x37, 0x39,
-  0x34, 0x34, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x39, 0x32,
-  0x38, 0x33, 0x35, 0x35, 0x30, 0x33, 0x38, 0x31, 0x36, 0x36, 0x30, 0x34,
-  0x36, 0x31, 0x34, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x38,
-  0x37, 0x38, 0x36, 0x37, 0x37, 0x32, 0x36, 0x33, 0x38, 0x35, 0x35, 0x39,
-  0x33, 0x34, 0x31, 0x34, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37,
-  0x2e, 0x36, 0x32, 0x37, 0x34, 0x34, 0x39, 0x39, 0x32, 0x39, 0x37, 0x31,
-  0x34, 0x32, 0x30, 0x32, 0x38, 0x38, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x36, 0x2e, 0x37, 0x34, 0x39, 0x34, 0x34, 0x33, 0x37, 0x30, 0x39, 0x38,
-  0x35, 0x30, 0x33, 0x31, 0x31, 0x32, 0x37, 0x39, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x36, 0x2e, 0x39, 0x39, 0x32, 0x31, 0x32, 0x31, 0x30, 0x34,
-  0x30, 0x38, 0x32, 0x31, 0x30, 0x37, 0x35, 0x34, 0x33, 0x39, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x39, 0x32, 0x33, 0x39, 0x36, 0x36,
-  0x33, 0x36, 0x33, 0x30, 0x37, 0x32, 0x33, 0x39, 0x35, 0x33, 0x32, 0x35,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x38, 0x39, 0x35, 0x30, 0x33,
-  0x35, 0x33, 0x38, 0x34, 0x32, 0x32, 0x32, 0x38, 0x36, 0x35, 0x31, 0x30,
-  0x35, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x33, 0x2e, 0x32, 0x32, 0x34,
-  0x33, 0x31, 0x31, 0x38, 0x36, 0x32, 0x31, 0x34, 0x30, 0x38, 0x39, 0x33,
-  0x39, 0x33, 0x36, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x31, 0x2e, 0x37,
-  0x30, 0x32, 0x39, 0x32, 0x36, 0x31, 0x32, 0x31, 0x36, 0x35, 0x32, 0x31,
-  0x32, 0x36, 0x33, 0x31, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e,
-  0x33, 0x32, 0x33, 0x30, 0x39, 0x38, 0x31, 0x38, 0x32, 0x36, 0x37, 0x38,
-  0x32, 0x32, 0x32, 0x36, 0x35, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31,
-  0x2e, 0x35, 0x35, 0x39, 0x33, 0x32, 0x36, 0x34, 0x32, 0x35, 0x31, 0x39,
-  0x34, 0x37, 0x34, 0x30, 0x32, 0x39, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x32, 0x2e, 0x30, 0x32, 0x37, 0x39, 0x30, 0x34, 0x34, 0x32, 0x38, 0x35,
-  0x34, 0x31, 0x36, 0x36, 0x30, 0x33, 0x30, 0x39, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x33, 0x2e, 0x34, 0x32, 0x35, 0x36, 0x32, 0x32, 0x33, 0x35,
-  0x38, 0x39, 0x31, 0x38, 0x31, 0x39, 0x30, 0x30, 0x30, 0x32, 0x65, 0x2d,
-  0x30, 0x33, 0x0a, 0x2d, 0x38, 0x2e, 0x31, 0x30, 0x33, 0x34, 0x36, 0x39,
-  0x30, 0x31, 0x34, 0x31, 0x36, 0x37, 0x37, 0x38, 0x35, 0x36, 0x34, 0x35,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x31, 0x33, 0x37, 0x37, 0x39,
-  0x39, 0x35, 0x31, 0x36, 0x33, 0x32, 0x30, 0x32, 0x32, 0x38, 0x35, 0x37,
-  0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x39, 0x2e, 0x32, 0x35, 0x35,
-  0x35, 0x34, 0x34, 0x38, 0x34, 0x31, 0x32, 0x38, 0x39, 0x35, 0x32, 0x30,
-  0x32, 0x36, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x31, 0x31,
-  0x34, 0x33, 0x34, 0x33, 0x35, 0x39, 0x38, 0x34, 0x38, 0x34, 0x39, 0x39,
-  0x32, 0x39, 0x38, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x34,
-  0x37, 0x37, 0x37, 0x34, 0x33, 0x32, 0x32, 0x33, 0x33, 0x30, 0x39, 0x35,
-  0x31, 0x36, 0x39, 0x30, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e,
-  0x39, 0x31, 0x30, 0x34, 0x37, 0x38, 0x31, 0x35, 0x39, 0x37, 0x38, 0x35,
-  0x32, 0x37, 0x30, 0x36, 0x39, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x37, 0x2e, 0x34, 0x37, 0x31, 0x34, 0x37, 0x35, 0x37, 0x35, 0x30, 0x32,
-  0x30, 0x37, 0x39, 0x30, 0x31, 0x30, 0x30, 0x31, 0x65, 0x2d, 0x30, 0x33,
-  0x0a, 0x2d, 0x35, 0x2e, 0x33, 0x30, 0x39, 0x33, 0x37, 0x38, 0x37, 0x32,
-  0x38, 0x32, 0x37, 0x30, 0x35, 0x33, 0x30, 0x37, 0x30, 0x31, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x36, 0x39, 0x34, 0x38, 0x32, 0x35,
-  0x38, 0x35, 0x30, 0x34, 0x32, 0x37, 0x31, 0x35, 0x30, 0x37, 0x32, 0x36,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x33, 0x36, 0x36, 0x34, 0x38,
-  0x39, 0x36, 0x31, 0x39, 0x30, 0x31, 0x36, 0x36, 0x34, 0x37, 0x33, 0x33,
-  0x39, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x35, 0x2e, 0x30, 0x36, 0x38,
-  0x37, 0x33, 0x38, 0x30, 0x31, 0x33, 0x35, 0x30, 0x35, 0x39, 0x33, 0x35,
-  0x36, 0x36, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x37,
-  0x33, 0x35, 0x30, 0x34, 0x30, 0x35, 0x30, 0x30, 0x37, 0x36, 0x30, 0x30,
-  0x37, 0x38, 0x34, 0x33, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e,
-  0x33, 0x33, 0x38, 0x37, 0x31, 0x33, 0x35, 0x32, 0x36, 0x37, 0x32, 0x35,
-  0x37, 0x36, 0x39, 0x30, 0x34, 0x33, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x32,
-  0x2e, 0x38, 0x34, 0x38, 0x38, 0x34, 0x31, 0x30, 0x36, 0x33, 0x36, 0x37,
-  0x38, 0x32, 0x36, 0x34, 0x36, 0x31, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x36, 0x2e, 0x39, 0x37, 0x31, 0x34, 0x36, 0x38, 0x30, 0x33, 0x31, 0x34,
-  0x30, 0x36, 0x34, 0x30, 0x32, 0x35, 0x38, 0x38, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x34, 0x2e, 0x39, 0x32, 0x32, 0x35, 0x36, 0x36, 0x39, 0x33,
-  0x35, 0x34, 0x32, 0x30, 0x30, 0x33, 0x36, 0x33, 0x31, 0x36, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x34, 0x35, 0x35, 0x34, 0x38, 0x38,
-  0x35, 0x34, 0x37, 0x36, 0x38, 0x32, 0x37, 0x36, 0x32, 0x31, 0x34, 0x36,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x33, 0x32, 0x30, 0x39,
-  0x38, 0x34, 0x36, 0x36, 0x31, 0x35, 0x37, 0x39, 0x31, 0x33, 0x32, 0x30,
-  0x38, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x39, 0x2e, 0x30, 0x31,
-  0x30, 0x32, 0x34, 0x34, 0x39, 0x30, 0x35, 0x39, 0x34, 0x38, 0x36, 0x33,
-  0x38, 0x39, 0x31, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e,
-  0x37, 0x30, 0x31, 0x38, 0x31, 0x30, 0x32, 0x34, 0x30, 0x37, 0x34, 0x35,
-  0x35, 0x34, 0x34, 0x34, 0x33, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x31, 0x2e, 0x31, 0x39, 0x34, 0x37, 0x36, 0x31, 0x34, 0x31, 0x34, 0x30,
-  0x38, 0x30, 0x38, 0x35, 0x38, 0x32, 0x33, 0x31, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x33, 0x2e, 0x33, 0x32, 0x32, 0x32, 0x30, 0x33, 0x38, 0x32, 0x39,
-  0x38, 0x38, 0x34, 0x35, 0x32, 0x39, 0x31, 0x31, 0x34, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x31, 0x2e, 0x31, 0x33, 0x39, 0x30, 0x35, 0x36, 0x30, 0x33,
-  0x30, 0x36, 0x36, 0x30, 0x38, 0x36, 0x37, 0x36, 0x39, 0x31, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x33, 0x2e, 0x31, 0x35, 0x36, 0x38, 0x32, 0x35, 0x31,
-  0x35, 0x35, 0x30, 0x31, 0x39, 0x37, 0x36, 0x30, 0x31, 0x33, 0x32, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x32, 0x39, 0x33, 0x35, 0x32,
-  0x35, 0x39, 0x31, 0x39, 0x33, 0x31, 0x38, 0x31, 0x39, 0x39, 0x31, 0x35,
-  0x38, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x34, 0x2e, 0x38, 0x38, 0x33,
-  0x30, 0x39, 0x36, 0x37, 0x33, 0x39, 0x36, 0x34, 0x39, 0x37, 0x37, 0x32,
-  0x36, 0x34, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x32, 0x34,
-  0x31, 0x39, 0x39, 0x35, 0x37, 0x32, 0x32, 0x30, 0x35, 0x35, 0x34, 0x33,
-  0x35, 0x31, 0x38, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e,
-  0x34, 0x37, 0x37, 0x39, 0x32, 0x38, 0x36, 0x34, 0x35, 0x39, 0x30, 0x38,
-  0x38, 0x33, 0x32, 0x35, 0x35, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x38, 0x2e, 0x30, 0x37, 0x38, 0x30, 0x35, 0x38, 0x38, 0x30, 0x39, 0x30,
-  0x34, 0x31, 0x39, 0x37, 0x36, 0x39, 0x32, 0x39, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x31, 0x2e, 0x33, 0x35, 0x31, 0x38, 0x38, 0x38, 0x34, 0x37,
-  0x37, 0x38, 0x30, 0x32, 0x32, 0x37, 0x36, 0x36, 0x31, 0x31, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x38, 0x2e, 0x35, 0x30, 0x33, 0x31, 0x31, 0x38,
-  0x39, 0x30, 0x32, 0x34, 0x34, 0x34, 0x38, 0x33, 0x39, 0x34, 0x37, 0x38,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x37, 0x39, 0x39, 0x31,
-  0x33, 0x36, 0x32, 0x36, 0x32, 0x33, 0x38, 0x37, 0x30, 0x33, 0x37, 0x32,
-  0x37, 0x37, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x33, 0x2e, 0x32, 0x39,
-  0x37, 0x37, 0x34, 0x33, 0x35, 0x37, 0x33, 0x37, 0x38, 0x34, 0x38, 0x32,
-  0x38, 0x31, 0x38, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e,
-  0x33, 0x38, 0x36, 0x30, 0x30, 0x30, 0x37, 0x30, 0x37, 0x37, 0x34, 0x35,
-  0x35, 0x35, 0x32, 0x30, 0x36, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32,
-  0x2e, 0x32, 0x39, 0x35, 0x36, 0x37, 0x39, 0x30, 0x34, 0x30, 0x32, 0x35,
-  0x33, 0x31, 0x36, 0x32, 0x33, 0x38, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x35, 0x2e, 0x39, 0x31, 0x31, 0x36, 0x35, 0x39, 0x38, 0x32, 0x31,
-  0x38, 0x36, 0x37, 0x39, 0x34, 0x32, 0x38, 0x31, 0x30, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x36, 0x2e, 0x37, 0x32, 0x35, 0x32, 0x39, 0x30, 0x34, 0x31,
-  0x37, 0x36, 0x37, 0x31, 0x32, 0x30, 0x33, 0x36, 0x31, 0x33, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x37, 0x38, 0x33, 0x38, 0x31, 0x35,
-  0x37, 0x34, 0x38, 0x39, 0x38, 0x39, 0x35, 0x38, 0x32, 0x30, 0x36, 0x32,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x36, 0x39, 0x38, 0x31, 0x37,
-  0x32, 0x39, 0x35, 0x36, 0x37, 0x30, 0x35, 0x30, 0x39, 0x33, 0x33, 0x38,
-  0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x37, 0x36, 0x37, 0x37,
-  0x38, 0x38, 0x33, 0x36, 0x35, 0x34, 0x38, 0x33, 0x32, 0x38, 0x33, 0x39,
-  0x39, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x34, 0x39, 0x32,
-  0x33, 0x34, 0x31, 0x33, 0x35, 0x34, 0x34, 0x38, 0x39, 0x33, 0x32, 0x36,
-  0x34, 0x37, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x37, 0x30,
-  0x37, 0x34, 0x32, 0x38, 0x31, 0x33, 0x34, 0x39, 0x37, 0x37, 0x38, 0x31,
-  0x37, 0x35, 0x33, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e,
-  0x38, 0x33, 0x31, 0x33, 0x36, 0x30, 0x33, 0x39, 0x39, 0x37, 0x32, 0x33,
-  0x30, 0x35, 0x32, 0x39, 0x37, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33,
-  0x2e, 0x33, 0x34, 0x32, 0x38, 0x30, 0x39, 0x31, 0x35, 0x35, 0x35, 0x38,
-  0x33, 0x33, 0x38, 0x31, 0x36, 0x35, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x34, 0x2e, 0x31, 0x30, 0x37, 0x39, 0x33, 0x33, 0x34, 0x39, 0x31, 0x34,
-  0x36, 0x38, 0x34, 0x32, 0x39, 0x35, 0x36, 0x35, 0x65, 0x2d, 0x30, 0x33,
-  0x0a, 0x37, 0x2e, 0x39, 0x32, 0x35, 0x34, 0x34, 0x33, 0x33, 0x35, 0x31,
-  0x32, 0x36, 0x38, 0x37, 0x36, 0x38, 0x33, 0x31, 0x31, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x31, 0x2e, 0x33, 0x38, 0x31, 0x30, 0x30, 0x34, 0x33, 0x32,
-  0x32, 0x33, 0x32, 0x30, 0x32, 0x32, 0x32, 0x38, 0x35, 0x35, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x36, 0x2e, 0x39, 0x32, 0x31, 0x33, 0x38, 0x30, 0x37,
-  0x35, 0x38, 0x32, 0x38, 0x35, 0x35, 0x32, 0x32, 0x34, 0x36, 0x31, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x30, 0x37, 0x37, 0x31, 0x32, 0x30,
-  0x32, 0x34, 0x34, 0x35, 0x30, 0x33, 0x30, 0x32, 0x31, 0x32, 0x34, 0x30,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x37, 0x34, 0x36, 0x39, 0x35,
-  0x38, 0x30, 0x33, 0x32, 0x32, 0x35, 0x30, 0x34, 0x30, 0x34, 0x33, 0x35,
-  0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x30, 0x31, 0x30,
-  0x33, 0x38, 0x32, 0x37, 0x31, 0x31, 0x38, 0x38, 0x37, 0x33, 0x35, 0x39,
-  0x36, 0x31, 0x39, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x33, 0x2e, 0x31, 0x36,
-  0x31, 0x30, 0x32, 0x32, 0x34, 0x33, 0x39, 0x35, 0x39, 0x39, 0x30, 0x33,
-  0x37, 0x31, 0x37, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x32,
-  0x30, 0x32, 0x39, 0x38, 0x34, 0x36, 0x34, 0x35, 0x39, 0x36, 0x32, 0x37,
-  0x31, 0x35, 0x31, 0x34, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e,
-  0x33, 0x35, 0x39, 0x34, 0x33, 0x34, 0x39, 0x31, 0x37, 0x35, 0x36, 0x39,
-  0x31, 0x36, 0x30, 0x34, 0x36, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x35, 0x2e, 0x33, 0x31, 0x30, 0x39, 0x34, 0x35, 0x39, 0x35, 0x37, 0x38,
-  0x39, 0x39, 0x30, 0x39, 0x33, 0x36, 0x32, 0x38, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x31, 0x2e, 0x32, 0x34, 0x30, 0x38, 0x30, 0x37, 0x31, 0x37,
-  0x35, 0x36, 0x33, 0x36, 0x32, 0x39, 0x31, 0x35, 0x30, 0x34, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e, 0x33, 0x32, 0x37, 0x34, 0x30, 0x34,
-  0x30, 0x32, 0x32, 0x32, 0x31, 0x36, 0x37, 0x39, 0x36, 0x38, 0x37, 0x35,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x33, 0x2e, 0x37, 0x31, 0x34, 0x36,
-  0x34, 0x31, 0x36, 0x33, 0x30, 0x36, 0x34, 0x39, 0x35, 0x36, 0x36, 0x36,
-  0x35, 0x30, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x38, 0x31,
-  0x30, 0x32, 0x32, 0x35, 0x36, 0x39, 0x35, 0x33, 0x37, 0x31, 0x36, 0x32,
-  0x37, 0x38, 0x30, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e,
-  0x30, 0x37, 0x38, 0x31, 0x30, 0x37, 0x33, 0x37, 0x31, 0x39, 0x32, 0x36,
-  0x33, 0x30, 0x37, 0x36, 0x37, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x39, 0x2e, 0x31, 0x36, 0x38, 0x37, 0x36, 0x34, 0x39, 0x34, 0x38, 0x38,
-  0x34, 0x34, 0x39, 0x30, 0x39, 0x36, 0x36, 0x38, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x38, 0x2e, 0x34, 0x30, 0x34, 0x37, 0x36, 0x33, 0x30, 0x34,
-  0x32, 0x39, 0x32, 0x36, 0x37, 0x38, 0x38, 0x33, 0x33, 0x30, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x38, 0x38, 0x37, 0x37, 0x36, 0x33,
-  0x37, 0x38, 0x33, 0x33, 0x33, 0x35, 0x36, 0x38, 0x35, 0x37, 0x33, 0x30,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x39, 0x2e, 0x32, 0x33, 0x37, 0x39, 0x39,
-  0x32, 0x35, 0x37, 0x37, 0x32, 0x35, 0x34, 0x37, 0x37, 0x32, 0x31, 0x38,
-  0x36, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x36, 0x2e, 0x32, 0x31, 0x39,
-  0x33, 0x30, 0x39, 0x39, 0x34, 0x30, 0x39, 0x33, 0x34, 0x31, 0x38, 0x31,
-  0x32, 0x31, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x30,
-  0x35, 0x32, 0x33, 0x37, 0x30, 0x33, 0x36, 0x39, 0x34, 0x33, 0x34, 0x33,
-  0x35, 0x36, 0x36, 0x38, 0x39, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x35,
-  0x2e, 0x31, 0x38, 0x32, 0x31, 0x37, 0x31, 0x36, 0x31, 0x32, 0x39, 0x37,
-  0x37, 0x39, 0x38, 0x31, 0x35, 0x36, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x33, 0x2e, 0x30, 0x39, 0x37, 0x37, 0x38, 0x34, 0x38, 0x39, 0x31,
-  0x37, 0x32, 0x34, 0x35, 0x38, 0x36, 0x34, 0x38, 0x37, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x36, 0x2e, 0x32, 0x34, 0x36, 0x32, 0x39, 0x32, 0x35, 0x39,
-  0x31, 0x30, 0x39, 0x34, 0x39, 0x37, 0x30, 0x37, 0x30, 0x33, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x32, 0x2e, 0x39, 0x33, 0x39, 0x32, 0x38, 0x38, 0x35,
-  0x30, 0x34, 0x34, 0x32, 0x31, 0x37, 0x31, 0x30, 0x39, 0x36, 0x38, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x33, 0x38, 0x32, 0x38, 0x39, 0x35,
-  0x32, 0x37, 0x39, 0x36, 0x37, 0x35, 0x37, 0x32, 0x32, 0x31, 0x32, 0x32,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x35, 0x32, 0x37, 0x35,
-  0x32, 0x32, 0x32, 0x30, 0x36, 0x33, 0x30, 0x36, 0x34, 0x35, 0x37, 0x35,
-  0x32, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x39, 0x38, 0x37,
-  0x38, 0x38, 0x33, 0x39, 0x34, 0x30, 0x33, 0x33, 0x39, 0x30, 0x38, 0x38,
-  0x34, 0x34, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x39,
-  0x35, 0x33, 0x36, 0x39, 0x38, 0x32, 0x33, 0x32, 0x37, 0x36, 0x39, 0x39,
-  0x36, 0x36, 0x31, 0x32, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37,
-  0x2e, 0x37, 0x32, 0x35, 0x32, 0x39, 0x32, 0x34, 0x34, 0x34, 0x32, 0x32,
-  0x39, 0x31, 0x32, 0x35, 0x39, 0x37, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x36, 0x2e, 0x30, 0x34, 0x39, 0x35, 0x32, 0x30, 0x31, 0x34, 0x39, 0x38,
-  0x32, 0x37, 0x30, 0x30, 0x33, 0x34, 0x37, 0x39, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x34, 0x2e, 0x36, 0x36, 0x32, 0x35, 0x34, 0x32, 0x34, 0x31, 0x37,
-  0x36, 0x34, 0x35, 0x34, 0x35, 0x34, 0x34, 0x30, 0x37, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x37, 0x2e, 0x37, 0x30, 0x32, 0x39, 0x37, 0x31, 0x39, 0x39,
-  0x34, 0x38, 0x37, 0x36, 0x38, 0x36, 0x31, 0x35, 0x37, 0x32, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x32, 0x2e, 0x32, 0x36, 0x33, 0x35, 0x37, 0x30, 0x37,
-  0x36, 0x33, 0x31, 0x37, 0x30, 0x37, 0x31, 0x39, 0x31, 0x34, 0x37, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x36, 0x31, 0x34, 0x34, 0x37, 0x38,
-  0x34, 0x36, 0x38, 0x38, 0x39, 0x34, 0x39, 0x35, 0x38, 0x34, 0x39, 0x36,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x34, 0x37, 0x39, 0x33, 0x37,
-  0x33, 0x31, 0x30, 0x34, 0x38, 0x37, 0x30, 0x33, 0x31, 0x39, 0x33, 0x36,
-  0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x33, 0x37, 0x33, 0x38,
-  0x39, 0x37, 0x39, 0x38, 0x34, 0x36, 0x32, 0x33, 0x39, 0x30, 0x38, 0x39,
-  0x39, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x36, 0x37,
-  0x30, 0x37, 0x33, 0x38, 0x34, 0x30, 0x36, 0x34, 0x37, 0x39, 0x33, 0x35,
-  0x38, 0x36, 0x37, 0x33, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x31, 0x2e,
-  0x36, 0x33, 0x38, 0x32, 0x34, 0x31, 0x38, 0x35, 0x37, 0x32, 0x39, 0x30,
-  0x32, 0x36, 0x37, 0x39, 0x34, 0x34, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d,
-  0x34, 0x2e, 0x34, 0x35, 0x34, 0x36, 0x38, 0x39, 0x39, 0x31, 0x39, 0x39,
-  0x34, 0x38, 0x35, 0x37, 0x37, 0x38, 0x38, 0x31, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x2d, 0x35, 0x2e, 0x35, 0x38, 0x30, 0x32, 0x37, 0x30, 0x32, 0x39,
-  0x30, 0x33, 0x37, 0x34, 0x37, 0x35, 0x35, 0x38, 0x35, 0x39, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x33, 0x2e, 0x39, 0x38, 0x33, 0x39, 0x32, 0x39,
-  0x31, 0x35, 0x37, 0x32, 0x35, 0x37, 0x30, 0x38, 0x30, 0x30, 0x37, 0x38,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e, 0x36, 0x35, 0x35, 0x30,
-  0x37, 0x30, 0x31, 0x32, 0x36, 0x30, 0x35, 0x36, 0x36, 0x37, 0x31, 0x31,
-  0x34, 0x33, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x34, 0x35,
-  0x36, 0x38, 0x37, 0x37, 0x32, 0x39, 0x31, 0x32, 0x30, 0x32, 0x35, 0x34,
-  0x35, 0x31, 0x36, 0x36, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x37, 0x2e,
-  0x35, 0x39, 0x38, 0x39, 0x38, 0x34, 0x39, 0x38, 0x36, 0x35, 0x34, 0x33,
-  0x36, 0x35, 0x35, 0x33, 0x39, 0x36, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x34,
-  0x2e, 0x32, 0x35, 0x31, 0x34, 0x34, 0x37, 0x36, 0x39, 0x32, 0x35, 0x31,
-  0x33, 0x34, 0x36, 0x35, 0x38, 0x38, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x36, 0x2e, 0x32, 0x33, 0x35, 0x32, 0x38, 0x32, 0x31, 0x32, 0x33, 0x30,
-  0x38, 0x38, 0x38, 0x33, 0x36, 0x36, 0x37, 0x30, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x31, 0x2e, 0x35, 0x30, 0x35, 0x36, 0x30, 0x38, 0x31, 0x31, 0x31,
-  0x36, 0x31, 0x39, 0x39, 0x34, 0x39, 0x33, 0x34, 0x31, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x31, 0x2e, 0x33, 0x32, 0x34, 0x33, 0x38, 0x35, 0x38, 0x37,
-  0x30, 0x32, 0x34, 0x38, 0x30, 0x37, 0x39, 0x33, 0x30, 0x30, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x35, 0x38, 0x37, 0x37, 0x36, 0x37,
-  0x39, 0x32, 0x38, 0x38, 0x33, 0x38, 0x37, 0x32, 0x39, 0x38, 0x35, 0x38,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x33, 0x39, 0x36, 0x32,
-  0x35, 0x37, 0x34, 0x36, 0x30, 0x31, 0x31, 0x37, 0x33, 0x34, 0x30, 0x30,
-  0x38, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x32, 0x38,
-  0x33, 0x30, 0x32, 0x38, 0x32, 0x35, 0x39, 0x38, 0x37, 0x33, 0x33, 0x39,
-  0x30, 0x31, 0x39, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x33,
-  0x38, 0x32, 0x33, 0x36, 0x36, 0x38, 0x35, 0x30, 0x39, 0x37, 0x32, 0x31,
-  0x37, 0x35, 0x35, 0x39, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36,
-  0x2e, 0x32, 0x32, 0x34, 0x37, 0x39, 0x33, 0x35, 0x36, 0x38, 0x32, 0x35,
-  0x33, 0x35, 0x31, 0x37, 0x31, 0x35, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x35, 0x2e, 0x32, 0x38, 0x38, 0x37, 0x39, 0x33, 0x35, 0x31, 0x39,
-  0x31, 0x33, 0x39, 0x32, 0x38, 0x39, 0x38, 0x35, 0x36, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x35, 0x32, 0x37, 0x34, 0x31, 0x32, 0x35,
-  0x38, 0x35, 0x39, 0x31, 0x34, 0x31, 0x33, 0x34, 0x39, 0x37, 0x39, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x30, 0x31, 0x36, 0x38, 0x35, 0x31,
-  0x32, 0x33, 0x35, 0x31, 0x38, 0x31, 0x30, 0x39, 0x33, 0x32, 0x31, 0x36,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x36, 0x32, 0x33, 0x39, 0x33,
-  0x33, 0x35, 0x30, 0x38, 0x39, 0x39, 0x32, 0x31, 0x39, 0x35, 0x31, 0x32,
-  0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x32, 0x39, 0x31,
-  0x37, 0x38, 0x37, 0x33, 0x32, 0x36, 0x33, 0x33, 0x35, 0x39, 0x30, 0x36,
-  0x39, 0x38, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x37, 0x37,
-  0x31, 0x33, 0x33, 0x33, 0x33, 0x35, 0x31, 0x37, 0x33, 0x31, 0x33, 0x30,
-  0x30, 0x33, 0x35, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x32,
-  0x31, 0x30, 0x35, 0x35, 0x37, 0x34, 0x31, 0x36, 0x30, 0x38, 0x31, 0x34,
-  0x32, 0x38, 0x35, 0x32, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e,
-  0x39, 0x36, 0x39, 0x35, 0x30, 0x37, 0x38, 0x32, 0x38, 0x33, 0x35, 0x34,
-  0x38, 0x33, 0x35, 0x35, 0x31, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x35, 0x2e, 0x33, 0x32, 0x34, 0x34, 0x37, 0x33, 0x39, 0x37, 0x37, 0x30,
-  0x38, 0x38, 0x39, 0x32, 0x38, 0x32, 0x32, 0x33, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x31, 0x2e, 0x34, 0x30, 0x33, 0x37, 0x35, 0x36, 0x32, 0x39,
-  0x30, 0x36, 0x37, 0x34, 0x32, 0x30, 0x39, 0x35, 0x39, 0x35, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x31, 0x34, 0x34, 0x30, 0x36, 0x39,
-  0x30, 0x36, 0x30, 0x36, 0x38, 0x33, 0x32, 0x35, 0x30, 0x34, 0x32, 0x37,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x34, 0x31, 0x32, 0x31,
-  0x35, 0x32, 0x36, 0x34, 0x37, 0x39, 0x37, 0x32, 0x31, 0x30, 0x36, 0x39,
-  0x33, 0x34, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e, 0x33, 0x35,
-  0x32, 0x37, 0x37, 0x37, 0x32, 0x37, 0x32, 0x34, 0x36, 0x32, 0x38, 0x34,
-  0x34, 0x38, 0x34, 0x39, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x33, 0x2e,
-  0x31, 0x34, 0x38, 0x36, 0x38, 0x37, 0x31, 0x38, 0x33, 0x38, 0x35, 0x36,
-  0x39, 0x36, 0x34, 0x31, 0x31, 0x31, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d,
-  0x36, 0x2e, 0x34, 0x34, 0x35, 0x38, 0x36, 0x38, 0x30, 0x31, 0x35, 0x32,
-  0x38, 0x39, 0x33, 0x30, 0x36, 0x36, 0x34, 0x31, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x2d, 0x35, 0x2e, 0x38, 0x39, 0x33, 0x37, 0x36, 0x30, 0x33, 0x32,
-  0x33, 0x35, 0x32, 0x34, 0x34, 0x37, 0x35, 0x30, 0x39, 0x38, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x34, 0x2e, 0x38, 0x32, 0x34, 0x34, 0x37, 0x33,
-  0x38, 0x35, 0x37, 0x38, 0x37, 0x39, 0x36, 0x33, 0x38, 0x36, 0x37, 0x32,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e, 0x30, 0x37, 0x36, 0x36,
-  0x30, 0x34, 0x39, 0x36, 0x32, 0x33, 0x34, 0x38, 0x39, 0x33, 0x37, 0x39,
-  0x38, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x39, 0x2e, 0x30, 0x34, 0x30,
-  0x34, 0x31, 0x31, 0x35, 0x36, 0x31, 0x37, 0x32, 0x37, 0x35, 0x32, 0x33,
-  0x38, 0x30, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x31,
-  0x35, 0x33, 0x39, 0x35, 0x38, 0x34, 0x30, 0x32, 0x35, 0x37, 0x34, 0x30,
-  0x36, 0x32, 0x33, 0x34, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e,
-  0x38, 0x35, 0x36, 0x36, 0x30, 0x34, 0x35, 0x30, 0x31, 0x36, 0x30, 0x35,
-  0x30, 0x33, 0x33, 0x38, 0x37, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x33, 0x2e, 0x36, 0x36, 0x35, 0x39, 0x39, 0x31, 0x31, 0x32, 0x37, 0x34,
-  0x39, 0x30, 0x39, 0x39, 0x37, 0x33, 0x31, 0x34, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x32, 0x2e, 0x33, 0x38, 0x31, 0x33, 0x31, 0x37, 0x33, 0x31,
-  0x37, 0x34, 0x38, 0x35, 0x38, 0x30, 0x39, 0x33, 0x32, 0x36, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x36, 0x31, 0x39, 0x30, 0x31, 0x37,
-  0x31, 0x35, 0x33, 0x39, 0x37, 0x38, 0x33, 0x34, 0x37, 0x37, 0x37, 0x38,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x38, 0x33, 0x31, 0x34, 0x37,
-  0x38, 0x38, 0x31, 0x31, 0x38, 0x30, 0x30, 0x34, 0x37, 0x39, 0x38, 0x38,
-  0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x33, 0x33, 0x37,
-  0x38, 0x33, 0x35, 0x36, 0x33, 0x39, 0x37, 0x31, 0x35, 0x31, 0x39, 0x34,
-  0x37, 0x30, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x34,
-  0x38, 0x34, 0x30, 0x35, 0x38, 0x32, 0x33, 0x38, 0x35, 0x36, 0x35, 0x39,
-  0x32, 0x31, 0x37, 0x38, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33,
-  0x2e, 0x39, 0x37, 0x37, 0x38, 0x35, 0x30, 0x34, 0x35, 0x32, 0x30, 0x36,
-  0x35, 0x34, 0x36, 0x37, 0x38, 0x33, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x36, 0x2e, 0x38, 0x37, 0x38, 0x36, 0x31, 0x38, 0x38, 0x39, 0x36,
-  0x30, 0x30, 0x37, 0x35, 0x33, 0x37, 0x38, 0x34, 0x32, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x38, 0x30, 0x31, 0x31, 0x35, 0x38, 0x36,
-  0x37, 0x34, 0x30, 0x36, 0x31, 0x32, 0x39, 0x38, 0x33, 0x37, 0x30, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x37, 0x36, 0x36, 0x31, 0x33,
-  0x31, 0x33, 0x35, 0x36, 0x33, 0x35, 0x38, 0x35, 0x32, 0x38, 0x31, 0x33,
-  0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x33, 0x30, 0x30, 0x39,
-  0x31, 0x36, 0x31, 0x36, 0x38, 0x38, 0x33, 0x38, 0x37, 0x33, 0x39, 0x33,
-  0x39, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x33, 0x39,
-  0x39, 0x37, 0x38, 0x36, 0x34, 0x39, 0x30, 0x39, 0x34, 0x37, 0x30, 0x30,
-  0x38, 0x31, 0x33, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e,
-  0x35, 0x35, 0x36, 0x35, 0x36, 0x32, 0x31, 0x32, 0x35, 0x36, 0x38, 0x32,
-  0x38, 0x33, 0x30, 0x38, 0x31, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x38,
-  0x2e, 0x38, 0x37, 0x34, 0x36, 0x34, 0x32, 0x36, 0x36, 0x32, 0x37, 0x30,
-  0x33, 0x39, 0x39, 0x30, 0x39, 0x33, 0x36, 0x65, 0x2d, 0x30, 0x33, 0x0a,
-  0x32, 0x2e, 0x33, 0x39, 0x34, 0x30, 0x38, 0x35, 0x35, 0x36, 0x33, 0x37,
-  0x31, 0x39, 0x32, 0x37, 0x32, 0x36, 0x31, 0x34, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x38, 0x2e, 0x32, 0x37, 0x37, 0x35, 0x37, 0x35, 0x36, 0x37,
-  0x31, 0x36, 0x37, 0x32, 0x38, 0x32, 0x31, 0x30, 0x34, 0x35, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x38, 0x34, 0x39, 0x38, 0x35, 0x39,
-  0x35, 0x30, 0x35, 0x38, 0x39, 0x31, 0x37, 0x39, 0x39, 0x39, 0x32, 0x37,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x37, 0x2e, 0x32, 0x32, 0x33, 0x37,
-  0x39, 0x36, 0x38, 0x34, 0x34, 0x34, 0x38, 0x32, 0x34, 0x32, 0x31, 0x38,
-  0x37, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x32, 0x30, 0x35,
-  0x35, 0x35, 0x31, 0x35, 0x33, 0x34, 0x38, 0x39, 0x31, 0x31, 0x32, 0x38,
-  0x35, 0x34, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x34,
-  0x37, 0x30, 0x34, 0x38, 0x37, 0x30, 0x35, 0x38, 0x31, 0x36, 0x32, 0x36,
-  0x38, 0x39, 0x32, 0x30, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x32,
-  0x2e, 0x30, 0x30, 0x31, 0x37, 0x39, 0x35, 0x37, 0x36, 0x38, 0x37, 0x33,
-  0x37, 0x37, 0x39, 0x32, 0x39, 0x36, 0x39, 0x65, 0x2d, 0x30, 0x31, 0x0a,
-  0x2d, 0x32, 0x2e, 0x38, 0x33, 0x38, 0x33, 0x36, 0x32, 0x34, 0x35, 0x35,
-  0x33, 0x36, 0x38, 0x30, 0x34, 0x31, 0x39, 0x39, 0x32, 0x65, 0x2d, 0x30,
-  0x31, 0x0a, 0x2d, 0x33, 0x2e, 0x38, 0x36, 0x39, 0x38, 0x31, 0x36, 0x30,
-  0x36, 0x34, 0x38, 0x33, 0x34, 0x35, 0x39, 0x34, 0x37, 0x32, 0x37, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x33, 0x2e, 0x31, 0x38, 0x39, 0x39, 0x34,
-  0x34, 0x36, 0x32, 0x34, 0x39, 0x30, 0x30, 0x38, 0x31, 0x37, 0x38, 0x37,
-  0x31, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x35, 0x2e, 0x30, 0x38, 0x32, 0x34,
-  0x36, 0x38, 0x33, 0x31, 0x35, 0x39, 0x35, 0x38, 0x39, 0x37, 0x36, 0x37,
-  0x34, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x30, 0x30, 0x33,
-  0x30, 0x33, 0x34, 0x36, 0x35, 0x31, 0x32, 0x37, 0x39, 0x34, 0x34, 0x39,
-  0x34, 0x36, 0x33, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x39, 0x36,
-  0x39, 0x34, 0x32, 0x33, 0x34, 0x34, 0x33, 0x30, 0x37, 0x38, 0x39, 0x39,
-  0x34, 0x37, 0x35, 0x31, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x34, 0x2e,
-  0x33, 0x37, 0x33, 0x39, 0x32, 0x34, 0x30, 0x36, 0x31, 0x36, 0x35, 0x35,
-  0x39, 0x39, 0x38, 0x32, 0x33, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x31, 0x2e, 0x31, 0x34, 0x37, 0x33, 0x30, 0x38, 0x37, 0x32, 0x32, 0x31,
-  0x33, 0x38, 0x34, 0x30, 0x34, 0x38, 0x34, 0x36, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x2d, 0x38, 0x2e, 0x39, 0x34, 0x32, 0x33, 0x37, 0x38, 0x33, 0x31,
-  0x32, 0x33, 0x34, 0x39, 0x33, 0x31, 0x39, 0x34, 0x35, 0x38, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x37, 0x2e, 0x38, 0x32, 0x38, 0x30, 0x35, 0x33, 0x38,
-  0x33, 0x32, 0x30, 0x35, 0x34, 0x31, 0x33, 0x38, 0x31, 0x38, 0x34, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x37, 0x36, 0x33, 0x39, 0x36,
-  0x32, 0x37, 0x30, 0x30, 0x39, 0x36, 0x33, 0x30, 0x32, 0x30, 0x33, 0x32,
-  0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x30, 0x34, 0x37, 0x37,
-  0x31, 0x32, 0x38, 0x34, 0x33, 0x38, 0x36, 0x35, 0x31, 0x35, 0x36, 0x31,
-  0x37, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x35, 0x31,
-  0x32, 0x31, 0x31, 0x35, 0x34, 0x37, 0x38, 0x35, 0x31, 0x35, 0x36, 0x32,
-  0x35, 0x30, 0x30, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x39, 0x2e,
-  0x32, 0x34, 0x30, 0x38, 0x36, 0x38, 0x36, 0x38, 0x37, 0x36, 0x32, 0x39,
-  0x36, 0x39, 0x39, 0x37, 0x30, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36,
-  0x2e, 0x35, 0x31, 0x38, 0x39, 0x30, 0x36, 0x33, 0x35, 0x34, 0x39, 0x30,
-  0x34, 0x31, 0x37, 0x34, 0x38, 0x30, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x34, 0x2e, 0x34, 0x35, 0x31, 0x34, 0x33, 0x34, 0x36, 0x38, 0x36, 0x37,
-  0x37, 0x39, 0x39, 0x37, 0x35, 0x38, 0x39, 0x31, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x33, 0x2e, 0x33, 0x32, 0x39, 0x38, 0x35, 0x33, 0x33, 0x34,
-  0x30, 0x39, 0x38, 0x33, 0x33, 0x39, 0x30, 0x38, 0x30, 0x38, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x32, 0x33, 0x36, 0x35, 0x30, 0x36,
-  0x30, 0x38, 0x39, 0x35, 0x36, 0x38, 0x31, 0x33, 0x38, 0x31, 0x32, 0x33,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x32, 0x36, 0x31, 0x37, 0x34,
-  0x32, 0x36, 0x37, 0x33, 0x38, 0x31, 0x34, 0x32, 0x39, 0x36, 0x37, 0x32,
-  0x32, 0x65, 0x2d, 0x30, 0x34, 0x0a, 0x2d, 0x36, 0x2e, 0x36, 0x34, 0x37,
-  0x33, 0x33, 0x39, 0x34, 0x36, 0x33, 0x32, 0x33, 0x33, 0x39, 0x34, 0x37,
-  0x37, 0x35, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x30,
-  0x36, 0x30, 0x38, 0x35, 0x38, 0x34, 0x32, 0x31, 0x30, 0x32, 0x37, 0x36,
-  0x36, 0x30, 0x33, 0x37, 0x30, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x34,
-  0x2e, 0x34, 0x35, 0x30, 0x33, 0x39, 0x31, 0x36, 0x30, 0x35, 0x34, 0x39,
-  0x36, 0x34, 0x30, 0x36, 0x35, 0x35, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x37, 0x2e, 0x30, 0x36, 0x30, 0x39, 0x37, 0x31, 0x38, 0x35, 0x36, 0x31,
-  0x31, 0x37, 0x32, 0x34, 0x38, 0x35, 0x33, 0x35, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x31, 0x2e, 0x31, 0x30, 0x30, 0x31, 0x38, 0x31, 0x31, 0x31,
-  0x37, 0x36, 0x35, 0x33, 0x38, 0x34, 0x36, 0x37, 0x34, 0x31, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x36, 0x34, 0x33, 0x30, 0x30, 0x38,
-  0x37, 0x33, 0x38, 0x37, 0x35, 0x36, 0x31, 0x37, 0x39, 0x38, 0x31, 0x30,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x38, 0x2e, 0x33, 0x32, 0x33, 0x37, 0x34,
-  0x39, 0x38, 0x39, 0x39, 0x38, 0x36, 0x34, 0x31, 0x39, 0x36, 0x37, 0x37,
-  0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x35, 0x32, 0x36,
-  0x37, 0x34, 0x33, 0x36, 0x32, 0x30, 0x36, 0x33, 0x34, 0x30, 0x37, 0x38,
-  0x39, 0x37, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x30,
-  0x36, 0x35, 0x32, 0x35, 0x31, 0x31, 0x35, 0x36, 0x36, 0x38, 0x37, 0x37,
-  0x33, 0x36, 0x35, 0x31, 0x31, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x39, 0x2e,
-  0x30, 0x35, 0x31, 0x38, 0x35, 0x38, 0x36, 0x33, 0x33, 0x37, 0x35, 0x36,
-  0x36, 0x33, 0x37, 0x35, 0x37, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32,
-  0x2e, 0x30, 0x33, 0x31, 0x34, 0x31, 0x31, 0x30, 0x38, 0x31, 0x35, 0x35,
-  0x32, 0x35, 0x30, 0x35, 0x34, 0x39, 0x33, 0x65, 0x2d, 0x30, 0x31, 0x0a,
-  0x32, 0x2e, 0x33, 0x38, 0x36, 0x36, 0x30, 0x37, 0x32, 0x32, 0x39, 0x37,
-  0x30, 0x39, 0x36, 0x32, 0x35, 0x32, 0x34, 0x34, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x32, 0x2e, 0x39, 0x38, 0x31, 0x38, 0x32, 0x38, 0x31, 0x35, 0x33,
-  0x31, 0x33, 0x33, 0x33, 0x39, 0x32, 0x33, 0x33, 0x34, 0x65, 0x2d, 0x30,
-  0x31, 0x0a, 0x34, 0x2e, 0x30, 0x34, 0x33, 0x31, 0x32, 0x37, 0x35, 0x39,
-  0x36, 0x33, 0x37, 0x38, 0x33, 0x32, 0x36, 0x34, 0x31, 0x36, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x33, 0x2e, 0x31, 0x38, 0x36, 0x34, 0x39, 0x35, 0x33,
-  0x30, 0x34, 0x31, 0x30, 0x37, 0x36, 0x36, 0x36, 0x30, 0x31, 0x36, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x33, 0x32, 0x35, 0x38, 0x30, 0x36,
-  0x33, 0x37, 0x39, 0x33, 0x31, 0x38, 0x32, 0x33, 0x37, 0x33, 0x30, 0x35,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x33, 0x2e, 0x31, 0x35, 0x34, 0x32, 0x33,
-  0x30, 0x38, 0x36, 0x32, 0x38, 0x35, 0x35, 0x39, 0x31, 0x31, 0x32, 0x35,
-  0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x32, 0x37, 0x35, 0x32,
-  0x33, 0x31, 0x31, 0x38, 0x32, 0x35, 0x37, 0x35, 0x32, 0x32, 0x35, 0x38,
-  0x33, 0x30, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x34, 0x2e, 0x33, 0x37,
-  0x33, 0x36, 0x35, 0x33, 0x39, 0x37, 0x38, 0x31, 0x30, 0x39, 0x33, 0x35,
-  0x39, 0x37, 0x34, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x34,
-  0x36, 0x33, 0x32, 0x34, 0x31, 0x30, 0x34, 0x30, 0x37, 0x30, 0x36, 0x36,
-  0x33, 0x34, 0x35, 0x32, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x38, 0x2e,
-  0x34, 0x30, 0x33, 0x38, 0x32, 0x30, 0x39, 0x31, 0x37, 0x30, 0x31, 0x30,
-  0x33, 0x30, 0x37, 0x33, 0x31, 0x32, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x36,
-  0x2e, 0x36, 0x39, 0x31, 0x34, 0x39, 0x36, 0x30, 0x37, 0x34, 0x31, 0x39,
-  0x39, 0x36, 0x37, 0x36, 0x35, 0x31, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x35, 0x2e, 0x35, 0x35, 0x33, 0x38, 0x32, 0x39, 0x32, 0x39, 0x37,
-  0x34, 0x32, 0x33, 0x33, 0x36, 0x32, 0x37, 0x33, 0x32, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x34, 0x2e, 0x34, 0x37, 0x36, 0x37, 0x35, 0x34, 0x37, 0x33,
-  0x39, 0x38, 0x38, 0x30, 0x35, 0x36, 0x31, 0x38, 0x32, 0x39, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x37, 0x31, 0x31, 0x37, 0x34, 0x35,
-  0x33, 0x37, 0x33, 0x39, 0x30, 0x34, 0x37, 0x30, 0x35, 0x30, 0x34, 0x38,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x33, 0x39, 0x30, 0x35,
-  0x33, 0x33, 0x36, 0x31, 0x34, 0x39, 0x30, 0x33, 0x36, 0x38, 0x38, 0x34,
-  0x33, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x37, 0x32,
-  0x37, 0x31, 0x39, 0x31, 0x34, 0x35, 0x35, 0x36, 0x36, 0x32, 0x32, 0x35,
-  0x30, 0x35, 0x31, 0x39, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x36, 0x2e,
-  0x36, 0x38, 0x33, 0x38, 0x37, 0x34, 0x31, 0x33, 0x30, 0x32, 0x34, 0x39,
-  0x30, 0x32, 0x33, 0x34, 0x33, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37,
-  0x2e, 0x31, 0x36, 0x34, 0x30, 0x31, 0x36, 0x33, 0x36, 0x36, 0x30, 0x30,
-  0x34, 0x39, 0x34, 0x33, 0x38, 0x34, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x31, 0x2e, 0x30, 0x35, 0x30, 0x38, 0x31, 0x36, 0x37, 0x35, 0x35, 0x37,
-  0x34, 0x31, 0x38, 0x33, 0x34, 0x36, 0x34, 0x31, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x34, 0x2e, 0x36, 0x31, 0x35, 0x33, 0x39, 0x33, 0x36, 0x35, 0x33,
-  0x35, 0x31, 0x32, 0x30, 0x30, 0x31, 0x30, 0x33, 0x38, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x30, 0x34, 0x39, 0x36, 0x30, 0x30, 0x37,
-  0x38, 0x30, 0x30, 0x31, 0x30, 0x32, 0x32, 0x33, 0x33, 0x38, 0x39, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x33, 0x34, 0x38, 0x35, 0x37,
-  0x36, 0x35, 0x34, 0x35, 0x37, 0x31, 0x35, 0x33, 0x33, 0x32, 0x30, 0x33,
-  0x31, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x34, 0x2e, 0x34, 0x34, 0x39,
-  0x32, 0x35, 0x30, 0x35, 0x34, 0x39, 0x30, 0x37, 0x37, 0x39, 0x38, 0x37,
-  0x36, 0x37, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x31, 0x36,
-  0x37, 0x38, 0x34, 0x31, 0x31, 0x38, 0x31, 0x31, 0x35, 0x39, 0x30, 0x31,
-  0x39, 0x34, 0x37, 0x30, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x35, 0x2e,
-  0x37, 0x34, 0x37, 0x38, 0x35, 0x33, 0x35, 0x39, 0x32, 0x30, 0x33, 0x38,
-  0x31, 0x35, 0x34, 0x36, 0x30, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37,
-  0x2e, 0x34, 0x38, 0x36, 0x30, 0x31, 0x31, 0x30, 0x38, 0x37, 0x38, 0x39,
-  0x34, 0x34, 0x33, 0x39, 0x36, 0x39, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x33, 0x2e, 0x32, 0x32, 0x34, 0x30, 0x38, 0x38, 0x35, 0x34, 0x39, 0x36,
-  0x31, 0x33, 0x39, 0x35, 0x32, 0x36, 0x33, 0x37, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x33, 0x2e, 0x39, 0x34, 0x30, 0x39, 0x34, 0x37, 0x33, 0x35, 0x33,
-  0x38, 0x33, 0x39, 0x38, 0x37, 0x34, 0x32, 0x36, 0x38, 0x65, 0x2d, 0x30,
-  0x31, 0x0a, 0x34, 0x2e, 0x31, 0x35, 0x33, 0x35, 0x35, 0x32, 0x39, 0x34,
-  0x39, 0x34, 0x32, 0x38, 0x35, 0x35, 0x38, 0x33, 0x35, 0x30, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x35, 0x2e, 0x32, 0x31, 0x34, 0x33, 0x33, 0x35,
-  0x38, 0x36, 0x32, 0x35, 0x34, 0x37, 0x31, 0x35, 0x39, 0x31, 0x39, 0x35,
-  0x65, 0x2d, 0x30, 0x33, 0x0a, 0x36, 0x2e, 0x39, 0x30, 0x35, 0x37, 0x31,
-  0x32, 0x31, 0x38, 0x37, 0x32, 0x39, 0x30, 0x31, 0x39, 0x31, 0x36, 0x35,
-  0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x39, 0x31, 0x37, 0x38,
-  0x36, 0x34, 0x36, 0x32, 0x30, 0x36, 0x38, 0x35, 0x35, 0x37, 0x37, 0x33,
-  0x39, 0x33, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x36, 0x2e, 0x31, 0x34, 0x36,
-  0x35, 0x30, 0x32, 0x31, 0x32, 0x32, 0x32, 0x38, 0x32, 0x39, 0x38, 0x31,
-  0x38, 0x37, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x39, 0x2e, 0x36,
-  0x31, 0x32, 0x30, 0x34, 0x36, 0x31, 0x38, 0x32, 0x31, 0x35, 0x35, 0x36,
-  0x30, 0x39, 0x31, 0x33, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33,
-  0x2e, 0x39, 0x34, 0x33, 0x36, 0x35, 0x38, 0x39, 0x39, 0x32, 0x36, 0x34,
-  0x38, 0x31, 0x32, 0x34, 0x36, 0x39, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x35, 0x2e, 0x39, 0x37, 0x37, 0x39, 0x31, 0x31, 0x38, 0x37, 0x34,
-  0x36, 0x35, 0x31, 0x39, 0x30, 0x38, 0x38, 0x37, 0x35, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x39, 0x36, 0x32, 0x31, 0x32, 0x30, 0x35,
-  0x33, 0x32, 0x39, 0x38, 0x39, 0x35, 0x30, 0x31, 0x39, 0x35, 0x33, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x36, 0x32, 0x37, 0x30, 0x35,
-  0x35, 0x32, 0x31, 0x32, 0x38, 0x35, 0x35, 0x33, 0x33, 0x39, 0x30, 0x35,
-  0x30, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x35, 0x2e, 0x33, 0x30, 0x37,
-  0x33, 0x35, 0x30, 0x36, 0x38, 0x30, 0x32, 0x33, 0x32, 0x30, 0x34, 0x38,
-  0x30, 0x33, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x35,
-  0x34, 0x33, 0x38, 0x32, 0x31, 0x31, 0x34, 0x31, 0x31, 0x32, 0x33, 0x37,
-  0x37, 0x31, 0x36, 0x36, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e,
-  0x34, 0x30, 0x32, 0x37, 0x36, 0x33, 0x39, 0x37, 0x37, 0x36, 0x34, 0x36,
-  0x38, 0x32, 0x37, 0x36, 0x39, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x38,
-  0x2e, 0x30, 0x31, 0x35, 0x37, 0x39, 0x36, 0x35, 0x34, 0x32, 0x31, 0x36,
-  0x37, 0x36, 0x36, 0x33, 0x35, 0x37, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x35, 0x2e, 0x31, 0x34, 0x37, 0x34, 0x31, 0x35, 0x37, 0x37, 0x32, 0x30,
-  0x38, 0x30, 0x34, 0x32, 0x31, 0x34, 0x34, 0x38, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x32, 0x2e, 0x38, 0x37, 0x30, 0x39, 0x34, 0x36, 0x35, 0x36, 0x33,
-  0x37, 0x38, 0x30, 0x33, 0x30, 0x37, 0x37, 0x37, 0x30, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x32, 0x2e, 0x36, 0x30, 0x39, 0x36, 0x34, 0x35, 0x37, 0x36,
-  0x31, 0x35, 0x34, 0x39, 0x34, 0x37, 0x32, 0x38, 0x30, 0x39, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x37, 0x2e, 0x37, 0x39, 0x36, 0x30, 0x39, 0x33, 0x38,
-  0x32, 0x31, 0x35, 0x32, 0x35, 0x35, 0x37, 0x33, 0x37, 0x33, 0x30, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x31, 0x39, 0x37, 0x37, 0x33, 0x32,
-  0x39, 0x34, 0x30, 0x33, 0x31, 0x36, 0x32, 0x30, 0x30, 0x32, 0x35, 0x36,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x32, 0x30, 0x35, 0x32, 0x34,
-  0x39, 0x32, 0x30, 0x35, 0x32, 0x33, 0x31, 0x36, 0x36, 0x36, 0x35, 0x36,
-  0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x33, 0x37, 0x33, 0x34,
-  0x39, 0x31, 0x36, 0x30, 0x30, 0x31, 0x35, 0x35, 0x38, 0x33, 0x30, 0x33,
-  0x38, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x37, 0x35, 0x38,
-  0x34, 0x32, 0x34, 0x35, 0x32, 0x30, 0x34, 0x39, 0x32, 0x35, 0x35, 0x33,
-  0x37, 0x31, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x39, 0x2e, 0x35, 0x34,
-  0x34, 0x38, 0x37, 0x33, 0x32, 0x33, 0x37, 0x36, 0x30, 0x39, 0x38, 0x36,
-  0x33, 0x32, 0x38, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x32,
-  0x34, 0x36, 0x39, 0x33, 0x34, 0x33, 0x30, 0x39, 0x36, 0x30, 0x31, 0x37,
-  0x38, 0x33, 0x37, 0x35, 0x32, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x33,
-  0x2e, 0x39, 0x38, 0x38, 0x39, 0x35, 0x38, 0x31, 0x35, 0x30, 0x31, 0x34,
-  0x38, 0x33, 0x39, 0x31, 0x37, 0x32, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x38, 0x2e, 0x38, 0x33, 0x34, 0x32, 0x35, 0x32, 0x35, 0x30, 0x36, 0x34,
-  0x39, 0x34, 0x35, 0x32, 0x32, 0x30, 0x39, 0x35, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x31, 0x2e, 0x30, 0x38, 0x39, 0x30, 0x38, 0x36, 0x31, 0x37,
-  0x34, 0x30, 0x33, 0x33, 0x35, 0x38, 0x32, 0x32, 0x31, 0x31, 0x65, 0x2d,
-  0x30, 0x33, 0x0a, 0x31, 0x2e, 0x30, 0x38, 0x30, 0x31, 0x33, 0x34, 0x31,
-  0x33, 0x38, 0x34, 0x36, 0x34, 0x39, 0x32, 0x37, 0x36, 0x37, 0x33, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x32, 0x2e, 0x35, 0x34, 0x34, 0x32, 0x37, 0x39,
-  0x33, 0x39, 0x36, 0x35, 0x33, 0x33, 0x39, 0x36, 0x36, 0x30, 0x36, 0x34,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x37, 0x2e, 0x37, 0x30, 0x34, 0x36,
-  0x38, 0x30, 0x34, 0x31, 0x33, 0x30, 0x30, 0x37, 0x37, 0x33, 0x36, 0x32,
-  0x30, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x39, 0x39, 0x31,
-  0x38, 0x39, 0x37, 0x30, 0x33, 0x31, 0x36, 0x36, 0x34, 0x38, 0x34, 0x38,
-  0x33, 0x32, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x34, 0x38,
-  0x31, 0x38, 0x37, 0x33, 0x32, 0x34, 0x34, 0x30, 0x34, 0x37, 0x31, 0x36,
-  0x34, 0x39, 0x31, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x31,
-  0x35, 0x31, 0x36, 0x35, 0x35, 0x34, 0x32, 0x39, 0x39, 0x37, 0x34, 0x31,
-  0x39, 0x38, 0x33, 0x34, 0x31, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x31,
-  0x2e, 0x35, 0x34, 0x32, 0x38, 0x31, 0x37, 0x32, 0x30, 0x35, 0x31, 0x39,
-  0x30, 0x36, 0x35, 0x38, 0x35, 0x36, 0x39, 0x65, 0x2d, 0x30, 0x31, 0x0a,
-  0x32, 0x2e, 0x30, 0x39, 0x39, 0x33, 0x32, 0x31, 0x30, 0x33, 0x37, 0x35,
-  0x33, 0x30, 0x38, 0x39, 0x39, 0x30, 0x34, 0x38, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x37, 0x2e, 0x34, 0x38, 0x30, 0x30, 0x33, 0x31, 0x39, 0x39,
-  0x36, 0x39, 0x36, 0x35, 0x34, 0x30, 0x38, 0x33, 0x32, 0x35, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x31, 0x2e, 0x35, 0x39, 0x30, 0x32, 0x39, 0x31, 0x34,
-  0x31, 0x30, 0x36, 0x38, 0x34, 0x35, 0x38, 0x35, 0x35, 0x37, 0x31, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x36, 0x32, 0x34, 0x37, 0x33, 0x38,
-  0x37, 0x32, 0x33, 0x30, 0x33, 0x39, 0x36, 0x32, 0x37, 0x30, 0x37, 0x35,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x33, 0x2e, 0x38, 0x39, 0x31, 0x33,
-  0x35, 0x32, 0x35, 0x36, 0x34, 0x30, 0x39, 0x36, 0x34, 0x35, 0x30, 0x38,
-  0x30, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x37, 0x39, 0x34,
-  0x30, 0x39, 0x37, 0x37, 0x35, 0x38, 0x38, 0x32, 0x39, 0x35, 0x39, 0x33,
-  0x36, 0x35, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x38,
-  0x38, 0x33, 0x38, 0x30, 0x30, 0x32, 0x38, 0x33, 0x30, 0x37, 0x34, 0x33,
-  0x37, 0x38, 0x39, 0x36, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36,
-  0x2e, 0x33, 0x38, 0x33, 0x30, 0x36, 0x38, 0x38, 0x35, 0x39, 0x35, 0x37,
-  0x37, 0x31, 0x37, 0x38, 0x39, 0x35, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x32, 0x2e, 0x32, 0x37, 0x32, 0x36, 0x39, 0x33, 0x39, 0x39, 0x39, 0x31,
-  0x31, 0x31, 0x36, 0x35, 0x32, 0x33, 0x37, 0x34, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x32, 0x2e, 0x34, 0x34, 0x35, 0x38, 0x30, 0x37, 0x34, 0x39, 0x34,
-  0x32, 0x32, 0x33, 0x31, 0x31, 0x37, 0x38, 0x32, 0x38, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x38, 0x39, 0x37, 0x39, 0x34, 0x35, 0x32,
-  0x38, 0x34, 0x38, 0x34, 0x33, 0x34, 0x34, 0x34, 0x38, 0x32, 0x34, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x31, 0x39, 0x36, 0x30, 0x32, 0x33,
-  0x33, 0x35, 0x39, 0x38, 0x39, 0x34, 0x37, 0x35, 0x32, 0x35, 0x30, 0x32,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x37, 0x35, 0x30, 0x36,
-  0x33, 0x38, 0x37, 0x38, 0x32, 0x39, 0x37, 0x38, 0x30, 0x35, 0x37, 0x38,
-  0x36, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x38, 0x34,
-  0x30, 0x33, 0x33, 0x30, 0x32, 0x36, 0x35, 0x34, 0x36, 0x32, 0x33, 0x39,
-  0x38, 0x35, 0x32, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x38, 0x2e, 0x38,
-  0x31, 0x39, 0x32, 0x33, 0x30, 0x36, 0x34, 0x35, 0x38, 0x39, 0x35, 0x30,
-  0x30, 0x34, 0x32, 0x37, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e,
-  0x34, 0x38, 0x33, 0x32, 0x31, 0x37, 0x34, 0x37, 0x37, 0x37, 0x39, 0x38,
-  0x34, 0x36, 0x31, 0x39, 0x31, 0x34, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31,
-  0x2e, 0x36, 0x36, 0x38, 0x37, 0x31, 0x35, 0x33, 0x32, 0x37, 0x39, 0x37,
-  0x38, 0x31, 0x33, 0x34, 0x31, 0x35, 0x35, 0x65, 0x2d, 0x30, 0x31, 0x0a,
-  0x31, 0x2e, 0x39, 0x37, 0x33, 0x31, 0x39, 0x34, 0x36, 0x32, 0x38, 0x39,
-  0x35, 0x33, 0x39, 0x33, 0x33, 0x37, 0x31, 0x36, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x31, 0x2e, 0x32, 0x38, 0x36, 0x30, 0x35, 0x35, 0x32, 0x39, 0x36,
-  0x36, 0x35, 0x39, 0x34, 0x36, 0x39, 0x36, 0x30, 0x34, 0x65, 0x2d, 0x30,
-  0x31, 0x0a, 0x31, 0x2e, 0x34, 0x30, 0x38, 0x37, 0x30, 0x32, 0x37, 0x33,
-  0x31, 0x31, 0x33, 0x32, 0x35, 0x30, 0x37, 0x33, 0x32, 0x34, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x39, 0x36, 0x36, 0x33, 0x30, 0x37,
-  0x39, 0x30, 0x38, 0x32, 0x39, 0x36, 0x35, 0x38, 0x35, 0x30, 0x38, 0x33,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e, 0x31, 0x35, 0x33, 0x37,
-  0x36, 0x30, 0x33, 0x34, 0x33, 0x37, 0x39, 0x30, 0x30, 0x35, 0x34, 0x33,
-  0x32, 0x31, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x38, 0x37, 0x36,
-  0x30, 0x36, 0x32, 0x36, 0x30, 0x31, 0x38, 0x30, 0x34, 0x37, 0x33, 0x33,
-  0x32, 0x37, 0x36, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x37, 0x2e, 0x38,
-  0x35, 0x35, 0x38, 0x33, 0x34, 0x30, 0x36, 0x36, 0x38, 0x36, 0x37, 0x38,
-  0x32, 0x38, 0x33, 0x36, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36,
-  0x2e, 0x37, 0x39, 0x33, 0x34, 0x37, 0x34, 0x34, 0x30, 0x36, 0x30, 0x30,
-  0x33, 0x39, 0x35, 0x32, 0x30, 0x32, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x37, 0x2e, 0x38, 0x34, 0x32, 0x31, 0x39, 0x39, 0x35, 0x30, 0x34, 0x33,
-  0x37, 0x35, 0x34, 0x35, 0x37, 0x37, 0x36, 0x34, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x39, 0x2e, 0x34, 0x34, 0x31, 0x30, 0x34, 0x36, 0x34, 0x31,
-  0x36, 0x37, 0x35, 0x39, 0x34, 0x39, 0x30, 0x39, 0x36, 0x37, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x33, 0x38, 0x30, 0x39, 0x37, 0x36,
-  0x32, 0x38, 0x39, 0x35, 0x31, 0x30, 0x37, 0x32, 0x36, 0x39, 0x32, 0x39,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e, 0x36, 0x37, 0x36, 0x37,
-  0x34, 0x37, 0x31, 0x38, 0x30, 0x35, 0x32, 0x31, 0x34, 0x38, 0x38, 0x31,
-  0x39, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x30, 0x38, 0x36,
-  0x34, 0x37, 0x32, 0x33, 0x36, 0x32, 0x32, 0x37, 0x39, 0x38, 0x39, 0x31,
-  0x39, 0x36, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x31, 0x36,
-  0x30, 0x36, 0x38, 0x30, 0x35, 0x30, 0x32, 0x36, 0x35, 0x33, 0x31, 0x32,
-  0x31, 0x39, 0x34, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e,
-  0x38, 0x34, 0x37, 0x32, 0x38, 0x35, 0x30, 0x37, 0x38, 0x38, 0x33, 0x38,
-  0x34, 0x36, 0x37, 0x35, 0x39, 0x38, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d,
-  0x36, 0x2e, 0x34, 0x35, 0x36, 0x37, 0x33, 0x35, 0x37, 0x33, 0x30, 0x31,
-  0x37, 0x31, 0x32, 0x30, 0x33, 0x36, 0x31, 0x33, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x31, 0x2e, 0x35, 0x39, 0x30, 0x30, 0x38, 0x34, 0x30, 0x39,
-  0x38, 0x32, 0x37, 0x39, 0x34, 0x37, 0x36, 0x31, 0x36, 0x36, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x36, 0x34, 0x30, 0x32, 0x34, 0x32,
-  0x37, 0x35, 0x37, 0x32, 0x37, 0x35, 0x37, 0x30, 0x30, 0x35, 0x36, 0x39,
-  0x65, 0x2d, 0x30, 0x33, 0x0a, 0x37, 0x2e, 0x36, 0x34, 0x39, 0x31, 0x30,
-  0x38, 0x37, 0x36, 0x37, 0x35, 0x30, 0x39, 0x34, 0x36, 0x30, 0x34, 0x34,
-  0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x32, 0x30, 0x39,
-  0x36, 0x35, 0x31, 0x37, 0x30, 0x38, 0x36, 0x30, 0x32, 0x39, 0x30, 0x35,
-  0x32, 0x37, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x33,
-  0x34, 0x38, 0x38, 0x34, 0x31, 0x31, 0x34, 0x35, 0x36, 0x33, 0x34, 0x36,
-  0x35, 0x31, 0x31, 0x38, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e,
-  0x39, 0x31, 0x32, 0x37, 0x34, 0x36, 0x31, 0x31, 0x36, 0x35, 0x31, 0x38,
-  0x39, 0x37, 0x34, 0x33, 0x30, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x31, 0x2e, 0x36, 0x30, 0x31, 0x31, 0x34, 0x30, 0x37, 0x35, 0x39, 0x38,
-  0x38, 0x35, 0x33, 0x31, 0x31, 0x31, 0x32, 0x37, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x35, 0x2e, 0x39, 0x37, 0x39, 0x35, 0x34, 0x32, 0x38, 0x30,
-  0x36, 0x37, 0x34, 0x34, 0x35, 0x37, 0x35, 0x35, 0x30, 0x30, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x34, 0x38, 0x37, 0x35, 0x31, 0x39,
-  0x36, 0x32, 0x31, 0x38, 0x34, 0x39, 0x30, 0x36, 0x30, 0x30, 0x35, 0x39,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x37, 0x33, 0x33, 0x37,
-  0x37, 0x31, 0x38, 0x37, 0x35, 0x35, 0x30, 0x30, 0x36, 0x37, 0x39, 0x30,
-  0x31, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x34, 0x31, 0x32,
-  0x38, 0x32, 0x36, 0x39, 0x32, 0x35, 0x35, 0x31, 0x36, 0x31, 0x32, 0x38,
-  0x35, 0x34, 0x30, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x38, 0x37,
-  0x30, 0x31, 0x35, 0x37, 0x31, 0x32, 0x32, 0x36, 0x31, 0x31, 0x39, 0x39,
-  0x39, 0x35, 0x31, 0x32, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x34, 0x2e, 0x30,
-  0x38, 0x37, 0x38, 0x39, 0x38, 0x34, 0x33, 0x33, 0x32, 0x30, 0x38, 0x34,
-  0x36, 0x35, 0x35, 0x37, 0x36, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x33, 0x2e,
-  0x37, 0x36, 0x34, 0x31, 0x36, 0x31, 0x31, 0x36, 0x39, 0x35, 0x32, 0x38,
-  0x39, 0x36, 0x31, 0x31, 0x38, 0x32, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x36,
-  0x2e, 0x35, 0x30, 0x35, 0x33, 0x35, 0x33, 0x37, 0x34, 0x38, 0x37, 0x39,
-  0x38, 0x33, 0x37, 0x30, 0x33, 0x36, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x32, 0x2e, 0x35, 0x30, 0x35, 0x35, 0x33, 0x38, 0x34, 0x36, 0x33,
-  0x35, 0x39, 0x32, 0x35, 0x32, 0x39, 0x32, 0x39, 0x37, 0x65, 0x2d, 0x30,
-  0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x30, 0x36, 0x32, 0x32, 0x38, 0x32, 0x32,
-  0x36, 0x37, 0x39, 0x35, 0x37, 0x39, 0x32, 0x35, 0x37, 0x39, 0x37, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x38, 0x2e, 0x32, 0x39, 0x34, 0x35, 0x31, 0x30,
-  0x30, 0x39, 0x36, 0x33, 0x31, 0x31, 0x35, 0x36, 0x39, 0x32, 0x31, 0x34,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x34, 0x36, 0x32, 0x32,
-  0x30, 0x30, 0x35, 0x32, 0x32, 0x34, 0x32, 0x32, 0x37, 0x39, 0x30, 0x35,
-  0x32, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x32, 0x34,
-  0x30, 0x39, 0x37, 0x34, 0x36, 0x31, 0x39, 0x39, 0x38, 0x34, 0x36, 0x32,
-  0x36, 0x37, 0x37, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e,
-  0x31, 0x38, 0x33, 0x31, 0x31, 0x30, 0x33, 0x38, 0x36, 0x31, 0x33, 0x33,
-  0x31, 0x39, 0x33, 0x39, 0x37, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x38, 0x2e, 0x35, 0x38, 0x35, 0x37, 0x32, 0x36, 0x34, 0x36, 0x39, 0x37,
-  0x35, 0x35, 0x31, 0x37, 0x32, 0x37, 0x32, 0x39, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x39, 0x2e, 0x32, 0x34, 0x30, 0x34, 0x34, 0x39, 0x32, 0x31,
-  0x39, 0x39, 0x34, 0x32, 0x30, 0x39, 0x32, 0x38, 0x39, 0x36, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x31, 0x2e, 0x31, 0x35, 0x33, 0x31, 0x31, 0x38, 0x36,
-  0x32, 0x39, 0x30, 0x30, 0x38, 0x35, 0x33, 0x31, 0x35, 0x37, 0x30, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x30, 0x34, 0x38, 0x35, 0x33, 0x33,
-  0x38, 0x35, 0x36, 0x38, 0x36, 0x38, 0x37, 0x34, 0x33, 0x38, 0x39, 0x36,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x39, 0x37, 0x30, 0x36, 0x33,
-  0x36, 0x33, 0x39, 0x37, 0x36, 0x30, 0x30, 0x31, 0x37, 0x33, 0x39, 0x35,
-  0x30, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x35, 0x2e, 0x32, 0x38, 0x32,
-  0x33, 0x37, 0x32, 0x36, 0x30, 0x38, 0x37, 0x38, 0x30, 0x38, 0x36, 0x30,
-  0x39, 0x30, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x30, 0x38,
-  0x30, 0x30, 0x37, 0x36, 0x35, 0x36, 0x30, 0x33, 0x37, 0x38, 0x30, 0x37,
-  0x34, 0x36, 0x34, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x36,
-  0x33, 0x33, 0x32, 0x34, 0x36, 0x34, 0x38, 0x31, 0x34, 0x31, 0x38, 0x36,
-  0x30, 0x39, 0x36, 0x31, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e,
-  0x37, 0x37, 0x38, 0x37, 0x35, 0x31, 0x35, 0x36, 0x37, 0x30, 0x30, 0x36,
-  0x31, 0x31, 0x31, 0x31, 0x34, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x36, 0x2e, 0x39, 0x30, 0x37, 0x30, 0x36, 0x30, 0x37, 0x34, 0x32, 0x33,
-  0x37, 0x38, 0x32, 0x33, 0x34, 0x38, 0x36, 0x33, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x33, 0x2e, 0x30, 0x31, 0x33, 0x30, 0x32, 0x33, 0x31, 0x37, 0x35,
-  0x32, 0x39, 0x39, 0x31, 0x36, 0x37, 0x36, 0x33, 0x33, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x34, 0x30, 0x35, 0x36, 0x34, 0x32, 0x31,
-  0x33, 0x36, 0x39, 0x33, 0x31, 0x34, 0x31, 0x39, 0x33, 0x37, 0x33, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x33, 0x30, 0x31, 0x34, 0x37,
-  0x35, 0x37, 0x30, 0x37, 0x34, 0x34, 0x31, 0x35, 0x36, 0x38, 0x33, 0x37,
-  0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x33, 0x33, 0x39,
-  0x38, 0x35, 0x35, 0x33, 0x32, 0x38, 0x32, 0x30, 0x32, 0x32, 0x34, 0x37,
-  0x36, 0x32, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x36,
-  0x32, 0x30, 0x31, 0x32, 0x39, 0x33, 0x30, 0x39, 0x35, 0x39, 0x34, 0x36,
-  0x33, 0x31, 0x31, 0x39, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37,
-  0x2e, 0x35, 0x37, 0x39, 0x38, 0x35, 0x38, 0x36, 0x30, 0x31, 0x30, 0x39,
-  0x33, 0x32, 0x39, 0x32, 0x32, 0x33, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x31, 0x2e, 0x30, 0x39, 0x35, 0x31, 0x38, 0x36, 0x32, 0x34, 0x38, 0x34,
-  0x32, 0x31, 0x36, 0x36, 0x39, 0x30, 0x30, 0x36, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x32, 0x2e, 0x35, 0x36, 0x34, 0x34, 0x31, 0x38, 0x36, 0x31, 0x33,
-  0x39, 0x31, 0x30, 0x36, 0x37, 0x35, 0x30, 0x34, 0x39, 0x65, 0x2d, 0x30,
-  0x31, 0x0a, 0x32, 0x2e, 0x34, 0x33, 0x30, 0x36, 0x37, 0x34, 0x31, 0x33,
-  0x35, 0x36, 0x38, 0x34, 0x39, 0x36, 0x37, 0x30, 0x34, 0x31, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x33, 0x2e, 0x37, 0x38, 0x36, 0x39, 0x30, 0x35, 0x37,
-  0x30, 0x35, 0x39, 0x32, 0x38, 0x38, 0x30, 0x32, 0x34, 0x39, 0x30, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x33, 0x2e, 0x38, 0x32, 0x38, 0x39, 0x33, 0x34,
-  0x34, 0x33, 0x31, 0x30, 0x37, 0x36, 0x30, 0x34, 0x39, 0x38, 0x30, 0x35,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x32, 0x2e, 0x34, 0x33, 0x30, 0x38, 0x32,
-  0x31, 0x30, 0x36, 0x31, 0x31, 0x33, 0x34, 0x33, 0x33, 0x38, 0x33, 0x37,
-  0x39, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x37, 0x2e, 0x35, 0x35, 0x31, 0x31,
-  0x34, 0x39, 0x32, 0x37, 0x38, 0x38, 0x37, 0x39, 0x31, 0x36, 0x35, 0x36,
-  0x34, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x31, 0x36, 0x37,
-  0x30, 0x31, 0x34, 0x33, 0x33, 0x30, 0x36, 0x32, 0x35, 0x35, 0x33, 0x34,
-  0x30, 0x35, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x32, 0x2e, 0x38, 0x35,
-  0x34, 0x34, 0x39, 0x32, 0x33, 0x36, 0x36, 0x33, 0x31, 0x33, 0x39, 0x33,
-  0x34, 0x33, 0x32, 0x36, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x38,
-  0x32, 0x39, 0x39, 0x31, 0x33, 0x34, 0x30, 0x37, 0x35, 0x36, 0x34, 0x31,
-  0x36, 0x33, 0x32, 0x30, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x39,
-  0x2e, 0x36, 0x36, 0x37, 0x35, 0x35, 0x33, 0x37, 0x35, 0x32, 0x36, 0x36,
-  0x30, 0x37, 0x35, 0x31, 0x33, 0x34, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x32, 0x2e, 0x30, 0x37, 0x34, 0x38, 0x30, 0x36, 0x39, 0x35, 0x30,
-  0x39, 0x38, 0x36, 0x33, 0x38, 0x35, 0x33, 0x34, 0x35, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x31, 0x2e, 0x30, 0x30, 0x35, 0x31, 0x30, 0x32, 0x35, 0x34,
-  0x35, 0x30, 0x32, 0x32, 0x39, 0x36, 0x34, 0x34, 0x37, 0x38, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x39, 0x33, 0x39, 0x36, 0x35, 0x39,
-  0x37, 0x31, 0x34, 0x36, 0x39, 0x38, 0x37, 0x39, 0x31, 0x35, 0x30, 0x34,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x33, 0x2e, 0x30, 0x31, 0x30, 0x32,
-  0x30, 0x38, 0x39, 0x30, 0x34, 0x37, 0x34, 0x33, 0x31, 0x39, 0x34, 0x35,
-  0x38, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x39, 0x30, 0x31,
-  0x34, 0x30, 0x31, 0x33, 0x37, 0x30, 0x37, 0x36, 0x33, 0x37, 0x37, 0x38,
-  0x36, 0x38, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x36, 0x33,
-  0x39, 0x38, 0x38, 0x31, 0x35, 0x32, 0x35, 0x31, 0x38, 0x38, 0x36, 0x38,
-  0x34, 0x34, 0x36, 0x34, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x31, 0x2e,
-  0x30, 0x34, 0x39, 0x35, 0x37, 0x31, 0x34, 0x38, 0x34, 0x33, 0x32, 0x37,
-  0x33, 0x31, 0x36, 0x32, 0x38, 0x34, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d,
-  0x38, 0x2e, 0x33, 0x39, 0x37, 0x36, 0x31, 0x33, 0x34, 0x36, 0x35, 0x37,
-  0x38, 0x35, 0x39, 0x38, 0x30, 0x32, 0x32, 0x35, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x39, 0x2e, 0x33, 0x38, 0x34, 0x30, 0x37, 0x36, 0x31, 0x31,
-  0x31, 0x30, 0x31, 0x38, 0x36, 0x35, 0x37, 0x36, 0x38, 0x34, 0x65, 0x2d,
-  0x30, 0x33, 0x0a, 0x36, 0x2e, 0x32, 0x34, 0x33, 0x36, 0x36, 0x35, 0x35,
-  0x31, 0x36, 0x33, 0x37, 0x36, 0x34, 0x39, 0x35, 0x33, 0x36, 0x31, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x37, 0x36, 0x34, 0x38, 0x36,
-  0x32, 0x33, 0x35, 0x38, 0x35, 0x37, 0x30, 0x30, 0x39, 0x38, 0x38, 0x37,
-  0x37, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x37, 0x2e, 0x35, 0x36, 0x34, 0x34,
-  0x30, 0x30, 0x31, 0x33, 0x36, 0x34, 0x37, 0x30, 0x37, 0x39, 0x34, 0x36,
-  0x37, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x31, 0x35,
-  0x32, 0x37, 0x39, 0x33, 0x33, 0x34, 0x37, 0x38, 0x33, 0x35, 0x35, 0x34,
-  0x30, 0x37, 0x37, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e,
-  0x31, 0x36, 0x35, 0x38, 0x33, 0x31, 0x38, 0x36, 0x33, 0x38, 0x38, 0x30,
-  0x31, 0x35, 0x37, 0x34, 0x37, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x32, 0x2e, 0x35, 0x39, 0x30, 0x31, 0x39, 0x36, 0x33, 0x39, 0x33, 0x34,
-  0x33, 0x30, 0x32, 0x33, 0x33, 0x30, 0x30, 0x32, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x34, 0x2e, 0x31, 0x36, 0x38, 0x31, 0x35, 0x34, 0x36, 0x37, 0x31,
-  0x37, 0x38, 0x38, 0x32, 0x31, 0x35, 0x36, 0x33, 0x37, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x35, 0x2e, 0x36, 0x35, 0x39, 0x34, 0x30, 0x32, 0x35, 0x33,
-  0x34, 0x33, 0x36, 0x35, 0x36, 0x35, 0x33, 0x39, 0x39, 0x32, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x32, 0x2e, 0x33, 0x32, 0x31, 0x37, 0x38, 0x34, 0x39,
-  0x34, 0x33, 0x33, 0x34, 0x32, 0x32, 0x30, 0x38, 0x38, 0x36, 0x32, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x39, 0x39, 0x31, 0x35, 0x32, 0x39,
-  0x34, 0x30, 0x35, 0x31, 0x31, 0x37, 0x30, 0x33, 0x34, 0x39, 0x31, 0x32,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x39, 0x2e, 0x37, 0x36, 0x37, 0x30, 0x30,
-  0x30, 0x33, 0x37, 0x37, 0x31, 0x37, 0x38, 0x31, 0x39, 0x32, 0x31, 0x33,
-  0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x31, 0x34, 0x36, 0x38,
-  0x34, 0x32, 0x37, 0x37, 0x37, 0x37, 0x32, 0x39, 0x30, 0x33, 0x34, 0x34,
-  0x32, 0x34, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x32, 0x2e, 0x32, 0x36, 0x32,
-  0x32, 0x37, 0x33, 0x31, 0x33, 0x32, 0x38, 0x30, 0x31, 0x30, 0x35, 0x35,
-  0x39, 0x30, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x35, 0x2e, 0x37, 0x38,
-  0x37, 0x37, 0x39, 0x39, 0x33, 0x35, 0x38, 0x33, 0x36, 0x37, 0x39, 0x31,
-  0x39, 0x39, 0x32, 0x32, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x35, 0x2e, 0x30,
-  0x32, 0x37, 0x33, 0x32, 0x37, 0x35, 0x33, 0x37, 0x35, 0x33, 0x36, 0x36,
-  0x32, 0x31, 0x30, 0x39, 0x34, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x33, 0x2e,
-  0x31, 0x34, 0x31, 0x30, 0x38, 0x36, 0x33, 0x39, 0x39, 0x35, 0x35, 0x35,
-  0x32, 0x30, 0x36, 0x32, 0x39, 0x39, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31,
-  0x2e, 0x36, 0x39, 0x30, 0x31, 0x32, 0x35, 0x33, 0x31, 0x36, 0x33, 0x38,
-  0x31, 0x34, 0x35, 0x34, 0x34, 0x36, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a,
-  0x32, 0x2e, 0x33, 0x35, 0x30, 0x38, 0x39, 0x32, 0x37, 0x32, 0x32, 0x36,
-  0x30, 0x36, 0x36, 0x35, 0x38, 0x39, 0x33, 0x36, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x33, 0x2e, 0x30, 0x38, 0x35, 0x31, 0x37, 0x31, 0x32, 0x38, 0x32,
-  0x32, 0x39, 0x31, 0x34, 0x31, 0x32, 0x33, 0x35, 0x34, 0x65, 0x2d, 0x30,
-  0x31, 0x0a, 0x34, 0x2e, 0x31, 0x32, 0x30, 0x34, 0x32, 0x37, 0x33, 0x37,
-  0x30, 0x30, 0x37, 0x31, 0x34, 0x31, 0x31, 0x31, 0x33, 0x33, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x31, 0x2e, 0x34, 0x39, 0x37, 0x32, 0x36, 0x30, 0x30,
-  0x33, 0x34, 0x30, 0x38, 0x34, 0x33, 0x32, 0x30, 0x30, 0x36, 0x38, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x35, 0x31, 0x38, 0x38, 0x37,
-  0x38, 0x31, 0x39, 0x31, 0x37, 0x30, 0x39, 0x35, 0x31, 0x38, 0x34, 0x33,
-  0x33, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x35, 0x2e, 0x39, 0x33, 0x30, 0x31,
-  0x38, 0x31, 0x35, 0x39, 0x32, 0x37, 0x30, 0x32, 0x38, 0x36, 0x35, 0x36,
-  0x30, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x32, 0x33,
-  0x34, 0x31, 0x34, 0x36, 0x33, 0x32, 0x36, 0x37, 0x38, 0x30, 0x33, 0x31,
-  0x39, 0x32, 0x31, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x36,
-  0x37, 0x31, 0x30, 0x35, 0x31, 0x36, 0x33, 0x32, 0x36, 0x31, 0x32, 0x39,
-  0x34, 0x33, 0x36, 0x34, 0x39, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x33, 0x2e,
-  0x33, 0x30, 0x30, 0x35, 0x33, 0x31, 0x32, 0x30, 0x38, 0x35, 0x31, 0x35,
-  0x31, 0x36, 0x37, 0x32, 0x33, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35,
-  0x2e, 0x34, 0x34, 0x33, 0x37, 0x32, 0x30, 0x31, 0x34, 0x37, 0x30, 0x31,
-  0x33, 0x36, 0x36, 0x34, 0x32, 0x34, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x31, 0x2e, 0x36, 0x39, 0x36, 0x36, 0x31, 0x32, 0x31, 0x32, 0x37, 0x31,
-  0x32, 0x35, 0x32, 0x36, 0x33, 0x32, 0x31, 0x34, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x33, 0x2e, 0x34, 0x36, 0x34, 0x36, 0x30, 0x33, 0x37, 0x39, 0x36,
-  0x36, 0x30, 0x31, 0x32, 0x39, 0x35, 0x34, 0x37, 0x31, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x38, 0x34, 0x38, 0x33, 0x36, 0x37, 0x30,
-  0x39, 0x34, 0x39, 0x39, 0x33, 0x35, 0x39, 0x31, 0x33, 0x30, 0x39, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x35, 0x37, 0x38, 0x32, 0x33,
-  0x32, 0x39, 0x32, 0x39, 0x31, 0x31, 0x30, 0x35, 0x32, 0x37, 0x30, 0x33,
-  0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x38, 0x31, 0x36,
-  0x35, 0x39, 0x33, 0x38, 0x38, 0x35, 0x34, 0x32, 0x31, 0x37, 0x35, 0x32,
-  0x39, 0x33, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x35,
-  0x36, 0x37, 0x38, 0x31, 0x37, 0x30, 0x31, 0x37, 0x34, 0x33, 0x36, 0x30,
-  0x32, 0x37, 0x35, 0x32, 0x37, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x36,
-  0x2e, 0x36, 0x32, 0x37, 0x38, 0x36, 0x36, 0x36, 0x32, 0x35, 0x37, 0x38,
-  0x35, 0x38, 0x32, 0x37, 0x36, 0x33, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x31, 0x2e, 0x34, 0x37, 0x37, 0x30, 0x33, 0x38, 0x32, 0x30, 0x38, 0x33,
-  0x39, 0x35, 0x32, 0x34, 0x32, 0x36, 0x39, 0x31, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x35, 0x2e, 0x31, 0x32, 0x37, 0x31, 0x32, 0x39, 0x33, 0x33,
-  0x31, 0x32, 0x33, 0x31, 0x31, 0x31, 0x37, 0x32, 0x34, 0x39, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x31, 0x2e, 0x30, 0x38, 0x34, 0x32, 0x35, 0x37, 0x33,
-  0x36, 0x34, 0x32, 0x37, 0x33, 0x30, 0x37, 0x31, 0x32, 0x38, 0x39, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x32, 0x2e, 0x38, 0x34, 0x36, 0x38, 0x39, 0x35,
-  0x31, 0x35, 0x38, 0x32, 0x39, 0x30, 0x38, 0x36, 0x33, 0x30, 0x33, 0x37,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x34, 0x2e, 0x36, 0x31, 0x36, 0x30, 0x31,
-  0x37, 0x32, 0x36, 0x37, 0x31, 0x30, 0x37, 0x39, 0x36, 0x33, 0x35, 0x36,
-  0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x35, 0x36, 0x34,
-  0x33, 0x36, 0x39, 0x33, 0x30, 0x35, 0x39, 0x36, 0x38, 0x32, 0x38, 0x34,
-  0x36, 0x30, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x36,
-  0x36, 0x30, 0x31, 0x35, 0x33, 0x36, 0x34, 0x32, 0x32, 0x39, 0x36, 0x37,
-  0x39, 0x31, 0x30, 0x37, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e,
-  0x35, 0x39, 0x31, 0x36, 0x33, 0x39, 0x31, 0x30, 0x31, 0x35, 0x30, 0x35,
-  0x32, 0x37, 0x39, 0x35, 0x34, 0x31, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x35,
-  0x2e, 0x37, 0x38, 0x32, 0x39, 0x33, 0x39, 0x38, 0x36, 0x36, 0x31, 0x38,
-  0x35, 0x31, 0x38, 0x38, 0x32, 0x39, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x34, 0x2e, 0x30, 0x31, 0x31, 0x36, 0x37, 0x31, 0x39, 0x39, 0x30, 0x31,
-  0x35, 0x36, 0x31, 0x37, 0x33, 0x37, 0x30, 0x36, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x31, 0x2e, 0x33, 0x35, 0x39, 0x35, 0x39, 0x31, 0x39, 0x33,
-  0x31, 0x31, 0x30, 0x34, 0x36, 0x36, 0x30, 0x30, 0x33, 0x34, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x35, 0x2e, 0x37, 0x35, 0x30, 0x38, 0x33, 0x34, 0x33,
-  0x34, 0x35, 0x38, 0x31, 0x37, 0x35, 0x36, 0x35, 0x39, 0x31, 0x38, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x35, 0x2e, 0x36, 0x34, 0x31, 0x30, 0x38, 0x37,
-  0x38, 0x38, 0x39, 0x36, 0x37, 0x31, 0x33, 0x32, 0x35, 0x36, 0x38, 0x34,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x36, 0x2e, 0x36, 0x30, 0x34, 0x31, 0x39,
-  0x36, 0x34, 0x32, 0x39, 0x32, 0x35, 0x32, 0x36, 0x32, 0x34, 0x35, 0x31,
-  0x32, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x34, 0x31, 0x38, 0x37,
-  0x39, 0x35, 0x37, 0x33, 0x34, 0x36, 0x34, 0x33, 0x39, 0x33, 0x36, 0x31,
-  0x35, 0x37, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x38, 0x37,
-  0x30, 0x30, 0x31, 0x36, 0x39, 0x33, 0x39, 0x39, 0x33, 0x38, 0x30, 0x36,
-  0x38, 0x33, 0x39, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x38,
-  0x32, 0x32, 0x35, 0x39, 0x32, 0x33, 0x31, 0x38, 0x30, 0x35, 0x38, 0x30,
-  0x31, 0x33, 0x39, 0x31, 0x36, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x37, 0x2e,
-  0x35, 0x30, 0x33, 0x35, 0x31, 0x31, 0x37, 0x35, 0x36, 0x36, 0x35, 0x38,
-  0x35, 0x35, 0x34, 0x30, 0x37, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x37, 0x2e, 0x33, 0x31, 0x33, 0x31, 0x31, 0x31, 0x34, 0x32, 0x34, 0x34,
-  0x34, 0x36, 0x31, 0x30, 0x35, 0x39, 0x35, 0x37, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x33, 0x2e, 0x35, 0x38, 0x36, 0x38, 0x35, 0x36, 0x32, 0x37,
-  0x35, 0x37, 0x39, 0x36, 0x38, 0x39, 0x30, 0x32, 0x35, 0x39, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x36, 0x2e, 0x32, 0x39, 0x38, 0x39, 0x31, 0x30, 0x38,
-  0x32, 0x36, 0x34, 0x34, 0x34, 0x36, 0x32, 0x35, 0x38, 0x35, 0x34, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x39, 0x35, 0x31, 0x34, 0x34,
-  0x33, 0x34, 0x33, 0x33, 0x37, 0x36, 0x31, 0x35, 0x39, 0x36, 0x36, 0x38,
-  0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x31, 0x32, 0x33,
-  0x37, 0x32, 0x36, 0x30, 0x38, 0x38, 0x35, 0x35, 0x33, 0x36, 0x36, 0x37,
-  0x30, 0x36, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x35,
-  0x38, 0x32, 0x36, 0x33, 0x34, 0x30, 0x35, 0x34, 0x31, 0x32, 0x34, 0x33,
-  0x35, 0x35, 0x33, 0x31, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e,
-  0x31, 0x38, 0x32, 0x31, 0x34, 0x39, 0x38, 0x34, 0x32, 0x33, 0x38, 0x31,
-  0x34, 0x37, 0x37, 0x33, 0x35, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33,
-  0x2e, 0x35, 0x34, 0x34, 0x36, 0x39, 0x34, 0x35, 0x35, 0x37, 0x37, 0x38,
-  0x35, 0x39, 0x38, 0x37, 0x38, 0x35, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x32, 0x2e, 0x39, 0x38, 0x35, 0x35, 0x39, 0x36, 0x34, 0x37, 0x30,
-  0x35, 0x33, 0x34, 0x38, 0x30, 0x31, 0x34, 0x38, 0x33, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x33, 0x35, 0x33, 0x31, 0x37, 0x39, 0x31,
-  0x35, 0x36, 0x37, 0x38, 0x30, 0x32, 0x34, 0x32, 0x39, 0x32, 0x30, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x34, 0x35, 0x39, 0x34, 0x33,
-  0x36, 0x38, 0x31, 0x38, 0x39, 0x35, 0x37, 0x33, 0x32, 0x38, 0x37, 0x39,
-  0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x37, 0x38, 0x35,
-  0x32, 0x39, 0x39, 0x39, 0x35, 0x36, 0x37, 0x39, 0x38, 0x35, 0x35, 0x33,
-  0x34, 0x36, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x36, 0x39,
-  0x39, 0x38, 0x37, 0x32, 0x36, 0x36, 0x35, 0x31, 0x30, 0x37, 0x32, 0x35,
-  0x30, 0x32, 0x31, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x30,
-  0x33, 0x31, 0x34, 0x35, 0x39, 0x38, 0x30, 0x38, 0x33, 0x34, 0x39, 0x36,
-  0x30, 0x39, 0x33, 0x37, 0x35, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x32, 0x2e,
-  0x32, 0x38, 0x38, 0x33, 0x32, 0x38, 0x35, 0x35, 0x38, 0x32, 0x30, 0x36,
-  0x35, 0x35, 0x38, 0x32, 0x32, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x38,
-  0x2e, 0x31, 0x30, 0x37, 0x31, 0x38, 0x33, 0x38, 0x37, 0x33, 0x36, 0x35,
-  0x33, 0x34, 0x31, 0x31, 0x38, 0x36, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x38, 0x2e, 0x33, 0x37, 0x31, 0x33, 0x37, 0x31, 0x37, 0x37, 0x35,
-  0x38, 0x36, 0x35, 0x35, 0x35, 0x34, 0x38, 0x31, 0x30, 0x65, 0x2d, 0x30,
-  0x33, 0x0a, 0x32, 0x2e, 0x32, 0x39, 0x34, 0x33, 0x38, 0x36, 0x31, 0x37,
-  0x38, 0x32, 0x35, 0x35, 0x30, 0x38, 0x31, 0x31, 0x37, 0x37, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x37, 0x2e, 0x37, 0x33, 0x35, 0x35, 0x39, 0x37,
-  0x33, 0x34, 0x32, 0x32, 0x35, 0x32, 0x37, 0x33, 0x31, 0x33, 0x32, 0x33,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x31, 0x38, 0x38, 0x32, 0x30,
-  0x31, 0x33, 0x38, 0x32, 0x37, 0x35, 0x36, 0x32, 0x33, 0x33, 0x32, 0x31,
-  0x35, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e, 0x36, 0x33, 0x31,
-  0x33, 0x32, 0x34, 0x35, 0x32, 0x39, 0x36, 0x34, 0x37, 0x38, 0x32, 0x37,
-  0x31, 0x34, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x30, 0x31,
-  0x35, 0x32, 0x39, 0x30, 0x38, 0x34, 0x31, 0x34, 0x36, 0x30, 0x32, 0x32,
-  0x37, 0x39, 0x36, 0x36, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x32, 0x2e, 0x36,
-  0x33, 0x34, 0x33, 0x32, 0x35, 0x33, 0x32, 0x35, 0x34, 0x38, 0x39, 0x30,
-  0x34, 0x34, 0x31, 0x38, 0x39, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x34, 0x2e,
-  0x38, 0x31, 0x37, 0x36, 0x37, 0x38, 0x34, 0x30, 0x36, 0x38, 0x33, 0x34,
-  0x36, 0x30, 0x32, 0x33, 0x35, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36,
-  0x2e, 0x38, 0x38, 0x37, 0x35, 0x35, 0x30, 0x36, 0x35, 0x32, 0x30, 0x32,
-  0x37, 0x31, 0x33, 0x30, 0x31, 0x32, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x31, 0x2e, 0x37, 0x39, 0x36, 0x36, 0x33, 0x35, 0x38, 0x33, 0x36, 0x33,
-  0x36, 0x32, 0x38, 0x33, 0x38, 0x37, 0x34, 0x35, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x33, 0x2e, 0x30, 0x31, 0x34, 0x36, 0x38, 0x30, 0x31, 0x34, 0x37,
-  0x31, 0x37, 0x31, 0x30, 0x32, 0x30, 0x35, 0x30, 0x38, 0x65, 0x2d, 0x30,
-  0x31, 0x0a, 0x36, 0x2e, 0x39, 0x31, 0x38, 0x39, 0x33, 0x39, 0x32, 0x30,
-  0x33, 0x30, 0x32, 0x33, 0x39, 0x31, 0x30, 0x35, 0x32, 0x32, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x37, 0x33, 0x34, 0x30, 0x31, 0x34,
-  0x38, 0x33, 0x38, 0x39, 0x33, 0x33, 0x39, 0x34, 0x34, 0x37, 0x30, 0x32,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x34, 0x33, 0x37, 0x33, 0x32,
-  0x38, 0x39, 0x39, 0x34, 0x32, 0x37, 0x34, 0x31, 0x33, 0x39, 0x34, 0x30,
-  0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x38, 0x37, 0x38, 0x32,
-  0x32, 0x33, 0x30, 0x36, 0x31, 0x35, 0x36, 0x31, 0x35, 0x38, 0x34, 0x34,
-  0x37, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x39, 0x38,
-  0x35, 0x32, 0x35, 0x35, 0x33, 0x37, 0x35, 0x35, 0x30, 0x34, 0x34, 0x39,
-  0x33, 0x37, 0x31, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x30,
-  0x38, 0x31, 0x38, 0x30, 0x39, 0x38, 0x39, 0x33, 0x32, 0x35, 0x30, 0x34,
-  0x36, 0x35, 0x33, 0x39, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e,
-  0x30, 0x38, 0x32, 0x30, 0x35, 0x35, 0x30, 0x33, 0x39, 0x37, 0x30, 0x33,
-  0x38, 0x34, 0x35, 0x39, 0x37, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36,
-  0x2e, 0x33, 0x37, 0x33, 0x30, 0x33, 0x35, 0x39, 0x30, 0x37, 0x37, 0x34,
-  0x35, 0x33, 0x36, 0x31, 0x33, 0x32, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x36, 0x2e, 0x36, 0x30, 0x36, 0x30, 0x30, 0x35, 0x31, 0x33, 0x32,
-  0x31, 0x39, 0x38, 0x33, 0x33, 0x33, 0x37, 0x34, 0x30, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x39, 0x36, 0x34, 0x32, 0x32, 0x30, 0x35,
-  0x39, 0x30, 0x38, 0x38, 0x39, 0x34, 0x35, 0x33, 0x38, 0x38, 0x38, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x30, 0x37, 0x33, 0x38, 0x34, 0x37,
-  0x32, 0x34, 0x39, 0x31, 0x35, 0x30, 0x32, 0x37, 0x36, 0x31, 0x38, 0x34,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x38, 0x31, 0x34, 0x32,
-  0x32, 0x38, 0x32, 0x34, 0x39, 0x37, 0x31, 0x33, 0x37, 0x37, 0x38, 0x34,
-  0x39, 0x36, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x31, 0x2e, 0x37, 0x32,
-  0x35, 0x30, 0x35, 0x34, 0x37, 0x31, 0x38, 0x35, 0x35, 0x34, 0x30, 0x31,
-  0x39, 0x39, 0x32, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e,
-  0x36, 0x30, 0x39, 0x37, 0x35, 0x38, 0x37, 0x37, 0x39, 0x34, 0x30, 0x36,
-  0x35, 0x34, 0x37, 0x35, 0x34, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x39,
-  0x2e, 0x31, 0x33, 0x37, 0x38, 0x31, 0x32, 0x32, 0x35, 0x36, 0x38, 0x31,
-  0x33, 0x30, 0x34, 0x39, 0x33, 0x31, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x33, 0x2e, 0x30, 0x34, 0x37, 0x35, 0x31, 0x38, 0x31, 0x33, 0x34, 0x31,
-  0x31, 0x37, 0x31, 0x32, 0x36, 0x34, 0x36, 0x35, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x31, 0x2e, 0x31, 0x38, 0x38, 0x35, 0x30, 0x38, 0x39, 0x34, 0x32,
-  0x37, 0x32, 0x33, 0x32, 0x37, 0x34, 0x32, 0x33, 0x31, 0x65, 0x2d, 0x30,
-  0x31, 0x0a, 0x37, 0x2e, 0x35, 0x38, 0x39, 0x34, 0x39, 0x38, 0x39, 0x30,
-  0x37, 0x33, 0x32, 0x37, 0x36, 0x35, 0x31, 0x39, 0x37, 0x38, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x34, 0x2e, 0x33, 0x37, 0x32, 0x39, 0x33, 0x33, 0x38,
-  0x37, 0x39, 0x34, 0x39, 0x34, 0x36, 0x36, 0x37, 0x30, 0x35, 0x33, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x34, 0x30, 0x36, 0x34, 0x36, 0x39,
-  0x31, 0x35, 0x31, 0x33, 0x37, 0x37, 0x36, 0x37, 0x37, 0x39, 0x31, 0x37,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x39, 0x2e, 0x36, 0x34, 0x39, 0x38, 0x38,
-  0x33, 0x32, 0x31, 0x30, 0x36, 0x35, 0x39, 0x30, 0x32, 0x37, 0x31, 0x30,
-  0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x33, 0x38, 0x39,
-  0x31, 0x37, 0x34, 0x33, 0x34, 0x32, 0x31, 0x35, 0x35, 0x34, 0x35, 0x36,
-  0x35, 0x34, 0x33, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x38, 0x2e, 0x31,
-  0x38, 0x33, 0x35, 0x37, 0x39, 0x31, 0x34, 0x36, 0x38, 0x36, 0x32, 0x30,
-  0x33, 0x30, 0x30, 0x32, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37,
-  0x2e, 0x32, 0x37, 0x33, 0x34, 0x31, 0x35, 0x34, 0x37, 0x36, 0x30, 0x38,
-  0x33, 0x37, 0x35, 0x35, 0x34, 0x39, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x31, 0x2e, 0x30, 0x34, 0x34, 0x33, 0x34, 0x33, 0x36, 0x33, 0x35, 0x34,
-  0x33, 0x39, 0x38, 0x37, 0x32, 0x37, 0x34, 0x32, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x31, 0x2e, 0x39, 0x39, 0x33, 0x31, 0x35, 0x34, 0x37, 0x33, 0x34,
-  0x33, 0x37, 0x33, 0x30, 0x39, 0x32, 0x36, 0x35, 0x31, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x38, 0x2e, 0x33, 0x37, 0x36, 0x37, 0x31, 0x34, 0x35, 0x38,
-  0x37, 0x32, 0x31, 0x31, 0x36, 0x30, 0x38, 0x38, 0x38, 0x37, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x31, 0x2e, 0x33, 0x35, 0x31, 0x36, 0x35, 0x36, 0x34,
-  0x36, 0x36, 0x37, 0x32, 0x32, 0x34, 0x38, 0x38, 0x34, 0x30, 0x33, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x30, 0x37, 0x33, 0x31, 0x35, 0x31,
-  0x39, 0x30, 0x31, 0x33, 0x36, 0x34, 0x33, 0x32, 0x36, 0x34, 0x37, 0x37,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e, 0x30, 0x38, 0x35, 0x33,
-  0x36, 0x38, 0x31, 0x34, 0x38, 0x39, 0x38, 0x32, 0x35, 0x32, 0x34, 0x38,
-  0x37, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x31, 0x33,
-  0x30, 0x33, 0x31, 0x32, 0x39, 0x31, 0x39, 0x36, 0x31, 0x36, 0x36, 0x39,
-  0x39, 0x32, 0x31, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e,
-  0x36, 0x34, 0x32, 0x33, 0x34, 0x31, 0x35, 0x38, 0x37, 0x36, 0x39, 0x32,
-  0x34, 0x39, 0x39, 0x31, 0x36, 0x31, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d,
-  0x32, 0x2e, 0x34, 0x34, 0x35, 0x30, 0x39, 0x37, 0x30, 0x38, 0x31, 0x33,
-  0x36, 0x33, 0x32, 0x30, 0x31, 0x31, 0x34, 0x31, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x31, 0x2e, 0x35, 0x35, 0x36, 0x32, 0x35, 0x33, 0x34, 0x33, 0x33,
-  0x32, 0x32, 0x37, 0x35, 0x33, 0x39, 0x30, 0x36, 0x32, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x34, 0x35, 0x31, 0x38, 0x37, 0x36, 0x39,
-  0x39, 0x37, 0x39, 0x34, 0x37, 0x36, 0x39, 0x32, 0x38, 0x37, 0x31, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x39, 0x37, 0x35, 0x30, 0x33,
-  0x34, 0x30, 0x38, 0x37, 0x38, 0x39, 0x36, 0x33, 0x34, 0x37, 0x30, 0x34,
-  0x36, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x36, 0x2e, 0x31, 0x37, 0x39, 0x39,
-  0x39, 0x35, 0x34, 0x36, 0x32, 0x32, 0x39, 0x38, 0x33, 0x39, 0x33, 0x32,
-  0x35, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x37, 0x33, 0x33,
-  0x37, 0x31, 0x34, 0x35, 0x32, 0x38, 0x33, 0x38, 0x31, 0x38, 0x32, 0x34,
-  0x34, 0x39, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x30, 0x36,
-  0x38, 0x31, 0x31, 0x37, 0x32, 0x33, 0x38, 0x35, 0x38, 0x31, 0x31, 0x38,
-  0x30, 0x35, 0x37, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e,
-  0x32, 0x38, 0x38, 0x39, 0x37, 0x38, 0x35, 0x30, 0x32, 0x31, 0x35, 0x34,
-  0x33, 0x35, 0x30, 0x32, 0x38, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36,
-  0x2e, 0x31, 0x31, 0x35, 0x34, 0x36, 0x32, 0x32, 0x35, 0x38, 0x34, 0x35,
-  0x38, 0x31, 0x33, 0x37, 0x35, 0x31, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x33, 0x2e, 0x30, 0x35, 0x34, 0x36, 0x33, 0x30, 0x39, 0x34, 0x32, 0x36,
-  0x34, 0x32, 0x36, 0x38, 0x38, 0x37, 0x35, 0x31, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x32, 0x2e, 0x39, 0x36, 0x31, 0x34, 0x36, 0x30, 0x31, 0x32,
-  0x38, 0x34, 0x32, 0x36, 0x35, 0x35, 0x31, 0x38, 0x31, 0x39, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x31, 0x2e, 0x30, 0x33, 0x34, 0x37, 0x32, 0x31, 0x35,
-  0x30, 0x38, 0x36, 0x32, 0x32, 0x31, 0x36, 0x39, 0x34, 0x39, 0x35, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x33, 0x2e, 0x39, 0x37, 0x33, 0x32, 0x36,
-  0x31, 0x34, 0x35, 0x33, 0x32, 0x31, 0x31, 0x33, 0x30, 0x37, 0x35, 0x32,
-  0x36, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x39, 0x2e, 0x38, 0x33, 0x31,
-  0x32, 0x31, 0x37, 0x36, 0x37, 0x36, 0x34, 0x30, 0x31, 0x31, 0x33, 0x38,
-  0x33, 0x30, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x33,
-  0x36, 0x33, 0x34, 0x36, 0x36, 0x39, 0x31, 0x38, 0x34, 0x36, 0x38, 0x34,
-  0x37, 0x35, 0x33, 0x34, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33,
-  0x2e, 0x30, 0x31, 0x36, 0x31, 0x33, 0x38, 0x30, 0x37, 0x36, 0x37, 0x38,
-  0x32, 0x32, 0x32, 0x36, 0x35, 0x36, 0x32, 0x65, 0x2d, 0x30, 0x31, 0x0a,
-  0x2d, 0x35, 0x2e, 0x33, 0x31, 0x30, 0x37, 0x30, 0x39, 0x34, 0x37, 0x36,
-  0x34, 0x37, 0x30, 0x39, 0x34, 0x37, 0x32, 0x36, 0x36, 0x65, 0x2d, 0x30,
-  0x31, 0x0a, 0x2d, 0x35, 0x2e, 0x31, 0x31, 0x33, 0x31, 0x30, 0x37, 0x35,
-  0x36, 0x32, 0x30, 0x36, 0x35, 0x31, 0x32, 0x34, 0x35, 0x31, 0x32, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e, 0x36, 0x34, 0x36, 0x30, 0x35,
-  0x35, 0x32, 0x32, 0x31, 0x35, 0x35, 0x37, 0x36, 0x31, 0x37, 0x31, 0x38,
-  0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x30, 0x37, 0x37, 0x31,
-  0x39, 0x35, 0x36, 0x32, 0x39, 0x34, 0x37, 0x37, 0x35, 0x30, 0x30, 0x39,
-  0x31, 0x36, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x32, 0x2e, 0x39, 0x30, 0x34,
-  0x32, 0x35, 0x32, 0x37, 0x30, 0x37, 0x39, 0x35, 0x38, 0x32, 0x32, 0x31,
-  0x34, 0x33, 0x36, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x32, 0x2e, 0x33, 0x36,
-  0x31, 0x30, 0x38, 0x38, 0x33, 0x39, 0x35, 0x31, 0x31, 0x38, 0x37, 0x31,
-  0x33, 0x33, 0x37, 0x39, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x31,
-  0x32, 0x36, 0x30, 0x38, 0x37, 0x30, 0x38, 0x34, 0x34, 0x31, 0x32, 0x35,
-  0x37, 0x34, 0x37, 0x36, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x39, 0x2e,
-  0x31, 0x36, 0x33, 0x35, 0x31, 0x31, 0x35, 0x34, 0x34, 0x34, 0x36, 0x36,
-  0x30, 0x31, 0x38, 0x36, 0x37, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31,
-  0x2e, 0x30, 0x39, 0x34, 0x37, 0x32, 0x39, 0x34, 0x35, 0x33, 0x33, 0x32,
-  0x35, 0x32, 0x37, 0x31, 0x36, 0x30, 0x36, 0x65, 0x2d, 0x30, 0x31, 0x0a,
-  0x35, 0x2e, 0x32, 0x38, 0x30, 0x38, 0x38, 0x34, 0x33, 0x35, 0x35, 0x33,
-  0x30, 0x36, 0x36, 0x32, 0x35, 0x33, 0x36, 0x36, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x33, 0x2e, 0x31, 0x34, 0x36, 0x32, 0x33, 0x30, 0x30, 0x35, 0x36,
-  0x38, 0x38, 0x31, 0x39, 0x30, 0x34, 0x36, 0x30, 0x32, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x37, 0x36, 0x31, 0x35, 0x33, 0x31, 0x35,
-  0x33, 0x31, 0x38, 0x31, 0x30, 0x37, 0x36, 0x30, 0x34, 0x39, 0x38, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x35, 0x38, 0x32, 0x38, 0x35,
-  0x36, 0x37, 0x35, 0x39, 0x34, 0x32, 0x38, 0x39, 0x37, 0x37, 0x39, 0x36,
-  0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x39, 0x38, 0x37,
-  0x34, 0x37, 0x30, 0x32, 0x30, 0x32, 0x31, 0x34, 0x37, 0x39, 0x36, 0x30,
-  0x36, 0x36, 0x33, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x35, 0x2e, 0x31,
-  0x35, 0x36, 0x36, 0x31, 0x35, 0x37, 0x34, 0x39, 0x30, 0x30, 0x31, 0x35,
-  0x30, 0x32, 0x39, 0x39, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35,
-  0x2e, 0x38, 0x31, 0x30, 0x34, 0x37, 0x37, 0x32, 0x31, 0x32, 0x30, 0x37,
-  0x31, 0x34, 0x31, 0x38, 0x37, 0x36, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x35, 0x2e, 0x37, 0x30, 0x36, 0x34, 0x31, 0x31, 0x32, 0x32, 0x37, 0x35,
-  0x38, 0x33, 0x38, 0x38, 0x35, 0x31, 0x39, 0x33, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x34, 0x2e, 0x36, 0x33, 0x33, 0x33, 0x34, 0x30, 0x39, 0x38, 0x34,
-  0x35, 0x38, 0x32, 0x39, 0x30, 0x31, 0x30, 0x30, 0x31, 0x65, 0x2d, 0x30,
-  0x33, 0x0a, 0x2d, 0x35, 0x2e, 0x37, 0x33, 0x34, 0x32, 0x35, 0x34, 0x36,
-  0x30, 0x36, 0x30, 0x36, 0x38, 0x31, 0x33, 0x34, 0x33, 0x30, 0x38, 0x65,
-  0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x38, 0x2e, 0x38, 0x36, 0x37, 0x31, 0x30,
-  0x31, 0x33, 0x37, 0x31, 0x32, 0x38, 0x38, 0x32, 0x39, 0x39, 0x35, 0x36,
-  0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x34, 0x36, 0x37,
-  0x33, 0x37, 0x37, 0x32, 0x39, 0x37, 0x35, 0x38, 0x30, 0x32, 0x34, 0x32,
-  0x31, 0x35, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x33, 0x34,
-  0x33, 0x30, 0x36, 0x35, 0x32, 0x30, 0x32, 0x32, 0x33, 0x36, 0x31, 0x37,
-  0x35, 0x35, 0x33, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e,
-  0x31, 0x30, 0x37, 0x30, 0x33, 0x35, 0x36, 0x39, 0x36, 0x35, 0x30, 0x36,
-  0x35, 0x30, 0x30, 0x32, 0x34, 0x34, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d,
-  0x37, 0x2e, 0x39, 0x33, 0x38, 0x35, 0x39, 0x34, 0x33, 0x37, 0x31, 0x30,
-  0x38, 0x30, 0x33, 0x39, 0x38, 0x35, 0x36, 0x30, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x31, 0x2e, 0x30, 0x30, 0x33, 0x39, 0x30, 0x30, 0x39, 0x38,
-  0x39, 0x38, 0x39, 0x30, 0x30, 0x39, 0x38, 0x35, 0x37, 0x32, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x33, 0x2e, 0x34, 0x30, 0x35, 0x34, 0x39, 0x36, 0x31,
-  0x30, 0x35, 0x35, 0x35, 0x31, 0x37, 0x31, 0x39, 0x36, 0x36, 0x36, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x34, 0x31, 0x30, 0x38, 0x34,
-  0x32, 0x35, 0x39, 0x37, 0x34, 0x38, 0x34, 0x35, 0x38, 0x38, 0x36, 0x32,
-  0x33, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x32, 0x2e, 0x39, 0x39, 0x34,
-  0x36, 0x35, 0x34, 0x34, 0x37, 0x36, 0x36, 0x34, 0x32, 0x36, 0x30, 0x38,
-  0x36, 0x34, 0x33, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x34, 0x2e, 0x35,
-  0x34, 0x31, 0x31, 0x33, 0x34, 0x35, 0x33, 0x36, 0x32, 0x36, 0x36, 0x33,
-  0x32, 0x36, 0x39, 0x30, 0x34, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x33,
-  0x2e, 0x36, 0x30, 0x33, 0x34, 0x37, 0x35, 0x36, 0x38, 0x39, 0x38, 0x38,
-  0x38, 0x30, 0x30, 0x30, 0x34, 0x38, 0x38, 0x65, 0x2d, 0x30, 0x31, 0x0a,
-  0x2d, 0x32, 0x2e, 0x31, 0x37, 0x31, 0x31, 0x34, 0x31, 0x39, 0x35, 0x32,
-  0x32, 0x37, 0x36, 0x32, 0x32, 0x39, 0x38, 0x35, 0x38, 0x65, 0x2d, 0x30,
-  0x31, 0x0a, 0x31, 0x2e, 0x37, 0x33, 0x30, 0x36, 0x33, 0x38, 0x35, 0x39,
-  0x33, 0x34, 0x33, 0x35, 0x32, 0x38, 0x37, 0x34, 0x37, 0x36, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x32, 0x2e, 0x31, 0x33, 0x35, 0x35, 0x32, 0x31, 0x33,
-  0x32, 0x32, 0x34, 0x38, 0x38, 0x37, 0x38, 0x34, 0x37, 0x39, 0x30, 0x65,
-  0x2d, 0x30, 0x31, 0x0a, 0x31, 0x2e, 0x38, 0x34, 0x37, 0x31, 0x37, 0x30,
-  0x31, 0x30, 0x37, 0x30, 0x36, 0x36, 0x36, 0x33, 0x31, 0x33, 0x31, 0x37,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x32, 0x30, 0x37, 0x35, 0x30,
-  0x39, 0x37, 0x38, 0x35, 0x38, 0x39, 0x30, 0x35, 0x37, 0x39, 0x32, 0x32,
-  0x34, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x33, 0x2e, 0x38, 0x33, 0x33, 0x33,
-  0x34, 0x36, 0x30, 0x36, 0x38, 0x38, 0x35, 0x39, 0x31, 0x30, 0x30, 0x33,
-  0x34, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x31, 0x39,
-  0x30, 0x32, 0x33, 0x33, 0x39, 0x33, 0x30, 0x39, 0x34, 0x35, 0x33, 0x39,
-  0x36, 0x34, 0x32, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e,
-  0x39, 0x30, 0x35, 0x39, 0x32, 0x37, 0x33, 0x38, 0x39, 0x38, 0x36, 0x30,
-  0x31, 0x35, 0x33, 0x31, 0x39, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x37, 0x2e, 0x37, 0x32, 0x34, 0x31, 0x31, 0x33, 0x37, 0x36, 0x32, 0x33,
-  0x37, 0x38, 0x36, 0x39, 0x32, 0x36, 0x32, 0x37, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x37, 0x2e, 0x35, 0x39, 0x30, 0x34, 0x31, 0x30, 0x31, 0x31,
-  0x33, 0x33, 0x33, 0x34, 0x36, 0x35, 0x35, 0x37, 0x36, 0x32, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x31, 0x39, 0x32, 0x32, 0x33, 0x30,
-  0x34, 0x37, 0x37, 0x39, 0x32, 0x39, 0x31, 0x31, 0x35, 0x32, 0x39, 0x35,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x33, 0x33, 0x37, 0x36,
-  0x33, 0x37, 0x37, 0x38, 0x32, 0x30, 0x39, 0x36, 0x38, 0x36, 0x32, 0x37,
-  0x39, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x36, 0x31,
-  0x37, 0x38, 0x34, 0x30, 0x37, 0x30, 0x37, 0x33, 0x30, 0x32, 0x30, 0x39,
-  0x33, 0x35, 0x30, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x38, 0x2e, 0x31,
-  0x39, 0x38, 0x39, 0x36, 0x34, 0x34, 0x30, 0x39, 0x35, 0x33, 0x30, 0x31,
-  0x36, 0x32, 0x38, 0x31, 0x31, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x32, 0x2e,
-  0x32, 0x39, 0x38, 0x37, 0x30, 0x39, 0x39, 0x33, 0x36, 0x34, 0x33, 0x39,
-  0x39, 0x39, 0x30, 0x39, 0x39, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33,
-  0x2e, 0x35, 0x30, 0x39, 0x30, 0x33, 0x30, 0x31, 0x31, 0x38, 0x35, 0x38,
-  0x34, 0x36, 0x33, 0x32, 0x38, 0x37, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x34, 0x2e, 0x38, 0x34, 0x38, 0x31, 0x33, 0x36, 0x33, 0x38, 0x30, 0x33,
-  0x31, 0x34, 0x38, 0x32, 0x36, 0x39, 0x36, 0x35, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x39, 0x2e, 0x33, 0x36, 0x32, 0x31, 0x33, 0x35, 0x38, 0x32,
-  0x37, 0x35, 0x34, 0x31, 0x33, 0x35, 0x31, 0x33, 0x31, 0x38, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x35, 0x2e, 0x39, 0x36, 0x33, 0x38, 0x31, 0x33, 0x31,
-  0x34, 0x30, 0x39, 0x38, 0x38, 0x33, 0x34, 0x39, 0x39, 0x31, 0x35, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x37, 0x35, 0x31, 0x38, 0x34,
-  0x33, 0x34, 0x34, 0x35, 0x30, 0x30, 0x33, 0x30, 0x33, 0x32, 0x36, 0x38,
-  0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x38, 0x31, 0x36, 0x37,
-  0x34, 0x31, 0x37, 0x32, 0x37, 0x32, 0x39, 0x32, 0x35, 0x33, 0x37, 0x36,
-  0x38, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x33, 0x36,
-  0x30, 0x30, 0x32, 0x34, 0x35, 0x34, 0x31, 0x36, 0x31, 0x36, 0x34, 0x33,
-  0x39, 0x38, 0x31, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e,
-  0x34, 0x31, 0x32, 0x30, 0x32, 0x34, 0x36, 0x34, 0x36, 0x39, 0x39, 0x37,
-  0x34, 0x35, 0x31, 0x37, 0x38, 0x32, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d,
-  0x32, 0x2e, 0x31, 0x39, 0x39, 0x39, 0x30, 0x37, 0x32, 0x32, 0x38, 0x33,
-  0x35, 0x30, 0x36, 0x33, 0x39, 0x33, 0x34, 0x33, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x31, 0x2e, 0x31, 0x33, 0x30, 0x37, 0x35, 0x38, 0x34, 0x34,
-  0x39, 0x34, 0x33, 0x35, 0x32, 0x33, 0x34, 0x30, 0x37, 0x30, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x31, 0x31, 0x30, 0x31, 0x31, 0x33,
-  0x32, 0x36, 0x33, 0x31, 0x33, 0x30, 0x31, 0x38, 0x37, 0x39, 0x38, 0x38,
-  0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e, 0x36, 0x31, 0x33, 0x39,
-  0x32, 0x34, 0x37, 0x34, 0x31, 0x37, 0x34, 0x34, 0x39, 0x39, 0x35, 0x31,
-  0x31, 0x37, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e, 0x32, 0x32,
-  0x39, 0x31, 0x35, 0x38, 0x30, 0x34, 0x33, 0x38, 0x36, 0x31, 0x33, 0x38,
-  0x39, 0x31, 0x36, 0x30, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x31, 0x2e,
-  0x30, 0x34, 0x37, 0x33, 0x38, 0x38, 0x33, 0x31, 0x35, 0x32, 0x30, 0x30,
-  0x38, 0x30, 0x35, 0x36, 0x36, 0x34, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x35,
-  0x2e, 0x36, 0x37, 0x32, 0x32, 0x30, 0x37, 0x34, 0x37, 0x34, 0x37, 0x30,
-  0x38, 0x35, 0x35, 0x37, 0x31, 0x32, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x31, 0x2e, 0x34, 0x31, 0x34, 0x36, 0x33, 0x38, 0x36, 0x30, 0x38, 0x36,
-  0x39, 0x34, 0x30, 0x37, 0x36, 0x35, 0x33, 0x38, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x38, 0x2e, 0x33, 0x38, 0x31, 0x30, 0x32, 0x39, 0x32, 0x31, 0x38,
-  0x34, 0x33, 0x35, 0x32, 0x38, 0x37, 0x34, 0x37, 0x36, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x33, 0x36, 0x32, 0x35, 0x31, 0x30, 0x35,
-  0x38, 0x34, 0x32, 0x39, 0x34, 0x37, 0x39, 0x35, 0x39, 0x39, 0x30, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x33, 0x32, 0x36, 0x39, 0x35, 0x33,
-  0x39, 0x39, 0x32, 0x32, 0x34, 0x37, 0x35, 0x38, 0x31, 0x34, 0x38, 0x32,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x34, 0x33, 0x38, 0x38, 0x34,
-  0x36, 0x37, 0x32, 0x32, 0x32, 0x34, 0x35, 0x32, 0x31, 0x36, 0x33, 0x37,
-  0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x39, 0x30, 0x31, 0x34,
-  0x31, 0x32, 0x35, 0x30, 0x31, 0x39, 0x33, 0x31, 0x31, 0x39, 0x30, 0x34,
-  0x39, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x39, 0x30,
-  0x34, 0x34, 0x36, 0x38, 0x34, 0x32, 0x34, 0x36, 0x31, 0x38, 0x32, 0x34,
-  0x34, 0x31, 0x37, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e,
-  0x36, 0x33, 0x36, 0x39, 0x38, 0x35, 0x39, 0x37, 0x32, 0x35, 0x32, 0x33,
-  0x36, 0x38, 0x39, 0x32, 0x37, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x38, 0x2e, 0x34, 0x34, 0x35, 0x35, 0x37, 0x32, 0x38, 0x35, 0x33, 0x30,
-  0x38, 0x38, 0x33, 0x37, 0x38, 0x39, 0x30, 0x36, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x36, 0x2e, 0x35, 0x39, 0x32, 0x31, 0x31, 0x35, 0x37, 0x35, 0x39,
-  0x38, 0x34, 0x39, 0x35, 0x34, 0x38, 0x33, 0x34, 0x30, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x34, 0x2e, 0x36, 0x34, 0x37, 0x34, 0x30, 0x38, 0x37, 0x39,
-  0x38, 0x33, 0x33, 0x36, 0x39, 0x38, 0x32, 0x37, 0x32, 0x37, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x37, 0x34, 0x35, 0x38, 0x37, 0x31,
-  0x39, 0x34, 0x36, 0x32, 0x31, 0x35, 0x36, 0x32, 0x39, 0x35, 0x37, 0x38,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x33, 0x31, 0x33, 0x34, 0x36,
-  0x39, 0x33, 0x30, 0x35, 0x36, 0x33, 0x34, 0x34, 0x39, 0x38, 0x35, 0x39,
-  0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x32, 0x33, 0x32,
-  0x31, 0x35, 0x30, 0x31, 0x35, 0x32, 0x33, 0x32, 0x35, 0x36, 0x33, 0x30,
-  0x31, 0x38, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x31, 0x32,
-  0x31, 0x34, 0x34, 0x39, 0x39, 0x36, 0x32, 0x32, 0x35, 0x38, 0x33, 0x33,
-  0x38, 0x39, 0x32, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e,
-  0x34, 0x30, 0x37, 0x32, 0x31, 0x35, 0x34, 0x36, 0x34, 0x38, 0x36, 0x30,
-  0x32, 0x30, 0x30, 0x38, 0x38, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x36, 0x2e, 0x30, 0x31, 0x30, 0x31, 0x34, 0x33, 0x38, 0x33, 0x31, 0x33,
-  0x37, 0x32, 0x32, 0x36, 0x31, 0x30, 0x34, 0x37, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x35, 0x2e, 0x32, 0x36, 0x34, 0x31, 0x38, 0x39, 0x34, 0x36,
-  0x36, 0x38, 0x33, 0x34, 0x30, 0x36, 0x38, 0x32, 0x39, 0x38, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x38, 0x37, 0x37, 0x31, 0x33, 0x34,
-  0x35, 0x32, 0x38, 0x30, 0x31, 0x31, 0x30, 0x38, 0x33, 0x36, 0x30, 0x33,
-  0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x33, 0x2e, 0x33, 0x36, 0x39, 0x37,
-  0x35, 0x34, 0x31, 0x38, 0x30, 0x33, 0x31, 0x32, 0x31, 0x35, 0x36, 0x36,
-  0x37, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x34, 0x31,
-  0x37, 0x35, 0x35, 0x33, 0x35, 0x37, 0x33, 0x38, 0x34, 0x36, 0x38, 0x31,
-  0x37, 0x30, 0x31, 0x37, 0x65, 0x2d, 0x30, 0x31, 0x0a, 0x2d, 0x32, 0x2e,
-  0x33, 0x37, 0x37, 0x32, 0x34, 0x36, 0x37, 0x33, 0x39, 0x33, 0x34, 0x32,
-  0x38, 0x30, 0x38, 0x37, 0x32, 0x33, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d,
-  0x31, 0x2e, 0x34, 0x35, 0x32, 0x39, 0x37, 0x39, 0x38, 0x39, 0x32, 0x34,
-  0x39, 0x32, 0x32, 0x39, 0x34, 0x33, 0x31, 0x32, 0x65, 0x2d, 0x30, 0x31,
-  0x0a, 0x2d, 0x31, 0x2e, 0x34, 0x30, 0x33, 0x30, 0x39, 0x33, 0x39, 0x33,
-  0x34, 0x30, 0x35, 0x39, 0x31, 0x34, 0x33, 0x30, 0x36, 0x36, 0x65, 0x2d,
-  0x30, 0x31, 0x0a, 0x2d, 0x35, 0x2e, 0x36, 0x38, 0x30, 0x38, 0x33, 0x34,
-  0x38, 0x37, 0x34, 0x35, 0x31, 0x30, 0x37, 0x36, 0x35, 0x30, 0x37, 0x36,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x39, 0x38, 0x35, 0x35,
-  0x38, 0x34, 0x35, 0x37, 0x31, 0x39, 0x35, 0x37, 0x35, 0x38, 0x38, 0x31,
-  0x39, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x36, 0x38, 0x34,
-  0x33, 0x36, 0x32, 0x31, 0x34, 0x33, 0x32, 0x37, 0x38, 0x31, 0x32, 0x31,
-  0x39, 0x34, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x37, 0x35,
-  0x38, 0x33, 0x39, 0x37, 0x37, 0x34, 0x33, 0x31, 0x30, 0x35, 0x38, 0x38,
-  0x38, 0x33, 0x36, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x39, 0x2e, 0x39,
-  0x37, 0x37, 0x31, 0x31, 0x33, 0x34, 0x35, 0x35, 0x35, 0x33, 0x33, 0x39,
-  0x38, 0x31, 0x33, 0x32, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36,
-  0x2e, 0x32, 0x38, 0x39, 0x33, 0x36, 0x31, 0x34, 0x31, 0x37, 0x32, 0x39,
-  0x33, 0x35, 0x34, 0x38, 0x35, 0x38, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x33, 0x2e, 0x37, 0x31, 0x34, 0x38, 0x37, 0x30, 0x32, 0x38, 0x38, 0x39,
-  0x36, 0x38, 0x30, 0x38, 0x36, 0x32, 0x34, 0x33, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x32, 0x2e, 0x38, 0x30, 0x36, 0x36, 0x35, 0x30, 0x36, 0x36,
-  0x30, 0x39, 0x33, 0x32, 0x30, 0x36, 0x34, 0x30, 0x35, 0x36, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x34, 0x32, 0x38, 0x38, 0x34, 0x37,
-  0x33, 0x36, 0x35, 0x30, 0x38, 0x31, 0x33, 0x31, 0x30, 0x32, 0x37, 0x32,
-  0x65, 0x2d, 0x30, 0x33, 0x0a, 0x36, 0x2e, 0x36, 0x33, 0x32, 0x34, 0x37,
-  0x32, 0x35, 0x37, 0x34, 0x37, 0x31, 0x30, 0x38, 0x34, 0x35, 0x39, 0x34,
-  0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x33, 0x38, 0x34,
-  0x30, 0x35, 0x38, 0x32, 0x39, 0x36, 0x36, 0x38, 0x30, 0x34, 0x35, 0x30,
-  0x34, 0x33, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x37,
-  0x33, 0x36, 0x36, 0x34, 0x38, 0x30, 0x37, 0x39, 0x30, 0x30, 0x37, 0x38,
-  0x36, 0x33, 0x39, 0x39, 0x38, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x36,
-  0x2e, 0x36, 0x36, 0x38, 0x38, 0x34, 0x37, 0x37, 0x39, 0x39, 0x33, 0x30,
-  0x31, 0x31, 0x34, 0x37, 0x34, 0x36, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x31, 0x2e, 0x38, 0x39, 0x31, 0x34, 0x34, 0x37, 0x30, 0x34, 0x34, 0x39,
-  0x30, 0x39, 0x30, 0x30, 0x30, 0x33, 0x39, 0x37, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x32, 0x2e, 0x32, 0x36, 0x36, 0x31, 0x34, 0x35, 0x37, 0x37, 0x36,
-  0x39, 0x35, 0x37, 0x32, 0x37, 0x33, 0x34, 0x38, 0x33, 0x65, 0x2d, 0x30,
-  0x33, 0x0a, 0x34, 0x2e, 0x39, 0x39, 0x38, 0x35, 0x33, 0x39, 0x37, 0x36,
-  0x30, 0x37, 0x30, 0x38, 0x38, 0x30, 0x38, 0x38, 0x39, 0x39, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x38, 0x34, 0x38, 0x33, 0x32, 0x31,
-  0x33, 0x36, 0x33, 0x33, 0x32, 0x39, 0x38, 0x38, 0x37, 0x33, 0x39, 0x30,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x31, 0x34, 0x34, 0x39, 0x31,
-  0x38, 0x37, 0x35, 0x34, 0x36, 0x39, 0x36, 0x38, 0x34, 0x36, 0x30, 0x30,
-  0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x35, 0x36, 0x33, 0x34,
-  0x30, 0x39, 0x38, 0x33, 0x35, 0x31, 0x30, 0x30, 0x31, 0x37, 0x33, 0x39,
-  0x35, 0x30, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x32, 0x2e, 0x37, 0x39,
-  0x34, 0x37, 0x30, 0x39, 0x36, 0x31, 0x35, 0x34, 0x30, 0x39, 0x33, 0x37,
-  0x34, 0x32, 0x33, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x39,
-  0x36, 0x36, 0x30, 0x31, 0x31, 0x35, 0x39, 0x38, 0x37, 0x30, 0x36, 0x32,
-  0x34, 0x35, 0x34, 0x32, 0x32, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x32,
-  0x2e, 0x34, 0x30, 0x30, 0x36, 0x32, 0x39, 0x30, 0x33, 0x36, 0x31, 0x32,
-  0x38, 0x35, 0x32, 0x30, 0x39, 0x36, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x36, 0x2e, 0x34, 0x38, 0x35, 0x32, 0x32, 0x33, 0x37, 0x37, 0x30,
-  0x31, 0x34, 0x31, 0x36, 0x30, 0x31, 0x35, 0x36, 0x32, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x34, 0x31, 0x37, 0x34, 0x33, 0x33, 0x30,
-  0x37, 0x35, 0x36, 0x30, 0x36, 0x38, 0x32, 0x32, 0x39, 0x36, 0x38, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x34, 0x32, 0x34, 0x37, 0x35, 0x39,
-  0x31, 0x36, 0x34, 0x34, 0x35, 0x32, 0x35, 0x35, 0x32, 0x37, 0x39, 0x35,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x32, 0x36, 0x35, 0x36, 0x36,
-  0x33, 0x39, 0x33, 0x36, 0x37, 0x33, 0x34, 0x31, 0x39, 0x39, 0x35, 0x32,
-  0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34, 0x2e, 0x39, 0x35, 0x30,
-  0x30, 0x30, 0x31, 0x34, 0x36, 0x33, 0x32, 0x39, 0x34, 0x30, 0x32, 0x39,
-  0x32, 0x33, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x37,
-  0x35, 0x33, 0x31, 0x33, 0x37, 0x38, 0x34, 0x33, 0x36, 0x38, 0x33, 0x33,
-  0x36, 0x32, 0x30, 0x30, 0x37, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x32,
-  0x2e, 0x33, 0x38, 0x36, 0x32, 0x33, 0x31, 0x33, 0x34, 0x37, 0x39, 0x31,
-  0x38, 0x35, 0x31, 0x30, 0x34, 0x33, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x34, 0x2e, 0x37, 0x37, 0x31, 0x38, 0x35, 0x34, 0x33, 0x35, 0x35, 0x39,
-  0x33, 0x31, 0x32, 0x38, 0x32, 0x30, 0x34, 0x33, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x32, 0x2e, 0x35, 0x37, 0x31, 0x32, 0x33, 0x33, 0x39, 0x32, 0x30,
-  0x37, 0x35, 0x33, 0x30, 0x30, 0x32, 0x31, 0x36, 0x37, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x38, 0x35, 0x38, 0x35, 0x31, 0x37, 0x32,
-  0x32, 0x39, 0x35, 0x35, 0x37, 0x30, 0x33, 0x37, 0x33, 0x35, 0x34, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x39, 0x34, 0x34, 0x39, 0x36, 0x39,
-  0x38, 0x33, 0x32, 0x38, 0x39, 0x37, 0x31, 0x38, 0x36, 0x32, 0x37, 0x39,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x30, 0x34, 0x39, 0x35,
-  0x35, 0x36, 0x38, 0x36, 0x36, 0x32, 0x38, 0x38, 0x31, 0x38, 0x35, 0x31,
-  0x32, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x33, 0x39,
-  0x30, 0x32, 0x37, 0x31, 0x33, 0x35, 0x34, 0x34, 0x36, 0x36, 0x36, 0x37,
-  0x36, 0x37, 0x31, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x34,
-  0x33, 0x32, 0x33, 0x31, 0x37, 0x34, 0x37, 0x32, 0x39, 0x39, 0x34, 0x33,
-  0x32, 0x37, 0x35, 0x34, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e,
-  0x35, 0x34, 0x34, 0x34, 0x39, 0x33, 0x30, 0x34, 0x31, 0x39, 0x33, 0x32,
-  0x35, 0x38, 0x32, 0x38, 0x35, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32,
-  0x2e, 0x36, 0x38, 0x36, 0x39, 0x39, 0x39, 0x35, 0x35, 0x31, 0x39, 0x35,
-  0x31, 0x38, 0x38, 0x35, 0x32, 0x32, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x31, 0x2e, 0x39, 0x32, 0x30, 0x31, 0x35, 0x35, 0x36, 0x32, 0x32, 0x30,
-  0x36, 0x35, 0x30, 0x36, 0x37, 0x32, 0x39, 0x31, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x35, 0x2e, 0x33, 0x37, 0x30, 0x35, 0x31, 0x38, 0x39, 0x33,
-  0x37, 0x37, 0x30, 0x36, 0x39, 0x34, 0x37, 0x33, 0x32, 0x37, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x34, 0x35, 0x34, 0x39, 0x31, 0x34,
-  0x38, 0x32, 0x36, 0x38, 0x39, 0x39, 0x37, 0x36, 0x36, 0x39, 0x32, 0x32,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x32, 0x32, 0x32, 0x38,
-  0x36, 0x38, 0x35, 0x34, 0x36, 0x38, 0x34, 0x33, 0x35, 0x32, 0x38, 0x37,
-  0x34, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x31, 0x38,
-  0x30, 0x39, 0x32, 0x37, 0x37, 0x33, 0x34, 0x38, 0x32, 0x32, 0x30, 0x33,
-  0x34, 0x38, 0x33, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e,
-  0x38, 0x32, 0x38, 0x36, 0x35, 0x36, 0x33, 0x37, 0x35, 0x34, 0x30, 0x38,
-  0x31, 0x37, 0x32, 0x36, 0x30, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31,
-  0x2e, 0x34, 0x35, 0x35, 0x32, 0x38, 0x31, 0x35, 0x38, 0x31, 0x37, 0x32,
-  0x39, 0x36, 0x35, 0x30, 0x34, 0x39, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x36, 0x2e, 0x38, 0x37, 0x34, 0x32, 0x38, 0x32, 0x36, 0x35, 0x38, 0x31,
-  0x30, 0x30, 0x31, 0x32, 0x38, 0x31, 0x37, 0x34, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x32, 0x2e, 0x37, 0x30, 0x30, 0x30, 0x38, 0x34, 0x36, 0x33, 0x34,
-  0x31, 0x32, 0x35, 0x32, 0x33, 0x32, 0x36, 0x39, 0x37, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x36, 0x39, 0x35, 0x32, 0x35, 0x32, 0x31,
-  0x38, 0x37, 0x35, 0x35, 0x30, 0x30, 0x36, 0x37, 0x39, 0x30, 0x32, 0x65,
-  0x2d, 0x30, 0x33, 0x0a, 0x37, 0x2e, 0x30, 0x38, 0x37, 0x36, 0x36, 0x31,
-  0x33, 0x32, 0x35, 0x39, 0x33, 0x31, 0x35, 0x34, 0x39, 0x30, 0x37, 0x32,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x30, 0x33, 0x37, 0x30, 0x35,
-  0x35, 0x37, 0x31, 0x39, 0x36, 0x34, 0x33, 0x38, 0x33, 0x31, 0x32, 0x35,
-  0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x39, 0x2e, 0x34, 0x30, 0x31,
-  0x37, 0x35, 0x30, 0x35, 0x36, 0x34, 0x35, 0x37, 0x35, 0x31, 0x39, 0x35,
-  0x33, 0x31, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x39, 0x2e, 0x31,
-  0x38, 0x37, 0x32, 0x31, 0x37, 0x30, 0x35, 0x36, 0x37, 0x35, 0x31, 0x32,
-  0x35, 0x31, 0x32, 0x32, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x32,
-  0x2e, 0x34, 0x30, 0x32, 0x34, 0x35, 0x32, 0x31, 0x39, 0x33, 0x32, 0x30,
-  0x30, 0x35, 0x38, 0x38, 0x32, 0x32, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x37, 0x2e, 0x31, 0x30, 0x37, 0x35, 0x32, 0x39, 0x30, 0x34, 0x34, 0x31,
-  0x35, 0x31, 0x33, 0x30, 0x36, 0x31, 0x35, 0x32, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x38, 0x2e, 0x36, 0x36, 0x34, 0x34, 0x39, 0x30, 0x32, 0x38,
-  0x32, 0x35, 0x33, 0x35, 0x35, 0x35, 0x32, 0x39, 0x37, 0x39, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x35, 0x38, 0x34, 0x37, 0x30, 0x37,
-  0x39, 0x37, 0x35, 0x33, 0x38, 0x37, 0x35, 0x37, 0x33, 0x32, 0x34, 0x32,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x32, 0x34, 0x37, 0x37,
-  0x35, 0x39, 0x34, 0x34, 0x32, 0x37, 0x37, 0x36, 0x34, 0x34, 0x31, 0x35,
-  0x37, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x38, 0x35,
-  0x33, 0x33, 0x36, 0x37, 0x36, 0x34, 0x31, 0x35, 0x36, 0x38, 0x31, 0x38,
-  0x33, 0x38, 0x39, 0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e,
-  0x33, 0x31, 0x33, 0x30, 0x34, 0x39, 0x37, 0x39, 0x33, 0x32, 0x34, 0x33,
-  0x34, 0x30, 0x38, 0x32, 0x30, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d,
-  0x36, 0x2e, 0x33, 0x30, 0x33, 0x37, 0x36, 0x37, 0x31, 0x31, 0x34, 0x38,
-  0x37, 0x37, 0x37, 0x30, 0x30, 0x38, 0x30, 0x36, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x34, 0x2e, 0x32, 0x34, 0x34, 0x39, 0x34, 0x39, 0x32, 0x39,
-  0x36, 0x31, 0x31, 0x36, 0x38, 0x32, 0x38, 0x39, 0x31, 0x38, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x39, 0x38, 0x36, 0x35, 0x34, 0x32,
-  0x32, 0x35, 0x30, 0x39, 0x36, 0x31, 0x30, 0x36, 0x35, 0x32, 0x39, 0x32,
-  0x65, 0x2d, 0x30, 0x33, 0x0a, 0x32, 0x2e, 0x36, 0x33, 0x32, 0x32, 0x32,
-  0x38, 0x34, 0x37, 0x31, 0x33, 0x33, 0x38, 0x37, 0x34, 0x38, 0x39, 0x33,
-  0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e, 0x33, 0x33, 0x33,
-  0x31, 0x37, 0x35, 0x31, 0x33, 0x33, 0x39, 0x31, 0x33, 0x37, 0x35, 0x35,
-  0x34, 0x31, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x38,
-  0x32, 0x39, 0x38, 0x33, 0x33, 0x35, 0x36, 0x37, 0x31, 0x34, 0x32, 0x34,
-  0x38, 0x36, 0x35, 0x37, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e,
-  0x32, 0x30, 0x30, 0x37, 0x35, 0x39, 0x31, 0x33, 0x31, 0x34, 0x36, 0x31,
-  0x33, 0x38, 0x31, 0x39, 0x31, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33,
-  0x2e, 0x34, 0x38, 0x31, 0x36, 0x34, 0x37, 0x37, 0x34, 0x34, 0x37, 0x37,
-  0x34, 0x38, 0x31, 0x38, 0x34, 0x32, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x36, 0x2e, 0x37, 0x32, 0x37, 0x32, 0x34, 0x35, 0x34, 0x35, 0x30, 0x30,
-  0x31, 0x39, 0x38, 0x33, 0x36, 0x34, 0x32, 0x36, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x36, 0x2e, 0x38, 0x33, 0x30, 0x32, 0x34, 0x36, 0x37, 0x34, 0x36,
-  0x35, 0x34, 0x30, 0x30, 0x36, 0x39, 0x35, 0x38, 0x30, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x37, 0x2e, 0x33, 0x35, 0x32, 0x32, 0x32, 0x31, 0x30, 0x31,
-  0x32, 0x31, 0x31, 0x35, 0x34, 0x37, 0x38, 0x35, 0x31, 0x36, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x35, 0x2e, 0x30, 0x38, 0x34, 0x30, 0x39, 0x36, 0x32,
-  0x36, 0x37, 0x38, 0x31, 0x39, 0x34, 0x30, 0x34, 0x36, 0x30, 0x32, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x34, 0x39, 0x37, 0x33, 0x35, 0x34,
-  0x31, 0x30, 0x35, 0x31, 0x31, 0x34, 0x39, 0x33, 0x36, 0x38, 0x32, 0x39,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x30, 0x32, 0x35, 0x38, 0x32,
-  0x38, 0x36, 0x39, 0x36, 0x37, 0x38, 0x37, 0x33, 0x35, 0x37, 0x33, 0x33,
-  0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x37, 0x33, 0x36, 0x35,
-  0x38, 0x38, 0x34, 0x37, 0x38, 0x30, 0x38, 0x38, 0x33, 0x37, 0x38, 0x39,
-  0x30, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x33, 0x37, 0x30,
-  0x31, 0x31, 0x39, 0x34, 0x32, 0x32, 0x36, 0x37, 0x34, 0x31, 0x37, 0x39,
-  0x30, 0x37, 0x37, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x38, 0x2e, 0x30,
-  0x38, 0x39, 0x37, 0x31, 0x32, 0x38, 0x32, 0x30, 0x39, 0x34, 0x37, 0x31,
-  0x37, 0x30, 0x32, 0x35, 0x38, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x35,
-  0x2e, 0x36, 0x31, 0x36, 0x33, 0x31, 0x32, 0x38, 0x34, 0x36, 0x35, 0x34,
-  0x31, 0x34, 0x30, 0x34, 0x37, 0x32, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x38, 0x2e, 0x30, 0x38, 0x38, 0x34, 0x38, 0x33, 0x34, 0x37, 0x35,
-  0x31, 0x34, 0x38, 0x36, 0x37, 0x37, 0x38, 0x32, 0x36, 0x65, 0x2d, 0x30,
-  0x33, 0x0a, 0x32, 0x2e, 0x37, 0x38, 0x31, 0x31, 0x34, 0x33, 0x32, 0x32,
-  0x35, 0x37, 0x32, 0x39, 0x34, 0x36, 0x35, 0x34, 0x38, 0x35, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x31, 0x2e, 0x38, 0x30, 0x39, 0x36, 0x36, 0x32, 0x30,
-  0x32, 0x31, 0x36, 0x39, 0x36, 0x35, 0x36, 0x37, 0x35, 0x33, 0x35, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x35, 0x33, 0x32, 0x36, 0x39,
-  0x32, 0x34, 0x39, 0x32, 0x30, 0x30, 0x38, 0x32, 0x30, 0x39, 0x32, 0x32,
-  0x39, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x36, 0x31, 0x38, 0x34,
-  0x31, 0x34, 0x38, 0x31, 0x39, 0x32, 0x34, 0x30, 0x35, 0x37, 0x30, 0x30,
-  0x36, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x35, 0x38,
-  0x31, 0x37, 0x31, 0x38, 0x33, 0x31, 0x30, 0x37, 0x31, 0x33, 0x37, 0x36,
-  0x38, 0x30, 0x30, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x30,
-  0x30, 0x30, 0x35, 0x35, 0x33, 0x38, 0x38, 0x33, 0x36, 0x31, 0x32, 0x31,
-  0x35, 0x35, 0x39, 0x31, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37,
-  0x2e, 0x34, 0x31, 0x31, 0x31, 0x39, 0x38, 0x33, 0x31, 0x38, 0x30, 0x30,
-  0x34, 0x36, 0x30, 0x38, 0x31, 0x35, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x36, 0x2e, 0x38, 0x35, 0x35, 0x37, 0x31, 0x31, 0x33, 0x34, 0x30, 0x39,
-  0x30, 0x34, 0x32, 0x33, 0x35, 0x38, 0x34, 0x30, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x31, 0x2e, 0x37, 0x37, 0x30, 0x35, 0x37, 0x31, 0x30, 0x36, 0x30,
-  0x34, 0x37, 0x38, 0x36, 0x38, 0x37, 0x32, 0x38, 0x36, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x37, 0x2e, 0x39, 0x36, 0x33, 0x37, 0x38, 0x38, 0x35, 0x30,
-  0x39, 0x33, 0x36, 0x38, 0x38, 0x39, 0x36, 0x34, 0x38, 0x34, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x36, 0x2e, 0x33, 0x31, 0x39, 0x38, 0x37, 0x30, 0x30,
-  0x35, 0x34, 0x37, 0x32, 0x31, 0x38, 0x33, 0x32, 0x32, 0x37, 0x35, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x31, 0x2e, 0x37, 0x30, 0x38, 0x35, 0x38, 0x35,
-  0x32, 0x31, 0x30, 0x31, 0x34, 0x34, 0x35, 0x31, 0x39, 0x38, 0x30, 0x36,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x35, 0x32, 0x31, 0x32,
-  0x35, 0x37, 0x37, 0x35, 0x38, 0x31, 0x34, 0x30, 0x35, 0x36, 0x33, 0x39,
-  0x36, 0x35, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33, 0x2e, 0x37, 0x34,
-  0x37, 0x33, 0x37, 0x30, 0x35, 0x35, 0x39, 0x37, 0x32, 0x32, 0x31, 0x38,
-  0x35, 0x31, 0x33, 0x35, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x34, 0x2e,
-  0x33, 0x39, 0x32, 0x30, 0x30, 0x38, 0x31, 0x31, 0x30, 0x38, 0x38, 0x30,
-  0x38, 0x35, 0x31, 0x37, 0x34, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34,
-  0x2e, 0x33, 0x33, 0x37, 0x37, 0x32, 0x30, 0x39, 0x34, 0x35, 0x34, 0x37,
-  0x37, 0x34, 0x38, 0x35, 0x36, 0x35, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x39, 0x2e, 0x32, 0x37, 0x35, 0x39, 0x30, 0x31, 0x33, 0x31, 0x37,
-  0x35, 0x39, 0x36, 0x34, 0x33, 0x35, 0x35, 0x34, 0x37, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x32, 0x2e, 0x30, 0x38, 0x30, 0x34, 0x38, 0x30, 0x35,
-  0x36, 0x38, 0x31, 0x31, 0x30, 0x39, 0x34, 0x32, 0x38, 0x34, 0x31, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x32, 0x39, 0x30, 0x39, 0x34,
-  0x31, 0x33, 0x33, 0x35, 0x32, 0x36, 0x30, 0x38, 0x36, 0x38, 0x30, 0x37,
-  0x33, 0x65, 0x2d, 0x30, 0x33, 0x0a, 0x2d, 0x38, 0x2e, 0x37, 0x34, 0x39,
-  0x38, 0x30, 0x39, 0x38, 0x36, 0x31, 0x31, 0x38, 0x33, 0x31, 0x36, 0x36,
-  0x35, 0x30, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x38, 0x35,
-  0x33, 0x30, 0x38, 0x38, 0x30, 0x33, 0x36, 0x31, 0x37, 0x39, 0x35, 0x34,
-  0x32, 0x35, 0x34, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e,
-  0x38, 0x35, 0x39, 0x31, 0x39, 0x39, 0x35, 0x33, 0x38, 0x38, 0x32, 0x36,
-  0x39, 0x34, 0x32, 0x34, 0x34, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x32,
-  0x2e, 0x31, 0x36, 0x36, 0x38, 0x37, 0x37, 0x38, 0x37, 0x33, 0x32, 0x34,
-  0x31, 0x39, 0x30, 0x31, 0x33, 0x39, 0x38, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x39, 0x2e, 0x38, 0x30, 0x34, 0x37, 0x38, 0x32, 0x34, 0x35, 0x37,
-  0x36, 0x34, 0x39, 0x37, 0x30, 0x37, 0x37, 0x39, 0x34, 0x65, 0x2d, 0x30,
-  0x33, 0x0a, 0x31, 0x2e, 0x35, 0x37, 0x34, 0x32, 0x32, 0x32, 0x37, 0x34,
-  0x33, 0x35, 0x31, 0x31, 0x31, 0x39, 0x39, 0x39, 0x35, 0x31, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x34, 0x2e, 0x37, 0x38, 0x38, 0x31, 0x36, 0x35, 0x31,
-  0x36, 0x36, 0x39, 0x37, 0x34, 0x30, 0x36, 0x37, 0x36, 0x38, 0x38, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x33, 0x34, 0x31, 0x39, 0x39, 0x30,
-  0x38, 0x32, 0x38, 0x35, 0x31, 0x34, 0x30, 0x39, 0x39, 0x31, 0x32, 0x31,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x36, 0x2e, 0x30, 0x36, 0x31, 0x34,
-  0x36, 0x37, 0x39, 0x30, 0x30, 0x38, 0x37, 0x32, 0x32, 0x33, 0x30, 0x35,
-  0x33, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x37, 0x30,
-  0x37, 0x30, 0x31, 0x32, 0x32, 0x33, 0x36, 0x31, 0x31, 0x38, 0x33, 0x31,
-  0x36, 0x36, 0x35, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x31, 0x2e,
-  0x35, 0x33, 0x32, 0x31, 0x39, 0x30, 0x37, 0x35, 0x38, 0x37, 0x33, 0x34,
-  0x39, 0x34, 0x31, 0x34, 0x38, 0x33, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33,
-  0x2e, 0x38, 0x38, 0x34, 0x35, 0x34, 0x35, 0x33, 0x34, 0x31, 0x31, 0x33,
-  0x34, 0x30, 0x37, 0x31, 0x33, 0x35, 0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x35, 0x2e, 0x39, 0x31, 0x39, 0x32, 0x33, 0x30, 0x33, 0x35, 0x36,
-  0x38, 0x31, 0x32, 0x34, 0x37, 0x37, 0x31, 0x31, 0x32, 0x65, 0x2d, 0x30,
-  0x32, 0x0a, 0x2d, 0x38, 0x2e, 0x37, 0x30, 0x37, 0x33, 0x34, 0x36, 0x30,
-  0x32, 0x32, 0x31, 0x32, 0x39, 0x30, 0x35, 0x38, 0x38, 0x33, 0x38, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x31, 0x37, 0x33, 0x38, 0x39, 0x37,
-  0x33, 0x32, 0x35, 0x39, 0x39, 0x32, 0x35, 0x38, 0x34, 0x32, 0x32, 0x39,
-  0x65, 0x2d, 0x30, 0x32, 0x0a, 0x35, 0x2e, 0x38, 0x31, 0x37, 0x36, 0x36,
-  0x36, 0x32, 0x37, 0x37, 0x32, 0x38, 0x39, 0x33, 0x39, 0x30, 0x35, 0x36,
-  0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x36, 0x2e, 0x30, 0x34, 0x33, 0x36,
-  0x30, 0x36, 0x36, 0x32, 0x34, 0x30, 0x30, 0x37, 0x32, 0x32, 0x35, 0x30,
-  0x33, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x37, 0x2e, 0x33, 0x30,
-  0x31, 0x33, 0x35, 0x35, 0x38, 0x39, 0x38, 0x33, 0x38, 0x30, 0x32, 0x37,
-  0x39, 0x35, 0x34, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x37, 0x2e, 0x37,
-  0x38, 0x31, 0x32, 0x31, 0x33, 0x35, 0x32, 0x31, 0x39, 0x35, 0x37, 0x33,
-  0x39, 0x37, 0x34, 0x36, 0x31, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x33,
-  0x2e, 0x33, 0x32, 0x35, 0x33, 0x31, 0x34, 0x34, 0x34, 0x37, 0x32, 0x38,
-  0x33, 0x37, 0x34, 0x34, 0x38, 0x31, 0x32, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x2d, 0x38, 0x2e, 0x37, 0x33, 0x37, 0x36, 0x37, 0x38, 0x36, 0x33, 0x39,
-  0x35, 0x39, 0x30, 0x37, 0x34, 0x30, 0x32, 0x30, 0x34, 0x65, 0x2d, 0x30,
-  0x33, 0x0a, 0x36, 0x2e, 0x32, 0x32, 0x37, 0x34, 0x33, 0x31, 0x30, 0x37,
-  0x33, 0x37, 0x38, 0x34, 0x38, 0x32, 0x38, 0x31, 0x38, 0x36, 0x65, 0x2d,
-  0x30, 0x32, 0x0a, 0x31, 0x2e, 0x36, 0x30, 0x37, 0x34, 0x31, 0x39, 0x31,
-  0x37, 0x37, 0x38, 0x38, 0x39, 0x38, 0x32, 0x33, 0x39, 0x31, 0x34, 0x65,
-  0x2d, 0x30, 0x32, 0x0a, 0x32, 0x2e, 0x39, 0x34, 0x36, 0x39, 0x39, 0x31,
-  0x32, 0x34, 0x30, 0x36, 0x30, 0x35, 0x37, 0x31, 0x31, 0x39, 0x33, 0x37,
-  0x65, 0x2d, 0x30, 0x33, 0x0a, 0x36, 0x2e, 0x36, 0x30, 0x34, 0x36, 0x31,
-  0x30, 0x33, 0x38, 0x33, 0x35, 0x31, 0x30, 0x35, 0x38, 0x39, 0x36, 0x30,
-  0x30, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x33, 0x2e, 0x37, 0x39, 0x30, 0x30,
-  0x34, 0x32, 0x31, 0x37, 0x36, 0x38, 0x34, 0x32, 0x36, 0x38, 0x39, 0x35,
-  0x31, 0x34, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x35, 0x2e, 0x38, 0x39,
-  0x39, 0x34, 0x37, 0x30, 0x36, 0x37, 0x32, 0x30, 0x31, 0x31, 0x33, 0x37,
-  0x35, 0x34, 0x32, 0x37, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x34, 0x2e, 0x35,
-  0x32, 0x37, 0x35, 0x33, 0x36, 0x34, 0x30, 0x37, 0x31, 0x31, 0x33, 0x30,
-  0x37, 0x35, 0x32, 0x35, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a, 0x2d, 0x34,
-  0x2e, 0x34, 0x33, 0x36, 0x34, 0x36, 0x32, 0x30, 0x30, 0x30, 0x30, 0x31,
-  0x32, 0x33, 0x39, 0x37, 0x37, 0x36, 0x36, 0x65, 0x2d, 0x30, 0x32, 0x0a,
-  0x33, 0x2e, 0x38, 0x32, 0x35, 0x31, 0x31, 0x32, 0x30, 0x35, 0x39, 0x37,
-  0x31, 0x32, 0x34, 0x30, 0x39, 0x39, 0x37, 0x33, 0x65, 0x2d, 0x30, 0x32,
-  0x0a, 0x2d, 0x34, 0x2e, 0x31, 0x32, 0x36, 0x37, 0x39, 0x33, 0x35, 0x31,
-  0x38, 0x36, 0x36, 0x32, 0x34, 0x35, 0x32, 0x36, 0x39, 0x38, 0x65, 0x2d,
-  0x30, 0x32, 0x0a
-};
-unsigned int weights_layer1_txt_len = 19995;
@@ -1,6 +0,0 @@
-unsigned char biases_layer1_txt[] = {
-  0x2d, 0x36, 0x2e, 0x39, 0x32, 0x30, 0x34, 0x36, 0x34, 0x33, 0x33, 0x36,
-  0x38, 0x37, 0x32, 0x31, 0x30, 0x30, 0x38, 0x33, 0x30, 0x65, 0x2d, 0x30,
-  0x33, 0x0a
-};
-unsigned int biases_layer1_txt_len = 26;
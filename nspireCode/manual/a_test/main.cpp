@@ -1,37 +1,11 @@
 #include <iostream>
 #include <vector>
-#include <string>
-#include <sstream>
 #include "perceptron.h"
-#include "weights_layer1.h"
-#include "biases_layer1.h"
+#include "model_layer1.h"
 #include "a_image.h"
 
 using namespace std;
 
-// Parse weights from embedded string
-vector<float> load_weights_from_data() {
-    vector<float> weights;
-    istringstream iss(reinterpret_cast<const char*>(weights_layer1_txt));
-    float w;
-    while (iss >> w) {
-        weights.push_back(w);
-    }
-    return weights;
-}
-
-// Parse bias from embedded string
-float load_bias_from_data() {
-    istringstream iss(reinterpret_cast<const char*>(biases_layer1_txt));
-    float bias;
-    if (iss >> bias) {
-        return bias;
-    } else {
-        cerr << "Error parsing bias data" << endl;
-        return 0.0f;
-    }
-}
-
 // Read binary image from array
 vector<float> load_raw_image_from_data() {
     size_t float_count = a_image_bin_len / sizeof(float);
@@ -40,8 +14,10 @@ vector<float> load_raw_image_from_data() {
 }
 
 int main() {
-    vector<float> weights = load_weights_from_data();
-    float bias = load_bias_from_data();
+    // Weights, bias and label table all come from the generated model header.
+    const ModelInfo& info = weights_layer1_info;
+    vector<float> weights(weights_layer1, weights_layer1 + weights_layer1_len);
+    float bias = weights_layer1_bias;
     vector<float> sample_input = load_raw_image_from_data();
 
     if (sample_input.empty()) {
@@ -49,7 +25,8 @@ int main() {
         return -1;
     }
 
-    if (sample_input.size() != weights.size()) {
+    if (sample_input.size() != weights.size() ||
+        sample_input.size() != (size_t)info.input_width * info.input_height) {
         cerr << "Input size and weights size mismatch!" << endl;
         return -1;
     }
@@ -57,7 +34,7 @@ int main() {
     Perceptron perceptron(weights, bias);
     int prediction = perceptron.Predict(sample_input);
 
-    char returnVal = (prediction == 0) ? 'a' : 'b';
+    char returnVal = info.labels[prediction];
     cout << "Prediction: " << returnVal << endl;
 
     return 0;
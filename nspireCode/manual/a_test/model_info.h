@@ -0,0 +1,45 @@
+#ifndef MODEL_INFO_H
+#define MODEL_INFO_H
+
+#include <stdint.h>
+#include <string.h>
+
+static const int kMaxLabels = 48;
+
+// Everything a front end needs to know about a model besides its weights:
+// the input grid, how a drawing is reduced onto it, and what each output
+// means. Stored in .pcpt files from version 2 on and in generated model
+// headers; 64 bytes, little-endian.
+struct ModelInfo {
+  uint16_t input_width;
+  uint16_t input_height;
+  uint16_t num_labels;
+  uint16_t reserved;
+  // A grid cell is 1 when more than this fraction of its source pixels is drawn.
+  float threshold;
+  // The drawing's bounding box is padded by padding_num / padding_den of its
+  // size on every side before it is downsampled.
+  uint16_t padding_num;
+  uint16_t padding_den;
+  // Label of output k. A single-output model has two labels: labels[0] for a
+  // prediction of 0 and labels[1] for 1. At most kMaxLabels - 1 are used so
+  // the array stays NUL terminated when a header initializes it from a string.
+  char labels[kMaxLabels];
+};
+
+// The contract the a/b model was trained with.
+inline ModelInfo DefaultModelInfo() {
+  ModelInfo info;
+  memset(&info, 0, sizeof(info));
+  info.input_width = 28;
+  info.input_height = 28;
+  info.num_labels = 2;
+  info.threshold = 0.25f;
+  info.padding_num = 1;
+  info.padding_den = 5;
+  info.labels[0] = 'a';
+  info.labels[1] = 'b';
+  return info;
+}
+
+#endif
@@ -0,0 +1,232 @@
+// Generated by `main export-header` from weights_layer1.txt and biases_layer1.txt. Do not edit.
+#ifndef MODEL_LAYER1_H
+#define MODEL_LAYER1_H
+
+#include <stdint.h>
+#include "model_info.h"
+
+static const unsigned int weights_layer1_len = 784;
+
+static constexpr float weights_layer1[784] = {
+  -0.0592547543f, -0.0665734708f, -0.0147083271f, -0.0679012835f, -0.0916586965f, -0.0072677983f,
+  -0.0657444745f, 0.0419041999f, 0.0614383034f, 0.0727687031f, -0.0536741279f, 0.0605410449f,
+  -0.0306039751f, -0.0122595252f, -0.0848798156f, -0.0895657837f, 0.0273774285f, 0.0527774133f,
+  -0.0385072045f, 0.0477111526f, 0.0224490333f, 0.0412205793f, 0.0520512052f, -0.0166381616f,
+  -0.0172684323f, 0.0206314567f, -0.0840378106f, 0.0253906306f, -0.0731590539f, -0.0316937305f,
+  -0.0546376221f, -0.0375800692f, -0.0180513803f, 0.0276896972f, 0.0555232055f, 0.0213757921f,
+  -0.0811300427f, -0.0252707433f, -0.0682978034f, -0.01262658f, 0.05591074f, -0.0687681884f,
+  0.0570962243f, 0.0783547461f, 0.00568677112f, -0.0417701639f, 0.0356525667f, -0.0253076386f,
+  0.0154142296f, -0.0880842954f, 0.0541725643f, 0.0479190536f, -0.0729726702f, 0.0374515541f,
+  -0.0628814474f, -0.0602295436f, 0.0391279347f, -0.0737049878f, 0.0492547341f, -0.0488177724f,
+  0.0755381882f, -0.0878139436f, 0.0324885733f, -0.026117472f, 0.0717523545f, 0.0203546453f,
+  0.0602144636f, -0.0191923473f, -0.00241357321f, 0.0160671659f, 0.0717094988f, 0.0768968165f,
+  0.00200411235f, -0.00637012534f, -0.0307298116f, 0.0578952096f, -0.0786993951f, 0.068118006f,
+  0.0525161512f, -0.0103551829f, -0.0702250004f, 0.0198000465f, -0.0410824232f, 0.0687368512f,
+  -0.0823096037f, 0.0129201422f, 0.0172213782f, 0.055111099f, -0.0310375243f, 0.0234847236f,
+  -0.0493650921f, -0.0102767041f, 0.0656192303f, -0.000531132158f, 0.00696844794f, -0.0857969746f,
+  0.0444967784f, -0.0388096981f, 0.0466502942f, 0.0510572381f, -0.0473383032f, -0.0601079799f,
+  -0.0223747622f, 0.0783797204f, 0.0716121346f, 0.0719101429f, 0.0472399332f, 0.0717946887f,
+  -0.0729428381f, 0.0792835504f, 0.0387867726f, -0.0762744993f, 0.0674944371f, -0.0699212104f,
+  -0.0392396636f, 0.00189503538f, -0.00322431186f, -0.0170292612f, 0.0732309818f, 0.0155932643f,
+  0.0202790443f, -0.00342562236f, -0.0810346901f, 0.0413779952f, -0.0925554484f, 0.041143436f,
+  0.0547774322f, 0.0591047816f, -0.00747147575f, -0.0530937873f, -0.0169482585f, 0.00736648962f,
+  -0.0506873801f, -0.037350405f, 0.00533871353f, 0.0284884106f, 0.0697146803f, -0.0492256694f,
+  -0.0445548855f, -0.0632098466f, -0.0901024491f, -0.0870181024f, -0.0119476141f, 0.0332220383f,
+  0.0113905603f, 0.0315682516f, -0.00629352592f, -0.0488309674f, 0.0324199572f, -0.0147792865f,
+  -0.0807805881f, -0.135188848f, -0.085031189f, -0.00379913626f, -0.0329774357f, -0.0438600071f,
+  0.0229567904f, -0.0591165982f, 0.0672529042f, -0.0278381575f, 0.0469817296f, 0.0576778837f,
+  0.0449234135f, 0.0170742813f, -0.078313604f, 0.0334280916f, 0.00410793349f, 0.0792544335f,
+  0.0138100432f, 0.0692138076f, 0.0707712024f, 0.0574695803f, -0.00201038271f, 0.0316102244f,
+  0.0420298465f, 0.0435943492f, -0.0531094596f, -0.124080718f, -0.232740402f, -0.371464163f,
+  -0.18102257f, -0.0207810737f, -0.0916876495f, -0.0840476304f, -0.0488776378f, 0.00923799258f,
+  -0.0621930994f, -0.105237037f, -0.0518217161f, -0.0309778489f, 0.0624629259f, 0.029392885f,
+  0.0138289528f, -0.0652752221f, 0.0498788394f, -0.0595369823f, -0.0772529244f, 0.0604952015f,
+  0.0466254242f, 0.0770297199f, 0.0226357076f, 0.0761447847f, 0.024793731f, 0.0437389798f,
+  -0.00567073841f, -0.163824186f, -0.445468992f, -0.558027029f, -0.398392916f, -0.265507013f,
+  -0.145687729f, -0.00759898499f, 0.0425144769f, 0.0623528212f, 0.0150560811f, 0.0132438587f,
+  -0.0858776793f, -0.0839625746f, -0.0528302826f, 0.0538236685f, -0.0622479357f, -0.0528879352f,
+  -0.0252741259f, 0.0101685124f, 0.0462393351f, -0.0629178733f, 0.0577133335f, 0.0421055742f,
+  0.0496950783f, -0.0532447398f, -0.140375629f, -0.114406906f, -0.141215265f, -0.235277727f,
+  -0.314868718f, -0.644586802f, -0.589376032f, -0.482447386f, -0.207660496f, 0.0904041156f,
+  -0.011539584f, 0.058566045f, -0.0366599113f, -0.0238131732f, -0.0861901715f, 0.0183147881f,
+  -0.0633783564f, -0.0148405824f, -0.0397785045f, -0.068786189f, -0.0180115867f, -0.0576613136f,
+  0.0130091617f, -0.0139978649f, -0.0755656213f, 0.00887464266f, 0.0239408556f, -0.0827757567f,
+  -0.184985951f, -0.0722379684f, 0.0520555153f, -0.0747048706f, -0.200179577f, -0.283836246f,
+  -0.386981606f, -0.318994462f, 0.0508246832f, 0.200303465f, 0.196942344f, -0.0437392406f,
+  -0.114730872f, -0.0894237831f, 0.0782805383f, -0.047639627f, 0.0104771284f, -0.0851211548f,
+  -0.0924086869f, 0.0651890635f, 0.0445143469f, -0.0332985334f, -0.0523650609f, 0.000626174267f,
+  -0.0664733946f, -0.00706085842f, -0.0445039161f, 0.0706097186f, -0.110018112f, -0.164300874f,
+  0.083237499f, -0.0652674362f, -0.106525116f, 0.0905185863f, 0.203141108f, 0.238660723f,
+  0.298182815f, 0.40431276f, 0.31864953f, 0.132580638f, 0.0315423086f, 0.00727523118f,
+  -0.0437365398f, 0.0546324104f, 0.00840382092f, 0.0669149607f, -0.055538293f, 0.0447675474f,
+  -0.0171174537f, -0.0139053361f, -0.00572719146f, -0.0668387413f, 0.0716401637f, 0.0105081676f,
+  0.0461539365f, -0.0704960078f, -0.134857655f, -0.0444925055f, 0.116784118f, -0.0574785359f,
+  0.0748601109f, 0.322408855f, 0.394094735f, 0.415355295f, -0.00521433586f, 0.0690571219f,
+  0.291786462f, 0.0614650212f, -0.0961204618f, -0.0394365899f, -0.0597791187f, -0.0696212053f,
+  -0.00862705521f, -0.0530735068f, -0.0454382114f, 0.0340276398f, 0.0801579654f, 0.0514741577f,
+  0.0287094656f, 0.0260964576f, 0.0779609382f, 0.0319773294f, 0.0620524921f, 0.023734916f,
+  0.0375842452f, 0.0954487324f, 0.124693431f, -0.0398895815f, 0.0883425251f, -0.00108908617f,
+  0.108013414f, 0.25442794f, -0.0770468041f, 0.0399189703f, 0.0648187324f, 0.00315165543f,
+  -0.154281721f, 0.0209932104f, -0.07480032f, 0.159029141f, 0.162473872f, -0.0389135256f,
+  0.0179409776f, -0.0388380028f, -0.0638306886f, 0.02272694f, 0.0244580749f, -0.0889794528f,
+  0.0519602336f, -0.0675063878f, -0.0284033027f, 0.0881923065f, 0.148321748f, 0.166871533f,
+  0.197319463f, 0.12860553f, 0.140870273f, -0.196630791f, -0.215376034f, 0.18760626f,
+  -0.0785583407f, -0.0679347441f, 0.078421995f, -0.0944104642f, -0.138097629f, -0.0267674718f,
+  0.208647236f, 0.11606805f, -0.00184728508f, -0.0645673573f, -0.015900841f, -0.00164024276f,
+  0.0764910877f, -0.0820965171f, -0.0334884115f, 0.0591274612f, -0.0160114076f, -0.0597954281f,
+  -0.0848751962f, -0.0273377188f, 0.141282693f, 0.187015712f, 0.408789843f, 0.376416117f,
+  0.0650535375f, -0.250553846f, -0.0106228227f, 0.082945101f, -0.0746220052f, -0.0324097462f,
+  -0.0518311039f, -0.0858572647f, -0.0924044922f, 0.0115311863f, 0.204853386f, 0.19706364f,
+  -0.0528237261f, 0.0208007656f, 0.0763324648f, 0.0377875157f, -0.0690706074f, 0.0301302318f,
+  -0.0340564214f, -0.0130147571f, -0.0533985533f, -0.0162012931f, -0.075798586f, 0.109518625f,
+  0.256441861f, 0.243067414f, 0.378690571f, 0.382893443f, 0.243082106f, 0.0755114928f,
+  0.216701433f, 0.285449237f, 0.182991341f, -0.0966755375f, -0.0207480695f, 0.100510255f,
+  -0.193965971f, -0.030102089f, 0.0290140137f, 0.00663988153f, -0.104957148f, -0.0839761347f,
+  -0.00938407611f, 0.0624366552f, -0.00476486236f, 0.0756440014f, -0.0815279335f, -0.0816583186f,
+  -0.0259019639f, 0.0416815467f, 0.0565940253f, 0.0232178494f, 0.299152941f, 0.0976700038f,
+  0.214684278f, 0.226227313f, 0.578779936f, 0.502732754f, 0.31410864f, 0.169012532f,
+  0.235089272f, 0.308517128f, 0.412042737f, 0.149726003f, -0.151887819f, 0.0593018159f,
+  -0.0423414633f, 0.00467105163f, 0.0330053121f, 0.0544372015f, 0.0169661213f, 0.034646038f,
+  -0.0784836709f, -0.0557823293f, -0.0881659389f, -0.00556781702f, -0.0662786663f, 0.0147703821f,
+  -0.0512712933f, 0.108425736f, 0.284689516f, 0.0461601727f, -0.0356436931f, -0.0166015364f,
+  0.35916391f, 0.0578293987f, 0.0401167199f, -0.135959193f, 0.575083435f, 0.564108789f,
+  0.660419643f, 0.141879573f, -0.0187001694f, 0.182259232f, 0.0750351176f, -0.0731311142f,
+  -0.0358685628f, 0.0629891083f, -0.0895144343f, -0.0112372609f, -0.0258263405f, 0.0418214984f,
+  0.0354469456f, -0.0298559647f, -0.0735317916f, -0.0345943682f, -0.0878529996f, 0.0269987267f,
+  0.203145981f, 0.228832856f, 0.0810718387f, -0.00837137178f, 0.229438618f, -0.0773559734f,
+  0.118820138f, -0.263132453f, 0.101529084f, 0.263432533f, 0.0481767841f, 0.0688755065f,
+  0.179663584f, 0.301468015f, 0.069189392f, -0.0773401484f, 0.0743732899f, 0.0787822306f,
+  -0.0498525538f, 0.0408180989f, 0.0308205504f, 0.0637303591f, -0.0660600513f, -0.0196422059f,
+  0.0507384725f, -0.00181422825f, -0.0172505472f, -0.0460975878f, 0.0913781226f, 0.304751813f,
+  0.118850894f, 0.0758949891f, 0.0437293388f, 0.0340646915f, 0.0964988321f, -0.338917434f,
+  -0.0818357915f, -0.0727341548f, 0.104434364f, 0.0199315473f, 0.0837671459f, 0.135165647f,
+  0.10731519f, -0.0208536815f, -0.0713031292f, -0.00364234159f, -0.0244509708f, 0.0155625343f,
+  -0.07451877f, -0.00597503409f, 0.0617999546f, 0.0173371453f, 0.0306811724f, -0.042889785f,
+  0.0611546226f, 0.0305463094f, -0.0296146013f, 0.103472151f, -0.00397326145f, -0.0983121768f,
+  -0.0736346692f, -0.301613808f, -0.531070948f, -0.511310756f, -0.264605522f, 0.107719563f,
+  0.290425271f, 0.23610884f, 0.112608708f, 0.0916351154f, 0.109472945f, 0.0528088436f,
+  0.0314623006f, -0.0676153153f, -0.0558285676f, -0.0069874702f, -0.0515661575f, -0.0581047721f,
+  0.0570641123f, 0.00463334098f, -0.00573425461f, -0.0886710137f, -0.024673773f, 0.063430652f,
+  -0.0041070357f, -0.0793859437f, -0.100390099f, 0.0340549611f, -0.0054108426f, -0.299465448f,
+  -0.454113454f, -0.360347569f, -0.217114195f, 0.173063859f, 0.213552132f, 0.0184717011f,
+  0.120750979f, 0.0383334607f, -0.0319023393f, -0.0390592739f, -0.0772411376f, -0.0759041011f,
+  -0.0419223048f, -0.0833763778f, -0.0861784071f, 0.00819896441f, 0.0229870994f, 0.0350903012f,
+  0.0484813638f, -0.0936213583f, 0.0596381314f, -0.0275184345f, 0.0281674173f, -0.0836002454f,
+  -0.141202465f, -0.0219990723f, -0.113075845f, -0.111011326f, -0.261392474f, -0.122915804f,
+  -0.104738832f, 0.0567220747f, 0.141463861f, 0.0838102922f, -0.0136251058f, 0.0132695399f,
+  0.0543884672f, 0.049014125f, -0.0190446842f, -0.0563698597f, -0.0844557285f, 0.0659211576f,
+  0.046474088f, -0.0474587195f, 0.0431346931f, -0.0323215015f, 0.0412144996f, -0.0140721546f,
+  -0.0601014383f, -0.0526418947f, -0.00387713453f, -0.0336975418f, -0.141755357f, -0.00237724674f,
+  -0.145297989f, -0.140309393f, -0.0568083487f, -0.0198558457f, 0.0668436214f, 0.0175839774f,
+  0.0997711346f, -0.0628936142f, 0.0371487029f, -0.0280665066f, -0.00242884737f, 0.0663247257f,
+  -0.063840583f, -0.00273664808f, -0.066688478f, 0.0189144704f, 0.00226614578f, 0.0499853976f,
+  -0.0384832136f, 0.0314491875f, 0.00456340984f, -0.0279470962f, 0.0069660116f, -0.0240062904f,
+  -0.0648522377f, -0.0241743308f, 0.0542475916f, 0.0526566394f, -0.0495000146f, -0.00275313784f,
+  -0.0238623135f, 0.0477185436f, 0.0257123392f, -0.0685851723f, 0.0794496983f, -0.0504955687f,
+  -0.0139027135f, 0.0243231747f, 0.0254449304f, 0.0268699955f, 0.0192015562f, -0.0537051894f,
+  -0.0145491483f, -0.0522286855f, -0.0118092773f, -0.0882865638f, 0.0145528158f, 0.0687428266f,
+  0.0270008463f, -0.00269525219f, 0.0708766133f, 0.0103705572f, -0.0940175056f, -0.0918721706f,
+  -0.0240245219f, 0.0710752904f, -0.0866449028f, -0.0858470798f, -0.0124775944f, -0.0385336764f,
+  -0.0631304979f, -0.0630376711f, -0.042449493f, -0.00198654225f, 0.0263222847f, -0.0133317513f,
+  -0.0882983357f, 0.0120075913f, 0.0348164774f, 0.0672724545f, 0.0683024675f, 0.0735222101f,
+  0.0508409627f, 0.0449735411f, 0.020258287f, 0.0673658848f, 0.00437011942f, -0.00808971282f,
+  -0.0561631285f, -0.00808848348f, 0.0278114323f, 0.0180966202f, -0.0853269249f, 0.0661841482f,
+  -0.0558171831f, 0.0300055388f, -0.0741119832f, 0.0685571134f, 0.0177057106f, 0.0796378851f,
+  0.0631987005f, 0.0170858521f, -0.0652125776f, -0.00374737056f, -0.0439200811f, 0.0433772095f,
+  -0.0927590132f, -0.0208048057f, -0.00529094134f, -0.0874980986f, 0.0485308804f, -0.0585919954f,
+  0.0216687787f, -0.00980478246f, 0.0157422274f, 0.0478816517f, 0.0634199083f, -0.060614679f,
+  -0.0870701224f, -0.0153219076f, 0.0388454534f, -0.0591923036f, -0.0870734602f, 0.0717389733f,
+  0.0581766628f, 0.0604360662f, -0.073013559f, 0.0778121352f, -0.0332531445f, -0.00873767864f,
+  0.0622743107f, 0.0160741918f, 0.00294699124f, 0.0660461038f, 0.0379004218f, -0.0589947067f,
+  0.0452753641f, -0.04436462f, 0.0382511206f, -0.0412679352f,
+};
+static constexpr float weights_layer1_bias = -0.00692046434f;
+
+// Q16.16, for FixedPointPerceptron.
+static constexpr int32_t weights_layer1_q16[784] = {
+  -3883, -4363, -964, -4450, -6007, -476, -4309, 2746, 4026, 4769,
+  -3518, 3968, -2006, -803, -5563, -5870, 1794, 3459, -2524, 3127,
+  1471, 2701, 3411, -1090, -1132, 1352, -5508, 1664, -4795, -2077,
+  -3581, -2463, -1183, 1815, 3639, 1401, -5317, -1656, -4476, -827,
+  3664, -4507, 3742, 5135, 373, -2737, 2337, -1659, 1010, -5773,
+  3550, 3140, -4782, 2454, -4121, -3947, 2564, -4830, 3228, -3199,
+  4950, -5755, 2129, -1712, 4702, 1334, 3946, -1258, -158, 1053,
+  4700, 5040, 131, -417, -2014, 3794, -5158, 4464, 3442, -679,
+  -4602, 1298, -2692, 4505, -5394, 847, 1129, 3612, -2034, 1539,
+  -3235, -673, 4300, -35, 457, -5623, 2916, -2543, 3057, 3346,
+  -3102, -3939, -1466, 5137, 4693, 4713, 3096, 4705, -4780, 5196,
+  2542, -4999, 4423, -4582, -2572, 124, -211, -1116, 4799, 1022,
+  1329, -225, -5311, 2712, -6066, 2696, 3590, 3873, -490, -3480,
+  -1111, 483, -3322, -2448, 350, 1867, 4569, -3226, -2920, -4143,
+  -5905, -5703, -783, 2177, 746, 2069, -412, -3200, 2125, -969,
+  -5294, -8860, -5573, -249, -2161, -2874, 1504, -3874, 4407, -1824,
+  3079, 3780, 2944, 1119, -5132, 2191, 269, 5194, 905, 4536,
+  4638, 3766, -132, 2072, 2754, 2857, -3481, -8132, -15253, -24344,
+  -11863, -1362, -6009, -5508, -3203, 605, -4076, -6897, -3396, -2030,
+  4094, 1926, 906, -4278, 3269, -3902, -5063, 3965, 3056, 5048,
+  1483, 4990, 1625, 2866, -372, -10736, -29194, -36571, -26109, -17400,
+  -9548, -498, 2786, 4086, 987, 868, -5628, -5503, -3462, 3527,
+  -4079, -3466, -1656, 666, 3030, -4123, 3782, 2759, 3257, -3489,
+  -9200, -7498, -9255, -15419, -20635, -42244, -38625, -31618, -13609, 5925,
+  -756, 3838, -2403, -1561, -5649, 1200, -4154, -973, -2607, -4508,
+  -1180, -3779, 853, -917, -4952, 582, 1569, -5425, -12123, -4734,
+  3412, -4896, -13119, -18601, -25361, -20906, 3331, 13127, 12907, -2866,
+  -7519, -5860, 5130, -3122, 687, -5579, -6056, 4272, 2917, -2182,
+  -3432, 41, -4356, -463, -2917, 4627, -7210, -10768, 5455, -4277,
+  -6981, 5932, 13313, 15641, 19542, 26497, 20883, 8689, 2067, 477,
+  -2866, 3580, 551, 4385, -3640, 2934, -1122, -911, -375, -4380,
+  4695, 689, 3025, -4620, -8838, -2916, 7654, -3767, 4906, 21129,
+  25827, 27221, -342, 4526, 19123, 4028, -6299, -2585, -3918, -4563,
+  -565, -3478, -2978, 2230, 5253, 3373, 1882, 1710, 5109, 2096,
+  4067, 1555, 2463, 6255, 8172, -2614, 5790, -71, 7079, 16674,
+  -5049, 2616, 4248, 207, -10111, 1376, -4902, 10422, 10648, -2550,
+  1176, -2545, -4183, 1489, 1603, -5831, 3405, -4424, -1861, 5780,
+  9720, 10936, 12932, 8428, 9232, -12886, -14115, 12295, -5148, -4452,
+  5139, -6187, -9050, -1754, 13674, 7607, -121, -4231, -1042, -107,
+  5013, -5380, -2195, 3875, -1049, -3919, -5562, -1792, 9259, 12256,
+  26790, 24669, 4263, -16420, -696, 5436, -4890, -2124, -3397, -5627,
+  -6056, 756, 13425, 12915, -3462, 1363, 5003, 2476, -4527, 1975,
+  -2232, -853, -3500, -1062, -4968, 7177, 16806, 15930, 24818, 25093,
+  15931, 4949, 14202, 18707, 11993, -6336, -1360, 6587, -12712, -1973,
+  1901, 435, -6878, -5503, -615, 4092, -312, 4957, -5343, -5352,
+  -1698, 2732, 3709, 1522, 19605, 6401, 14070, 14826, 37931, 32947,
+  20585, 11076, 15407, 20219, 27004, 9812, -9954, 3886, -2775, 306,
+  2163, 3568, 1112, 2271, -5144, -3656, -5778, -365, -4344, 968,
+  -3360, 7106, 18657, 3025, -2336, -1088, 23538, 3790, 2629, -8910,
+  37689, 36969, 43281, 9298, -1226, 11945, 4918, -4793, -2351, 4128,
+  -5866, -736, -1693, 2741, 2323, -1957, -4819, -2267, -5758, 1769,
+  13313, 14997, 5313, -549, 15036, -5070, 7787, -17245, 6654, 17264,
+  3157, 4514, 11774, 19757, 4534, -5069, 4874, 5163, -3267, 2675,
+  2020, 4177, -4329, -1287, 3325, -119, -1131, -3021, 5989, 19972,
+  7789, 4974, 2866, 2232, 6324, -22211, -5363, -4767, 6844, 1306,
+  5490, 8858, 7033, -1367, -4673, -239, -1602, 1020, -4884, -392,
+  4050, 1136, 2011, -2811, 4008, 2002, -1941, 6781, -260, -6443,
+  -4826, -19767, -34804, -33509, -17341, 7060, 19033, 15474, 7380, 6005,
+  7174, 3461, 2062, -4431, -3659, -458, -3379, -3808, 3740, 304,
+  -376, -5811, -1617, 4157, -269, -5203, -6579, 2232, -355, -19626,
+  -29761, -23616, -14229, 11342, 13995, 1211, 7914, 2512, -2091, -2560,
+  -5062, -4974, -2747, -5464, -5648, 537, 1506, 2300, 3177, -6136,
+  3908, -1803, 1846, -5479, -9254, -1442, -7411, -7275, -17131, -8055,
+  -6864, 3717, 9271, 5493, -893, 870, 3564, 3212, -1248, -3694,
+  -5535, 4320, 3046, -3110, 2827, -2118, 2701, -922, -3939, -3450,
+  -254, -2208, -9290, -156, -9522, -9195, -3723, -1301, 4381, 1152,
+  6539, -4122, 2435, -1839, -159, 4347, -4184, -179, -4370, 1240,
+  149, 3276, -2522, 2061, 299, -1832, 457, -1573, -4250, -1584,
+  3555, 3451, -3244, -180, -1564, 3127, 1685, -4495, 5207, -3309,
+  -911, 1594, 1668, 1761, 1258, -3520, -953, -3423, -774, -5786,
+  954, 4505, 1770, -177, 4645, 680, -6162, -6021, -1574, 4658,
+  -5678, -5626, -818, -2525, -4137, -4131, -2782, -130, 1725, -874,
+  -5787, 787, 2282, 4409, 4476, 4818, 3332, 2947, 1328, 4415,
+  286, -530, -3681, -530, 1823, 1186, -5592, 4337, -3658, 1966,
+  -4857, 4493, 1160, 5219, 4142, 1120, -4274, -246, -2878, 2843,
+  -6079, -1363, -347, -5734, 3181, -3840, 1420, -643, 1032, 3138,
+  4156, -3972, -5706, -1004, 2546, -3879, -5706, 4701, 3813, 3961,
+  -4785, 5099, -2179, -573, 4081, 1053, 193, 4328, 2484, -3866,
+  2967, -2907, 2507, -2705,
+};
+static constexpr int32_t weights_layer1_bias_q16 = -454;
+
+// {width, height, num_labels, reserved, threshold, padding_num, padding_den, labels}
+static constexpr ModelInfo weights_layer1_info = {28, 28, 2, 0, 0.25f, 1, 5, "ab"};
+
+#endif